@@ -61,13 +61,13 @@ void whatevah( char me) {
 *   example thread function
 *****************************************************************************/
 //[thread_fn_ws
-void thread() {
+void thread( boost::fibers::algo::work_stealing_pool & pool) {
     std::ostringstream buffer;
     buffer << "thread started " << std::this_thread::get_id() << std::endl;
     std::cout << buffer.str() << std::flush;
-    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( 4); /*<
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool); /*<
         Install the scheduling algorithm `boost::fibers::algo::work_stealing` in order to
-        join the work sharing.
+        join the work sharing of `pool`.
     >*/
     lock_type lk( mtx_count);
     cnd_count.wait( lk, [](){ return 0 == fiber_count; } ); /*<
@@ -76,6 +76,11 @@ void thread() {
         if all worker fibers are complete.
     >*/
     BOOST_ASSERT( 0 == fiber_count);
+    lk.unlock();
+    pool.leave(); /*<
+        Leave the pool before the thread terminates; the pool
+        must not keep stealing from the scheduler of this thread.
+    >*/
 }
 //]
 
@@ -85,6 +90,9 @@ void thread() {
 int main( int argc, char *argv[]) {
     std::cout << "main thread started " << std::this_thread::get_id() << std::endl;
 //[main_ws
+    boost::fibers::algo::work_stealing_pool pool{ 4 }; /*<
+        The pool connects the schedulers of the four threads; it must outlive the threads.
+    >*/
     for ( char c : std::string("abcdefghijklmnopqrstuvwxyz")) { /*<
         Launch a number of worker fibers; each worker fiber picks up a character
         that is passed as parameter to fiber-function `whatevah`.
@@ -96,11 +104,11 @@ int main( int argc, char *argv[]) {
     std::thread threads[] = { /*<
         Launch a couple of threads that join the work sharing.
     >*/
-        std::thread( thread),
-        std::thread( thread),
-        std::thread( thread)
+        std::thread( thread, std::ref( pool) ),
+        std::thread( thread, std::ref( pool) ),
+        std::thread( thread, std::ref( pool) )
     };
-    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( 4); /*<
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool); /*<
         Install the scheduling algorithm `boost::fibers::algo::work_stealing` in the main thread
         too, so each new fiber gets launched into the shared pool.
     >*/
@@ -120,6 +128,9 @@ int main( int argc, char *argv[]) {
     for ( std::thread & t : threads) { /*< wait for threads to terminate >*/
         t.join();
     }
+    pool.leave(); /*<
+        The main thread leaves the pool before `pool` gets destroyed.
+    >*/
 //]
     std::cout << "done." << std::endl;
     return EXIT_SUCCESS;
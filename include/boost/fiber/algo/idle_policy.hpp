@@ -0,0 +1,53 @@
+
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_FIBERS_ALGO_IDLE_POLICY_H
+#define BOOST_FIBERS_ALGO_IDLE_POLICY_H
+
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// what a work-stealing scheduler does if it runs out of work:
+// spin (trying to steal) for at most `spin_duration`, then park the thread
+// a default constructed policy parks immediately
+struct idle_policy {
+    // zero: park immediately
+    std::chrono::microseconds   spin_duration{ BOOST_FIBERS_IDLE_SPIN_DURATION };
+    // max. number of threads of the pool spinning at the same time,
+    // further idle threads park immediately
+    // zero: half of the hardware threads (at least one)
+    std::uint32_t               max_spinning{ 0 };
+};
+
+struct idle_statistics {
+    // idle periods spent spinning
+    std::uint64_t   spins{ 0 };
+    // idle periods in which the thread was parked
+    std::uint64_t   parks{ 0 };
+    // parks ended by algorithm::notify()
+    std::uint64_t   wakeups{ 0 };
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_IDLE_POLICY_H
@@ -7,7 +7,6 @@
 #ifndef BOOST_FIBERS_ALGO_SHARED_WORK_H
 #define BOOST_FIBERS_ALGO_SHARED_WORK_H
 
-#include <condition_variable>
 #include <chrono>
 #include <deque>
 #include <mutex>
@@ -17,6 +16,7 @@
 #include <boost/fiber/algo/algorithm.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/thread_parker.hpp>
 #include <boost/fiber/scheduler.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -41,9 +41,7 @@ private:
     static std::mutex   	rqueue_mtx_;
 
     lqueue_type            	lqueue_{};
-    std::mutex              mtx_{};
-    std::condition_variable cnd_{};
-    bool                    flag_{ false };
+    detail::thread_parker   parker_{};
     bool                    suspend_{ false };
 
 public:
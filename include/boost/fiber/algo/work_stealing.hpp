@@ -9,22 +9,29 @@
 #define BOOST_FIBERS_ALGO_WORK_STEALING_H
 
 #include <atomic>
-#include <condition_variable>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
 #include <boost/intrusive_ptr.hpp>
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/algo/idle_policy.hpp>
+#include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/context_spinlock_queue.hpp>
 #include <boost/fiber/detail/context_spmc_queue.hpp>
+#include <boost/fiber/detail/idle_parker.hpp>
+#include <boost/fiber/detail/scheduler_counters.hpp>
 #include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/statistics.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -34,28 +41,50 @@ namespace boost {
 namespace fibers {
 namespace algo {
 
+class work_stealing_pool;
+
 class BOOST_FIBERS_DECL work_stealing : public algorithm {
 private:
-    static std::atomic< std::uint32_t >                     counter_;
-    static std::vector< intrusive_ptr< work_stealing > >    schedulers_;
+    friend class work_stealing_pool;
 
-    std::uint32_t                                           id_;
-    std::uint32_t                                           thread_count_;
+    work_stealing_pool                                  &   pool_;
 #ifdef BOOST_FIBERS_USE_SPMC_QUEUE
     detail::context_spmc_queue                              rqueue_{};
 #else
     detail::context_spinlock_queue                          rqueue_{};
 #endif
-    std::mutex                                              mtx_{};
-    std::condition_variable                                 cnd_{};
-    bool                                                    flag_{ false };
+    // rqueue_ is written by thieves, stealing_ only by this scheduler
+    char                                                    pad_[cacheline_length];
+    // set while this scheduler reads slots_ of the pool to find a victim
+    std::atomic< bool >                                     stealing_{ false };
+    detail::idle_parker                                     idle_;
     bool                                                    suspend_;
+    // counters of the scheduler running this algorithm
+    std::shared_ptr< detail::scheduler_counters >           counters_;
+    // counters at the time the scheduler joined the pool
+    scheduler_statistics                                    baseline_;
+
+    work_stealing( work_stealing_pool &, idle_policy const&, bool);
+
+    scheduler_statistics statistics_() const noexcept;
+
+    bool probe_() noexcept;
 
-    static void init_( std::uint32_t, std::vector< intrusive_ptr< work_stealing > > &);
+    void drain_();
 
 public:
+    // suspend == false: an idle thread keeps looping through pick_next()
+    // suspend == true:  an idle thread parks (spins first only if
+    //                   BOOST_FIBERS_IDLE_SPIN_DURATION is non-zero)
+    work_stealing( work_stealing_pool &, bool = false);
+
+    work_stealing( work_stealing_pool &, idle_policy const&);
+
+    // join the process-wide default pool of at most `thread_count` threads
     work_stealing( std::uint32_t, bool = false);
 
+    work_stealing( std::uint32_t, idle_policy const&);
+
     work_stealing( work_stealing const&) = delete;
     work_stealing( work_stealing &&) = delete;
 
@@ -70,6 +99,11 @@ public:
         return rqueue_.steal();
     }
 
+    // moves up to half of the ready context' (at most `max`) into `ctxs`
+    virtual std::size_t steal_batch( context ** ctxs, std::size_t max) noexcept {
+        return rqueue_.steal_batch( ctxs, max);
+    }
+
     bool has_ready_fibers() const noexcept override {
         return ! rqueue_.empty();
     }
@@ -77,6 +111,124 @@ public:
     void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
 
     void notify() noexcept override;
+
+    idle_statistics statistics() const noexcept {
+        return idle_.statistics();
+    }
+};
+
+// growing/shrinking the pool by autoscale()
+struct elastic_policy {
+    std::uint32_t   min_workers{ 1 };
+    std::uint32_t   max_workers{ 1 };
+    // add a worker if the utilisation is above
+    double          grow_above{ 0.8 };
+    // retire a worker if the utilisation is below
+    double          shrink_below{ 0.2 };
+};
+
+// set of work_stealing schedulers stealing from each other
+// a thread joins the pool by installing a work_stealing scheduler
+// constructed with the pool and leaves it by calling leave(),
+// at most `capacity` threads are members at the same time, a thread
+// joining a full pool gets a fiber_error
+// in addition the pool runs a resize()-able set of its own worker threads
+// the pool must outlive the threads (or they must leave it
+// before the pool gets destroyed)
+class BOOST_FIBERS_DECL work_stealing_pool {
+private:
+    friend class work_stealing;
+
+    std::uint32_t                                           capacity_;
+    idle_policy                                             policy_;
+    // registry: slots [0, size_) contain the schedulers thieves
+    // choose their victims from, modified under mtx_
+    std::unique_ptr< std::atomic< work_stealing * >[] >     slots_;
+    std::atomic< std::uint32_t >                            size_{ 0 };
+    // ready context' handed over by schedulers leaving the pool
+    detail::context_spinlock_queue                          inbox_{};
+    std::atomic< std::size_t >                              inbox_size_{ 0 };
+    // number of schedulers spinning for work
+    std::atomic< std::uint32_t >                            spinning_{ 0 };
+    // number of schedulers parked
+    std::atomic< std::uint32_t >                            parked_{ 0 };
+    mutable std::mutex                                      mtx_{};
+    // keeps the schedulers alive as long as other threads might steal
+    std::vector< intrusive_ptr< work_stealing > >           members_{};
+    // schedulers that left the pool, released if no member is stealing
+    std::vector< intrusive_ptr< work_stealing > >           retired_{};
+    // counters of the schedulers that left the pool
+    scheduler_statistics                                    left_{};
+    // worker threads owned by the pool
+    condition_variable_any                                  cnd_{};
+    std::uint32_t                                           target_{ 0 };
+    // worker threads started and not yet detached, including retiring ones
+    std::uint32_t                                           workers_{ 0 };
+    // worker threads asked to retire that have not left the pool yet
+    std::uint32_t                                           retiring_{ 0 };
+    // members not owned by the pool
+    std::uint32_t                                           foreign_{ 0 };
+    std::vector< std::thread >                              threads_{};
+    std::vector< std::thread::id >                          exited_{};
+
+    void attach_( work_stealing *);
+
+    void detach_( work_stealing *);
+
+    void reclaim_() noexcept;
+
+    void inject_( context *) noexcept;
+
+    std::size_t steal_( work_stealing *, context **, std::size_t) noexcept;
+
+    void join_exited_( std::unique_lock< std::mutex > &);
+
+    // called with mtx_ locked
+    void start_workers_();
+
+    void worker_();
+
+public:
+    explicit work_stealing_pool( std::uint32_t capacity, idle_policy const& = idle_policy{});
+
+    ~work_stealing_pool();
+
+    work_stealing_pool( work_stealing_pool const&) = delete;
+    work_stealing_pool & operator=( work_stealing_pool const&) = delete;
+
+    // max. number of member threads
+    std::uint32_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    // number of member threads
+    std::uint32_t size() const noexcept {
+        return size_.load( std::memory_order_relaxed);
+    }
+
+    // requested number of worker threads owned by the pool
+    std::uint32_t target() const;
+
+    // starts or retires worker threads until there are `workers` of them
+    // (limited by capacity() minus the threads that joined on their own)
+    void resize( std::uint32_t workers);
+
+    // counters of the members (since they joined the pool)
+    std::vector< scheduler_statistics > member_statistics() const;
+
+    // sum over the current members and the schedulers that left the pool
+    scheduler_statistics statistics() const;
+
+    // fraction of member threads not parked
+    double utilisation() const noexcept;
+
+    // adjusts target() by one worker according to utilisation()
+    std::uint32_t autoscale( elastic_policy const&);
+
+    // the calling thread leaves the pool: its ready fibers are handed
+    // over to the remaining members, fibers becoming ready later are
+    // scheduled by round_robin on this thread
+    void leave();
 };
 
 }}}
@@ -12,15 +12,18 @@
 #include <boost/fiber/algo/shared_work.hpp>
 #include <boost/fiber/algo/work_stealing.hpp>
 #include <boost/fiber/barrier.hpp>
+#include <boost/fiber/broadcast_channel.hpp>
 #include <boost/fiber/buffered_channel.hpp>
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/context.hpp>
+#include <boost/fiber/counting_semaphore.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/fiber.hpp>
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/fss.hpp>
 #include <boost/fiber/future.hpp>
+#include <boost/fiber/latch.hpp>
 #include <boost/fiber/mutex.hpp>
 #include <boost/fiber/operations.hpp>
 #include <boost/fiber/policy.hpp>
@@ -31,8 +34,17 @@
 #include <boost/fiber/recursive_timed_mutex.hpp>
 #include <boost/fiber/scheduler.hpp>
 #include <boost/fiber/segmented_stack.hpp>
+#include <boost/fiber/select.hpp>
+#include <boost/fiber/shared_mutex.hpp>
+#include <boost/fiber/shared_timed_mutex.hpp>
+#include <boost/fiber/spsc_channel.hpp>
+#include <boost/fiber/stack_cache.hpp>
+#include <boost/fiber/statistics.hpp>
 #include <boost/fiber/timed_mutex.hpp>
+#include <boost/fiber/trace.hpp>
+#include <boost/fiber/tree_barrier.hpp>
 #include <boost/fiber/type.hpp>
+#include <boost/fiber/unbounded_channel.hpp>
 #include <boost/fiber/unbuffered_channel.hpp>
 
 #endif // BOOST_FIBERS_H
@@ -0,0 +1,528 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_FIBERS_BROADCAST_CHANNEL_H
+#define BOOST_FIBERS_BROADCAST_CHANNEL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/waker.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// what push() does if the slowest subscriber lags a full ring behind
+enum class overflow_policy {
+    // the producer waits until the slowest subscriber has caught up
+    block = 1,
+    // the oldest message is discarded, lagging subscribers skip it
+    drop_oldest,
+    // the slowest subscribers are disconnected
+    disconnect
+};
+
+// bounded channel delivering every message to all subscribers
+// (which may run on different threads)
+// each message is stored once; a subscriber copies it out and the slot
+// is released after the last subscriber has read it
+template< typename T >
+class broadcast_channel {
+public:
+    using value_type = typename std::remove_reference<T>::type;
+
+    class subscriber;
+
+private:
+    typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+    struct slot {
+        storage_type    storage;
+        // subscribers which have not read the message yet
+        std::size_t     readers{ 0 };
+
+        value_type * value() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage) );
+        }
+    };
+
+    slot                            *   slots_;
+    std::size_t                         capacity_;
+    overflow_policy                     policy_;
+    mutable detail::spinlock            splk_{};
+    // sequence of the next message
+    std::size_t                         head_{ 0 };
+    // sequence of the oldest message still stored
+    std::size_t                         tail_{ 0 };
+    bool                                closed_{ false };
+    std::vector< subscriber * >         subscribers_{};
+    wait_queue                          waiting_producers_{};
+    wait_queue                          waiting_subscribers_{};
+
+    slot & slot_( std::size_t seq) const noexcept {
+        return slots_[seq & ( capacity_ - 1)];
+    }
+
+    bool is_full_() const noexcept {
+        return capacity_ == head_ - tail_;
+    }
+
+    // the counts are non-decreasing from tail_ to head_: a subscriber owing
+    // a message owes all newer ones too (subscribers read in order) and a
+    // new subscriber starts at head_, adding to the newer messages only -
+    // so the released slots form a prefix
+    void release_( std::size_t seq) noexcept {
+        if ( 0 != --slot_( seq).readers || seq != tail_) {
+            return;
+        }
+        while ( tail_ != head_ && 0 == slot_( tail_).readers) {
+            slot_( tail_).value()->~value_type();
+            ++tail_;
+        }
+        if ( ! waiting_producers_.empty() ) {
+            waiting_producers_.notify_all();
+        }
+    }
+
+    void drop_oldest_() noexcept {
+        BOOST_ASSERT( tail_ != head_);
+        // subscribers with cursor < tail_ notice it on their next pop
+        slot_( tail_).value()->~value_type();
+        ++tail_;
+    }
+
+    // releases the messages not yet read by sub
+    void detach_( subscriber * sub) noexcept {
+        subscribers_.erase( std::find( subscribers_.begin(), subscribers_.end(), sub) );
+        for ( std::size_t seq = (std::max)( sub->cursor_, tail_); seq != head_; ++seq) {
+            release_( seq);
+        }
+    }
+
+    void disconnect_slowest_() noexcept {
+        std::vector< subscriber * > slowest;
+        for ( subscriber * sub : subscribers_) {
+            if ( sub->cursor_ <= tail_) {
+                slowest.push_back( sub);
+            }
+        }
+        for ( subscriber * sub : slowest) {
+            detach_( sub);
+            sub->disconnected_ = true;
+        }
+    }
+
+    void subscribe_( subscriber * sub) {
+        detail::spinlock_lock lk{ splk_ };
+        sub->cursor_ = head_;
+        subscribers_.push_back( sub);
+    }
+
+    void unsubscribe_( subscriber * sub) noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( ! sub->disconnected_) {
+            detach_( sub);
+        }
+    }
+
+    template< typename V >
+    channel_op_status push_( V && value, bool try_only,
+                             std::chrono::steady_clock::time_point const& timeout_time) {
+        context * active_ctx = context::active();
+        for (;;) {
+            detail::spinlock_lock lk{ splk_ };
+            if ( BOOST_UNLIKELY( closed_) ) {
+                return channel_op_status::closed;
+            }
+            if ( subscribers_.empty() ) {
+                // nobody listens, the message is discarded
+                return channel_op_status::success;
+            }
+            if ( is_full_() ) {
+                switch ( policy_) {
+                case overflow_policy::drop_oldest:
+                    drop_oldest_();
+                    break;
+                case overflow_policy::disconnect:
+                    disconnect_slowest_();
+                    continue;
+                default:
+                    if ( try_only) {
+                        return channel_op_status::full;
+                    }
+                    if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                        waiting_producers_.suspend_and_wait( lk, active_ctx);
+                    } else if ( ! waiting_producers_.suspend_and_wait_until( lk, active_ctx, timeout_time) ) {
+                        return channel_op_status::timeout;
+                    }
+                    continue;
+                }
+            }
+            slot & s = slot_( head_);
+            ::new ( static_cast< void * >( s.value() ) ) value_type( std::forward< V >( value) );
+            s.readers = subscribers_.size();
+            ++head_;
+            // all waiting subscribers in one batch
+            if ( ! waiting_subscribers_.empty() ) {
+                waiting_subscribers_.notify_all();
+            }
+            return channel_op_status::success;
+        }
+    }
+
+public:
+    broadcast_channel( std::size_t capacity, overflow_policy policy = overflow_policy::block) :
+            capacity_{ capacity },
+            policy_{ policy } {
+        if ( BOOST_UNLIKELY( 2 > capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) ) {
+            throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: buffer capacity is invalid" };
+        }
+        slots_ = new slot[capacity_];
+    }
+
+    ~broadcast_channel() {
+        close();
+        BOOST_ASSERT( subscribers_.empty() );
+        for ( std::size_t seq = tail_; seq != head_; ++seq) {
+            slot_( seq).value()->~value_type();
+        }
+        delete [] slots_;
+    }
+
+    broadcast_channel( broadcast_channel const&) = delete;
+    broadcast_channel & operator=( broadcast_channel const&) = delete;
+
+    bool is_closed() const noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        return closed_;
+    }
+
+    void close() noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( ! closed_) {
+            closed_ = true;
+            waiting_producers_.notify_all();
+            waiting_subscribers_.notify_all();
+        }
+    }
+
+    std::size_t subscribers() const noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        return subscribers_.size();
+    }
+
+    channel_op_status try_push( value_type const& value) {
+        return push_( value, true, (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    channel_op_status try_push( value_type && value) {
+        return push_( std::move( value), true, (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    channel_op_status push( value_type const& value) {
+        return push_( value, false, (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    channel_op_status push( value_type && value) {
+        return push_( std::move( value), false, (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type const& value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until( value,
+                                std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type && value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until( std::forward< value_type >( value),
+                                std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type const& value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( value, false, detail::convert( timeout_time) );
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type && value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( std::move( value), false, detail::convert( timeout_time) );
+    }
+
+    // receives the messages pushed after its construction
+    // must be destroyed before the channel
+    class subscriber {
+    private:
+        friend class broadcast_channel;
+
+        broadcast_channel   *   chan_;
+        // sequence of the next message to read
+        std::size_t             cursor_{ 0 };
+        // messages skipped because of overflow_policy::drop_oldest
+        std::size_t             dropped_{ 0 };
+        bool                    disconnected_{ false };
+
+        // a message copied out of the channel, if pop_() succeeded
+        struct holder {
+            storage_type    storage;
+            bool            constructed{ false };
+
+            holder() = default;
+
+            holder( holder const&) = delete;
+            holder & operator=( holder const&) = delete;
+
+            ~holder() {
+                reset();
+            }
+
+            value_type * value() noexcept {
+                BOOST_ASSERT( constructed);
+                return reinterpret_cast< value_type * >( std::addressof( storage) );
+            }
+
+            void construct( value_type const& v) {
+                BOOST_ASSERT( ! constructed);
+                ::new ( static_cast< void * >( std::addressof( storage) ) ) value_type( v);
+                constructed = true;
+            }
+
+            void reset() noexcept {
+                if ( constructed) {
+                    value()->~value_type();
+                    constructed = false;
+                }
+            }
+        };
+
+        // fn is applied to the message while the channel is locked
+        template< typename Fn >
+        channel_op_status pop_( Fn && fn, bool try_only,
+                                std::chrono::steady_clock::time_point const& timeout_time) {
+            context * active_ctx = context::active();
+            for (;;) {
+                detail::spinlock_lock lk{ chan_->splk_ };
+                if ( BOOST_UNLIKELY( disconnected_) ) {
+                    return channel_op_status::closed;
+                }
+                if ( BOOST_UNLIKELY( cursor_ < chan_->tail_) ) {
+                    dropped_ += chan_->tail_ - cursor_;
+                    cursor_ = chan_->tail_;
+                }
+                if ( cursor_ != chan_->head_) {
+                    fn( * chan_->slot_( cursor_).value() );
+                    chan_->release_( cursor_++);
+                    return channel_op_status::success;
+                }
+                // messages pushed before close() are still delivered
+                if ( BOOST_UNLIKELY( chan_->closed_) ) {
+                    return channel_op_status::closed;
+                }
+                if ( try_only) {
+                    return channel_op_status::empty;
+                }
+                if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                    chan_->waiting_subscribers_.suspend_and_wait( lk, active_ctx);
+                } else if ( ! chan_->waiting_subscribers_.suspend_and_wait_until( lk, active_ctx, timeout_time) ) {
+                    return channel_op_status::timeout;
+                }
+            }
+        }
+
+    public:
+        class iterator;
+
+        explicit subscriber( broadcast_channel & chan) :
+                chan_{ & chan } {
+            chan_->subscribe_( this);
+        }
+
+        ~subscriber() {
+            chan_->unsubscribe_( this);
+        }
+
+        subscriber( subscriber const&) = delete;
+        subscriber & operator=( subscriber const&) = delete;
+
+        bool is_disconnected() const noexcept {
+            detail::spinlock_lock lk{ chan_->splk_ };
+            return disconnected_;
+        }
+
+        std::size_t dropped() const noexcept {
+            detail::spinlock_lock lk{ chan_->splk_ };
+            return dropped_;
+        }
+
+        channel_op_status try_pop( value_type & value) {
+            return pop_( [&value](value_type const& v){ value = v; },
+                         true, (std::chrono::steady_clock::time_point::max)() );
+        }
+
+        channel_op_status pop( value_type & value) {
+            return pop_( [&value](value_type const& v){ value = v; },
+                         false, (std::chrono::steady_clock::time_point::max)() );
+        }
+
+        value_type value_pop() {
+            holder h;
+            pop_( [&h](value_type const& v){ h.construct( v); },
+                  false, (std::chrono::steady_clock::time_point::max)() );
+            if ( BOOST_UNLIKELY( ! h.constructed) ) {
+                throw fiber_error{
+                    std::make_error_code( std::errc::operation_not_permitted),
+                    "boost fiber: channel is closed" };
+            }
+            return std::move( * h.value() );
+        }
+
+        template< typename Rep, typename Period >
+        channel_op_status pop_wait_for( value_type & value,
+                                        std::chrono::duration< Rep, Period > const& timeout_duration) {
+            return pop_wait_until( value,
+                                   std::chrono::steady_clock::now() + timeout_duration);
+        }
+
+        template< typename Clock, typename Duration >
+        channel_op_status pop_wait_until( value_type & value,
+                                          std::chrono::time_point< Clock, Duration > const& timeout_time) {
+            return pop_( [&value](value_type const& v){ value = v; },
+                         false, detail::convert( timeout_time) );
+        }
+
+        class iterator {
+        private:
+            subscriber      *   sub_{ nullptr };
+            storage_type        storage_;
+            bool                valid_{ false };
+
+            value_type * value_() noexcept {
+                return reinterpret_cast< value_type * >( std::addressof( storage_) );
+            }
+
+            void destroy_() noexcept {
+                if ( valid_) {
+                    value_()->~value_type();
+                    valid_ = false;
+                }
+            }
+
+            void increment_() {
+                BOOST_ASSERT( nullptr != sub_);
+                destroy_();
+                if ( channel_op_status::success == sub_->pop_(
+                            [this](value_type const& v){ ::new ( static_cast< void * >( value_() ) ) value_type( v); },
+                            false, (std::chrono::steady_clock::time_point::max)() ) ) {
+                    valid_ = true;
+                } else {
+                    sub_ = nullptr;
+                }
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type *;
+            using reference = value_type &;
+
+            using pointer_t = pointer;
+            using reference_t = reference;
+
+            iterator() = default;
+
+            explicit iterator( subscriber * sub) :
+                sub_{ sub } {
+                increment_();
+            }
+
+            // the current value is not copied
+            iterator( iterator const& other) noexcept :
+                sub_{ other.sub_ } {
+            }
+
+            ~iterator() {
+                destroy_();
+            }
+
+            iterator & operator=( iterator const& other) noexcept {
+                if ( BOOST_LIKELY( this != & other) ) {
+                    destroy_();
+                    sub_ = other.sub_;
+                }
+                return * this;
+            }
+
+            bool operator==( iterator const& other) const noexcept {
+                return other.sub_ == sub_;
+            }
+
+            bool operator!=( iterator const& other) const noexcept {
+                return other.sub_ != sub_;
+            }
+
+            iterator & operator++() {
+                increment_();
+                return * this;
+            }
+
+            const iterator operator++( int) = delete;
+
+            reference_t operator*() noexcept {
+                return * value_();
+            }
+
+            pointer_t operator->() noexcept {
+                return value_();
+            }
+        };
+
+        friend class iterator;
+
+        // found by argument dependent lookup (range-for)
+        friend iterator begin( subscriber & sub) {
+            return iterator( & sub);
+        }
+
+        friend iterator end( subscriber &) {
+            return iterator();
+        }
+    };
+
+    friend class subscriber;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_BROADCAST_CHANNEL_H
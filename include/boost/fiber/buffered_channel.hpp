@@ -8,13 +8,18 @@
 #ifndef BOOST_FIBERS_BUFFERED_CHANNEL_H
 #define BOOST_FIBERS_BUFFERED_CHANNEL_H
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
+#include <thread>
 #include <type_traits>
+#include <utility>
 
+#include <boost/assert.hpp>
 #include <boost/config.hpp>
 
 #include <boost/fiber/channel_op_status.hpp>
@@ -22,6 +27,7 @@
 #include <boost/fiber/waker.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/exceptions.hpp>
 
@@ -31,48 +37,703 @@
 
 namespace boost {
 namespace fibers {
+namespace detail {
+
+template< typename Channel >
+class select_push_case;
+template< typename Channel >
+class select_pop_case;
+
+}
 
 template< typename T >
 class buffered_channel {
 public:
     using value_type = typename std::remove_reference<T>::type;
 
+    class write_slot;
+    class read_slot;
+
 private:
-	using slot_type = value_type;
+    // bounded MPMC ring of sequence-numbered slots (D. Vyukov)
+    // a slot at position `pos` is free for a producer if seq == pos,
+    // it contains a value for a consumer if seq == pos + 1 (or a hole, see hole_bit)
+    struct slot {
+        typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+        std::atomic< std::size_t >  seq{ 0 };
+        // claimed by a write_slot not yet committed or borrowed by a
+        // read_slot not yet released, cleared before seq is stored
+        std::atomic< bool >         held{ false };
+        // left uninitialised until a value is constructed in place
+        storage_type                storage;
 
-    mutable detail::spinlock   splk_{};
+        value_type * value() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage) );
+        }
+    };
+
+    // read-mostly
+    slot                                            *   slots_;
+    std::size_t                                         capacity_;
+    std::atomic< bool >                                 closed_{ false };
+    char                                                pad1_[cacheline_length];
+    std::atomic< std::size_t >                          pidx_{ 0 };
+    char                                                pad2_[cacheline_length];
+    std::atomic< std::size_t >                          cidx_{ 0 };
+    char                                                pad3_[cacheline_length];
+    // fibers blocked (or about to block) in the wait-queues,
+    // the wait-queues are only touched if these are non-zero
+    std::atomic< std::size_t >                          waiting_producers_count_{ 0 };
+    std::atomic< std::size_t >                          waiting_consumers_count_{ 0 };
+    mutable detail::spinlock                            splk_{};
     wait_queue                                          waiting_producers_{};
     wait_queue                                          waiting_consumers_{};
-	slot_type                                       *   slots_;
-	std::size_t                                         pidx_{ 0 };
-	std::size_t                                         cidx_{ 0 };
-	std::size_t                                         capacity_;
-    bool                                                closed_{ false };
 
-	bool is_full_() const noexcept {
-		return cidx_ == ((pidx_ + 1) % capacity_);
-	}
+    // set in seq of a slot published by an abandoned write_slot,
+    // such a hole carries no value and is skipped by the consumers
+    static constexpr std::size_t hole_bit = ~( ~std::size_t( 0) >> 1);
 
-	bool is_empty_() const noexcept {
-		return cidx_ == pidx_;
-	}
+    slot * slot_( std::size_t pos) const noexcept {
+        return slots_ + ( pos & ( capacity_ - 1) );
+    }
+
+    static std::intptr_t diff_( std::size_t seq, std::size_t pos) noexcept {
+        return static_cast< std::intptr_t >( seq - pos);
+    }
+
+    // the producer and consumer indices are advanced by seq_cst CAS, the
+    // waiter counts are loaded right after it; a fiber about to block
+    // increments the count and re-checks the indices (both seq_cst) - either
+    // the other side sees the waiter or the waiter sees the new index
+    // (Dekker), the slots themselves are published by release stores
+
+    // channel holds capacity - 1 values (claimed slots included)
+    bool is_full_() const noexcept {
+        std::size_t pidx = pidx_.load( std::memory_order_seq_cst);
+        return capacity_ - 1 <= pidx - cidx_.load( std::memory_order_seq_cst);
+    }
+
+    // no slot claimed by a producer and not yet consumed
+    bool is_empty_() const noexcept {
+        std::size_t cidx = cidx_.load( std::memory_order_seq_cst);
+        return cidx == pidx_.load( std::memory_order_seq_cst);
+    }
 
     bool is_closed_() const noexcept {
-        return closed_;
+        return closed_.load( std::memory_order_acquire);
+    }
+
+    // the next slot of the consumers is claimed by a write_slot that
+    // has not been committed (or abandoned) yet
+    // the handle might be held for an arbitrary time, consumers suspend
+    // until publish_() notifies them
+    bool is_reserved_() const noexcept {
+        std::size_t cidx = cidx_.load( std::memory_order_seq_cst);
+        slot * s = slot_( cidx);
+        return s->held.load( std::memory_order_seq_cst) &&
+               cidx + 1 != ( s->seq.load( std::memory_order_seq_cst) & ~hole_bit);
+    }
+
+    // the next slot of the producers (or the one following it, which must
+    // be free too) is borrowed by a read_slot that has not been released yet,
+    // producers suspend until free_() notifies them
+    bool is_borrowed_() const noexcept {
+        std::size_t pidx = pidx_.load( std::memory_order_seq_cst);
+        for ( std::size_t pos = pidx; pos != pidx + 2; ++pos) {
+            slot * s = slot_( pos);
+            if ( s->held.load( std::memory_order_seq_cst) &&
+                 pos != s->seq.load( std::memory_order_seq_cst) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // a slot has been claimed by push/pop but is not yet published/freed,
+    // by a fiber running on another thread (which might have been preempted)
+    // returns false if timeout_time has been reached
+    static bool backoff_( std::size_t & retries,
+                          std::chrono::steady_clock::time_point const& timeout_time) noexcept {
+        if ( (std::chrono::steady_clock::time_point::max)() != timeout_time &&
+             timeout_time <= std::chrono::steady_clock::now() ) {
+            return false;
+        }
+#if !defined(BOOST_FIBERS_SPIN_SINGLE_CORE)
+        if ( BOOST_FIBERS_SPIN_BEFORE_YIELD > retries) {
+            ++retries;
+            cpu_relax();
+            return true;
+        }
+#endif
+        context::active()->yield();
+        std::this_thread::yield();
+        return true;
+    }
+
+    void notify_( wait_queue & queue, std::size_t waiters, std::size_t n) {
+        // wake as many waiters as values have been transferred
+        n = (std::min)( n, waiters);
+        detail::spinlock_lock lk{ splk_ };
+        for ( std::size_t i = 0; i < n; ++i) {
+            queue.notify_one();
+        }
+    }
+
+    // claims up to n consecutive free slots with one CAS,
+    // returns the number of slots claimed starting at pos
+    std::size_t claim_push_n_( std::size_t n, std::size_t & pos) noexcept {
+        pos = pidx_.load( std::memory_order_relaxed);
+        for (;;) {
+            std::intptr_t dif = diff_( slot_( pos)->seq.load( std::memory_order_acquire), pos);
+            if ( 0 < dif) {
+                // slot has been taken by another producer
+                pos = pidx_.load( std::memory_order_relaxed);
+                continue;
+            }
+            // the slot following the last claimed one must be free too
+            std::size_t k = 0;
+            if ( 0 == dif) {
+                while ( k < n && 0 == diff_( slot_( pos + k + 1)->seq.load( std::memory_order_acquire), pos + k + 1) ) {
+                    ++k;
+                }
+            }
+            if ( 0 == k) {
+                // full
+                return 0;
+            }
+            if ( pidx_.compare_exchange_weak( pos, pos + k, std::memory_order_seq_cst, std::memory_order_relaxed) ) {
+                return k;
+            }
+        }
+    }
+
+    // fn(i) yields the i-th value
+    // a claimed slot has to be published: if constructing a value throws,
+    // this slot and the remaining claimed slots are published as holes
+    // (the values not moved into the channel are left untouched)
+    template< typename Fn >
+    std::size_t try_enqueue_n_( std::size_t n, Fn && fn) {
+        std::size_t pos = 0;
+        std::size_t k = claim_push_n_( n, pos);
+        if ( 0 == k) {
+            return 0;
+        }
+        std::size_t waiters = waiting_consumers_count_.load( std::memory_order_seq_cst);
+        std::size_t i = 0;
+        try {
+            for ( ; i < k; ++i) {
+                slot * s = slot_( pos + i);
+                ::new ( static_cast< void * >( s->value() ) ) value_type( fn( i) );
+                s->seq.store( pos + i + 1, std::memory_order_release);
+            }
+        } catch (...) {
+            for ( ; i < k; ++i) {
+                slot_( pos + i)->seq.store( ( pos + i + 1) | hole_bit, std::memory_order_release);
+            }
+            if ( BOOST_UNLIKELY( 0 != waiters) ) {
+                notify_( waiting_consumers_, waiters, k);
+            }
+            throw;
+        }
+        if ( BOOST_UNLIKELY( 0 != waiters) ) {
+            notify_( waiting_consumers_, waiters, k);
+        }
+        return k;
+    }
+
+    bool try_enqueue_( value_type && value) {
+        return 0 != try_enqueue_n_( 1, [&value](std::size_t) -> value_type && { return std::move( value); });
+    }
+
+    // claims up to n consecutive published slots with one CAS,
+    // returns the number of slots claimed starting at pos
+    std::size_t claim_pop_n_( std::size_t n, std::size_t & pos) noexcept {
+        pos = cidx_.load( std::memory_order_relaxed);
+        for (;;) {
+            std::intptr_t dif = diff_( slot_( pos)->seq.load( std::memory_order_acquire) & ~hole_bit, pos + 1);
+            if ( 0 < dif) {
+                // slot has been taken by another consumer
+                pos = cidx_.load( std::memory_order_relaxed);
+                continue;
+            }
+            if ( 0 > dif) {
+                // empty (or the value is not yet published)
+                return 0;
+            }
+            std::size_t k = 1;
+            while ( k < n && 0 == diff_( slot_( pos + k)->seq.load( std::memory_order_acquire) & ~hole_bit, pos + k + 1) ) {
+                ++k;
+            }
+            if ( cidx_.compare_exchange_weak( pos, pos + k, std::memory_order_seq_cst, std::memory_order_relaxed) ) {
+                return k;
+            }
+        }
+    }
+
+    // fn(i, v) is applied to the i-th value before it is destroyed,
+    // holes are freed without counting them
+    // a claimed slot has to be freed: if fn throws, the values of the
+    // remaining claimed slots are destroyed
+    template< typename Fn >
+    std::size_t try_dequeue_n_( std::size_t n, Fn && fn) {
+        for (;;) {
+            std::size_t pos = 0;
+            std::size_t k = claim_pop_n_( n, pos);
+            if ( 0 == k) {
+                return 0;
+            }
+            std::size_t waiters = waiting_producers_count_.load( std::memory_order_seq_cst);
+            std::size_t count = 0;
+            std::size_t i = 0;
+            try {
+                for ( ; i < k; ++i) {
+                    slot * s = slot_( pos + i);
+                    if ( BOOST_LIKELY( 0 == ( s->seq.load( std::memory_order_relaxed) & hole_bit) ) ) {
+                        fn( count++, * s->value() );
+                        s->value()->~value_type();
+                    }
+                    s->seq.store( pos + i + capacity_, std::memory_order_release);
+                }
+            } catch (...) {
+                for ( ; i < k; ++i) {
+                    slot * s = slot_( pos + i);
+                    if ( 0 == ( s->seq.load( std::memory_order_relaxed) & hole_bit) ) {
+                        s->value()->~value_type();
+                    }
+                    s->seq.store( pos + i + capacity_, std::memory_order_release);
+                }
+                if ( BOOST_UNLIKELY( 0 != waiters) ) {
+                    notify_( waiting_producers_, waiters, k);
+                }
+                throw;
+            }
+            if ( BOOST_UNLIKELY( 0 != waiters) ) {
+                notify_( waiting_producers_, waiters, k);
+            }
+            if ( BOOST_LIKELY( 0 != count) ) {
+                return count;
+            }
+        }
+    }
+
+    // a fiber might have blocked on a slot held by a write_slot/read_slot
+    // after the handle has been created (see is_reserved_()/is_borrowed_()):
+    // the waiter count is loaded after the slot has been published/freed,
+    // separated by a seq_cst fence - either the waiter sees the new
+    // sequence number or the count includes the waiter
+    // the slots behind the held one might have been published/freed while
+    // the fibers were blocked, without notifying them - as many waiters
+    // as slots became available are woken
+
+    // publishes a slot filled through a write_slot (or a hole)
+    void publish_( slot * s, std::size_t seq) noexcept {
+        s->held.store( false, std::memory_order_relaxed);
+        s->seq.store( seq, std::memory_order_release);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        std::size_t waiters = waiting_consumers_count_.load( std::memory_order_relaxed);
+        if ( BOOST_UNLIKELY( 0 != waiters) ) {
+            std::size_t cidx = cidx_.load( std::memory_order_relaxed);
+            notify_( waiting_consumers_, waiters,
+                     (std::max)( std::size_t{ 1 }, pidx_.load( std::memory_order_relaxed) - cidx) );
+        }
+    }
+
+    // frees a slot borrowed through a read_slot
+    void free_( slot * s, std::size_t pos) noexcept {
+        s->held.store( false, std::memory_order_relaxed);
+        s->seq.store( pos + capacity_, std::memory_order_release);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        std::size_t waiters = waiting_producers_count_.load( std::memory_order_relaxed);
+        if ( BOOST_UNLIKELY( 0 != waiters) ) {
+            std::size_t cidx = cidx_.load( std::memory_order_relaxed);
+            std::size_t used = pidx_.load( std::memory_order_relaxed) - cidx;
+            notify_( waiting_producers_, waiters,
+                     capacity_ - 1 > used ? capacity_ - 1 - used : 1);
+        }
+    }
+
+    bool try_reserve_( write_slot & ws) noexcept {
+        std::size_t pos = 0;
+        if ( 0 == claim_push_n_( 1, pos) ) {
+            return false;
+        }
+        slot * s = slot_( pos);
+        s->held.store( true, std::memory_order_relaxed);
+        ws = write_slot{ this, s, pos };
+        return true;
+    }
+
+    bool try_borrow_( read_slot & rs) noexcept {
+        for (;;) {
+            std::size_t pos = 0;
+            if ( 0 == claim_pop_n_( 1, pos) ) {
+                return false;
+            }
+            slot * s = slot_( pos);
+            if ( BOOST_LIKELY( 0 == ( s->seq.load( std::memory_order_relaxed) & hole_bit) ) ) {
+                s->held.store( true, std::memory_order_relaxed);
+                rs = read_slot{ this, s, pos };
+                return true;
+            }
+            free_( s, pos);
+        }
+    }
+
+    template< typename Fn >
+    bool try_dequeue_( Fn && fn) {
+        return 0 != try_dequeue_n_( 1, [&fn](std::size_t, value_type & v){ fn( v); });
     }
 
+    bool try_dequeue_( value_type & value) {
+        return try_dequeue_( [&value](value_type & v){ value = std::move( v); });
+    }
+
+    // slow path of the producers, returns false on timeout
+    // returns without blocking if a slot is about to become free
+    bool wait_not_full_( std::chrono::steady_clock::time_point const& timeout_time, std::size_t & retries) {
+        context * active_ctx = context::active();
+        bool timed_out = false;
+        detail::spinlock_lock lk{ splk_ };
+        waiting_producers_count_.fetch_add( 1, std::memory_order_seq_cst);
+        if ( ( is_full_() || is_borrowed_() ) && ! is_closed_() ) {
+            if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                waiting_producers_.suspend_and_wait( lk, active_ctx);
+            } else {
+                timed_out = ! waiting_producers_.suspend_and_wait_until( lk, active_ctx, timeout_time);
+            }
+        } else {
+            lk.unlock();
+            timed_out = ! backoff_( retries, timeout_time);
+        }
+        waiting_producers_count_.fetch_sub( 1, std::memory_order_relaxed);
+        return ! timed_out;
+    }
+
+    // slow path of the consumers, returns false on timeout
+    // returns without blocking if a value is about to be published
+    // a closed channel is drained: consumers wait for a held write_slot
+    bool wait_not_empty_( std::chrono::steady_clock::time_point const& timeout_time, std::size_t & retries) {
+        context * active_ctx = context::active();
+        bool timed_out = false;
+        detail::spinlock_lock lk{ splk_ };
+        waiting_consumers_count_.fetch_add( 1, std::memory_order_seq_cst);
+        if ( is_empty_() ? ! is_closed_() : is_reserved_() ) {
+            if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                waiting_consumers_.suspend_and_wait( lk, active_ctx);
+            } else {
+                timed_out = ! waiting_consumers_.suspend_and_wait_until( lk, active_ctx, timeout_time);
+            }
+        } else {
+            lk.unlock();
+            timed_out = ! backoff_( retries, timeout_time);
+        }
+        waiting_consumers_count_.fetch_sub( 1, std::memory_order_relaxed);
+        return ! timed_out;
+    }
+
+    channel_op_status try_push_( value_type && value) {
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        return try_enqueue_( std::move( value) )
+            ? channel_op_status::success
+            : channel_op_status::full;
+    }
+
+    // blocks until try_() succeeds (producer side)
+    template< typename Try >
+    channel_op_status push_wait_( Try && try_, std::chrono::steady_clock::time_point const& timeout_time) {
+        std::size_t retries = 0;
+        for (;;) {
+            if ( BOOST_UNLIKELY( is_closed_() ) ) {
+                return channel_op_status::closed;
+            }
+            if ( try_() ) {
+                return channel_op_status::success;
+            }
+            if ( ! wait_not_full_( timeout_time, retries) ) {
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+    channel_op_status push_( value_type && value, std::chrono::steady_clock::time_point const& timeout_time) {
+        return push_wait_( [this,&value](){ return try_enqueue_( std::move( value) ); }, timeout_time);
+    }
+
+    // pushes all n values (moved from), count reports the number of values
+    // pushed before the channel got closed
+    channel_op_status push_n_( value_type * values, std::size_t n, std::size_t & count) {
+        std::size_t retries = 0;
+        count = 0;
+        while ( count < n) {
+            if ( BOOST_UNLIKELY( is_closed_() ) ) {
+                return channel_op_status::closed;
+            }
+            std::size_t k = try_enqueue_n_( n - count,
+                    [values,count](std::size_t i) -> value_type && { return std::move( values[count + i]); });
+            if ( 0 == k) {
+                wait_not_full_( (std::chrono::steady_clock::time_point::max)(), retries);
+            }
+            count += k;
+        }
+        return channel_op_status::success;
+    }
+
+    // blocks until try_() succeeds (consumer side)
+    template< typename Try >
+    channel_op_status pop_wait_( Try && try_, std::chrono::steady_clock::time_point const& timeout_time) {
+        std::size_t retries = 0;
+        for (;;) {
+            if ( try_() ) {
+                return channel_op_status::success;
+            }
+            if ( BOOST_UNLIKELY( is_closed_() && is_empty_() ) ) {
+                return channel_op_status::closed;
+            }
+            if ( ! wait_not_empty_( timeout_time, retries) ) {
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+    // blocks until at least one value is available, pops up to n values
+    template< typename Fn >
+    channel_op_status pop_n_( std::size_t n, Fn && fn,
+                              std::chrono::steady_clock::time_point const& timeout_time,
+                              std::size_t & count) {
+        return pop_wait_( [this,n,&fn,&count](){
+                              count = try_dequeue_n_( n, fn);
+                              return 0 != count;
+                          }, timeout_time);
+    }
+
+    template< typename Fn >
+    channel_op_status pop_( Fn && fn, std::chrono::steady_clock::time_point const& timeout_time) {
+        std::size_t count = 0;
+        return pop_n_( 1, [&fn](std::size_t, value_type & v){ fn( v); }, timeout_time, count);
+    }
+
+    // select support: w is linked into the wait-queue and counted as waiter,
+    // returns true if the operation might complete now
+    bool enlist_producer_( waker_with_hook & w) {
+        detail::spinlock_lock lk{ splk_ };
+        waiting_producers_count_.fetch_add( 1, std::memory_order_seq_cst);
+        waiting_producers_.enqueue( w);
+        return ( ! is_full_() && ! is_borrowed_() ) || is_closed_();
+    }
+
+    // a notification consumed by w is passed on if the fiber
+    // did not select this channel
+    void delist_producer_( waker_with_hook & w, bool selected) {
+        detail::spinlock_lock lk{ splk_ };
+        bool notified = ! w.is_linked();
+        waiting_producers_.remove( w);
+        waiting_producers_count_.fetch_sub( 1, std::memory_order_relaxed);
+        if ( notified && ! selected && ! is_full_() ) {
+            waiting_producers_.notify_one();
+        }
+    }
+
+    bool enlist_consumer_( waker_with_hook & w) {
+        detail::spinlock_lock lk{ splk_ };
+        waiting_consumers_count_.fetch_add( 1, std::memory_order_seq_cst);
+        waiting_consumers_.enqueue( w);
+        return is_empty_() ? is_closed_() : ! is_reserved_();
+    }
+
+    void delist_consumer_( waker_with_hook & w, bool selected) {
+        detail::spinlock_lock lk{ splk_ };
+        bool notified = ! w.is_linked();
+        waiting_consumers_.remove( w);
+        waiting_consumers_count_.fetch_sub( 1, std::memory_order_relaxed);
+        if ( notified && ! selected && ! is_empty_() ) {
+            waiting_consumers_.notify_one();
+        }
+    }
+
+    template< typename Channel >
+    friend class detail::select_push_case;
+    template< typename Channel >
+    friend class detail::select_pop_case;
+
 public:
+    // a claimed, uninitialised slot of the channel
+    // the value is constructed in place by emplace() and published by
+    // commit(); a slot abandoned before (write_slot destroyed or assigned
+    // to) is skipped by the consumers
+    class write_slot {
+    private:
+        friend class buffered_channel;
+
+        buffered_channel    *   chan_{ nullptr };
+        slot                *   s_{ nullptr };
+        std::size_t             pos_{ 0 };
+        bool                    constructed_{ false };
+
+        write_slot( buffered_channel * chan, slot * s, std::size_t pos) noexcept :
+            chan_{ chan },
+            s_{ s },
+            pos_{ pos } {
+        }
+
+        void abandon_() noexcept {
+            if ( nullptr != s_) {
+                if ( constructed_) {
+                    s_->value()->~value_type();
+                }
+                chan_->publish_( s_, ( pos_ + 1) | hole_bit);
+                s_ = nullptr;
+            }
+        }
+
+    public:
+        write_slot() = default;
+
+        write_slot( write_slot && other) noexcept :
+            chan_{ other.chan_ },
+            s_{ other.s_ },
+            pos_{ other.pos_ },
+            constructed_{ other.constructed_ } {
+            other.s_ = nullptr;
+        }
+
+        write_slot & operator=( write_slot && other) noexcept {
+            if ( BOOST_LIKELY( this != & other) ) {
+                abandon_();
+                chan_ = other.chan_;
+                s_ = other.s_;
+                pos_ = other.pos_;
+                constructed_ = other.constructed_;
+                other.s_ = nullptr;
+            }
+            return * this;
+        }
+
+        write_slot( write_slot const&) = delete;
+        write_slot & operator=( write_slot const&) = delete;
+
+        ~write_slot() {
+            abandon_();
+        }
+
+        explicit operator bool() const noexcept {
+            return nullptr != s_;
+        }
+
+        template< typename ... Args >
+        value_type & emplace( Args && ... args) {
+            BOOST_ASSERT( nullptr != s_);
+            BOOST_ASSERT( ! constructed_);
+            ::new ( static_cast< void * >( s_->value() ) ) value_type( std::forward< Args >( args) ... );
+            constructed_ = true;
+            return * s_->value();
+        }
+
+        value_type & get() noexcept {
+            BOOST_ASSERT( constructed_);
+            return * s_->value();
+        }
+
+        void commit() noexcept {
+            BOOST_ASSERT( nullptr != s_);
+            BOOST_ASSERT( constructed_);
+            chan_->publish_( s_, pos_ + 1);
+            s_ = nullptr;
+        }
+    };
+
+    // a value borrowed from the channel, it stays in its slot until
+    // release() is called (or the read_slot is destroyed or assigned to)
+    class read_slot {
+    private:
+        friend class buffered_channel;
+
+        buffered_channel    *   chan_{ nullptr };
+        slot                *   s_{ nullptr };
+        std::size_t             pos_{ 0 };
+
+        read_slot( buffered_channel * chan, slot * s, std::size_t pos) noexcept :
+            chan_{ chan },
+            s_{ s },
+            pos_{ pos } {
+        }
+
+    public:
+        read_slot() = default;
+
+        read_slot( read_slot && other) noexcept :
+            chan_{ other.chan_ },
+            s_{ other.s_ },
+            pos_{ other.pos_ } {
+            other.s_ = nullptr;
+        }
+
+        read_slot & operator=( read_slot && other) noexcept {
+            if ( BOOST_LIKELY( this != & other) ) {
+                release();
+                chan_ = other.chan_;
+                s_ = other.s_;
+                pos_ = other.pos_;
+                other.s_ = nullptr;
+            }
+            return * this;
+        }
+
+        read_slot( read_slot const&) = delete;
+        read_slot & operator=( read_slot const&) = delete;
+
+        ~read_slot() {
+            release();
+        }
+
+        explicit operator bool() const noexcept {
+            return nullptr != s_;
+        }
+
+        value_type & get() noexcept {
+            BOOST_ASSERT( nullptr != s_);
+            return * s_->value();
+        }
+
+        value_type & operator*() noexcept {
+            return get();
+        }
+
+        value_type * operator->() noexcept {
+            return std::addressof( get() );
+        }
+
+        void release() noexcept {
+            if ( nullptr != s_) {
+                s_->value()->~value_type();
+                chan_->free_( s_, pos_);
+                s_ = nullptr;
+            }
+        }
+    };
+
     explicit buffered_channel( std::size_t capacity) :
             capacity_{ capacity } {
         if ( BOOST_UNLIKELY( 2 > capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) ) { 
             throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
                                "boost fiber: buffer capacity is invalid" };
         }
-        slots_ = new slot_type[capacity_];
+        slots_ = new slot[capacity_];
+        for ( std::size_t i = 0; i < capacity_; ++i) {
+            slots_[i].seq.store( i, std::memory_order_relaxed);
+        }
     }
 
     ~buffered_channel() {
         close();
+        std::size_t pidx = pidx_.load( std::memory_order_relaxed);
+        for ( std::size_t pos = cidx_.load( std::memory_order_relaxed); pos != pidx; ++pos) {
+            if ( 0 == ( slot_( pos)->seq.load( std::memory_order_relaxed) & hole_bit) ) {
+                slot_( pos)->value()->~value_type();
+            }
+        }
         delete [] slots_;
     }
 
@@ -80,82 +741,33 @@ public:
     buffered_channel & operator=( buffered_channel const&) = delete;
 
     bool is_closed() const noexcept {
-        detail::spinlock_lock lk{ splk_ };
         return is_closed_();
     }
 
     void close() noexcept {
         detail::spinlock_lock lk{ splk_ };
-        if ( ! closed_) {
-            closed_ = true;
+        if ( ! closed_.load( std::memory_order_relaxed) ) {
+            closed_.store( true, std::memory_order_seq_cst);
             waiting_producers_.notify_all();
             waiting_consumers_.notify_all();
         }
     }
 
     channel_op_status try_push( value_type const& value) {
-        detail::spinlock_lock lk{ splk_ };
-        if ( BOOST_UNLIKELY( is_closed_() ) ) {
-            return channel_op_status::closed;
-        }
-        if ( is_full_() ) {
-            return channel_op_status::full;
-        }
-        slots_[pidx_] = value;
-        pidx_ = (pidx_ + 1) % capacity_;
-        waiting_consumers_.notify_one();
-        return channel_op_status::success;
+        // copy before a slot gets claimed
+        return try_push_( value_type( value) );
     }
 
     channel_op_status try_push( value_type && value) {
-        detail::spinlock_lock lk{ splk_ };
-        if ( BOOST_UNLIKELY( is_closed_() ) ) {
-            return channel_op_status::closed;
-        }
-        if ( is_full_() ) {
-            return channel_op_status::full;
-        }
-        slots_[pidx_] = std::move( value);
-        pidx_ = (pidx_ + 1) % capacity_;
-        waiting_consumers_.notify_one();
-        return channel_op_status::success;
+        return try_push_( std::move( value) );
     }
 
     channel_op_status push( value_type const& value) {
-        context * active_ctx = context::active();
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                return channel_op_status::closed;
-            }
-            if ( is_full_() ) {
-                waiting_producers_.suspend_and_wait( lk, active_ctx);
-            } else {
-                slots_[pidx_] = value;
-                pidx_ = (pidx_ + 1) % capacity_;
-                waiting_consumers_.notify_one();
-                return channel_op_status::success;
-            }
-        }
+        return push_( value_type( value), (std::chrono::steady_clock::time_point::max)() );
     }
 
     channel_op_status push( value_type && value) {
-        context * active_ctx = context::active();
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                return channel_op_status::closed;
-            }
-            if ( is_full_() ) {
-                waiting_producers_.suspend_and_wait( lk, active_ctx);
-            } else {
-                slots_[pidx_] = std::move( value);
-                pidx_ = (pidx_ + 1) % capacity_;
-
-                waiting_consumers_.notify_one();
-                return channel_op_status::success;
-            }
-        }
+        return push_( std::move( value), (std::chrono::steady_clock::time_point::max)() );
     }
 
     template< typename Rep, typename Period >
@@ -174,100 +786,89 @@ public:
 
     template< typename Clock, typename Duration >
     channel_op_status push_wait_until( value_type const& value,
-                                       std::chrono::time_point< Clock, Duration > const& timeout_time_) {
-        context * active_ctx = context::active();
-        std::chrono::steady_clock::time_point timeout_time = detail::convert( timeout_time_);
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                return channel_op_status::closed;
-            }
-            if ( is_full_() ) {
-                if ( ! waiting_producers_.suspend_and_wait_until( lk, active_ctx, timeout_time)) {
-                    return channel_op_status::timeout;
-                }
-            } else {
-                slots_[pidx_] = value;
-                pidx_ = (pidx_ + 1) % capacity_;
-                waiting_consumers_.notify_one();
-                return channel_op_status::success;
-            }
-        }
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( value_type( value), detail::convert( timeout_time) );
     }
 
     template< typename Clock, typename Duration >
     channel_op_status push_wait_until( value_type && value,
-                                       std::chrono::time_point< Clock, Duration > const& timeout_time_) {
-        context * active_ctx = context::active();
-        std::chrono::steady_clock::time_point timeout_time = detail::convert( timeout_time_);
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                return channel_op_status::closed;
-            }
-            if ( is_full_() ) {
-                if ( ! waiting_producers_.suspend_and_wait_until( lk, active_ctx, timeout_time)) {
-                    return channel_op_status::timeout;
-                }
-            } else {
-                slots_[pidx_] = std::move( value);
-                pidx_ = (pidx_ + 1) % capacity_;
-                // notify one waiting consumer
-                waiting_consumers_.notify_one();
-                return channel_op_status::success;
-            }
-        }
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( std::move( value), detail::convert( timeout_time) );
     }
 
     channel_op_status try_pop( value_type & value) {
-        detail::spinlock_lock lk{ splk_ };
-        if ( is_empty_() ) {
-            return is_closed_()
-                ? channel_op_status::closed
-                : channel_op_status::empty;
-        }
-        value = std::move( slots_[cidx_]);
-        cidx_ = (cidx_ + 1) % capacity_;
-        waiting_producers_.notify_one();
-        return channel_op_status::success;
+        if ( try_dequeue_( value) ) {
+            return channel_op_status::success;
+        }
+        return is_closed_() && is_empty_()
+            ? channel_op_status::closed
+            : channel_op_status::empty;
     }
 
-    channel_op_status pop( value_type & value) {
-        context * active_ctx = context::active();
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( is_empty_() ) {
-                if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                    return channel_op_status::closed;
-                }
-                waiting_consumers_.suspend_and_wait( lk, active_ctx);
-            } else {
-                value = std::move( slots_[cidx_]);
-                cidx_ = (cidx_ + 1) % capacity_;
-                waiting_producers_.notify_one();
-                return channel_op_status::success;
-            }
+    // pushes as many of the n values as fit without blocking (moved from)
+    // full: count < n values have been pushed
+    channel_op_status try_push_n( value_type * values, std::size_t n, std::size_t & count) {
+        count = 0;
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        count = try_enqueue_n_( n,
+                [values](std::size_t i) -> value_type && { return std::move( values[i]); });
+        return n == count
+            ? channel_op_status::success
+            : channel_op_status::full;
+    }
+
+    // blocks until all n values are pushed (moved from)
+    // closed: count < n values have been pushed before the channel got closed
+    channel_op_status push_n( value_type * values, std::size_t n, std::size_t & count) {
+        return push_n_( values, n, count);
+    }
+
+    // pops up to n values without blocking
+    channel_op_status try_pop_n( value_type * values, std::size_t n, std::size_t & count) {
+        if ( BOOST_UNLIKELY( 0 == n) ) {
+            count = 0;
+            return channel_op_status::success;
+        }
+        count = try_dequeue_n_( n,
+                [values](std::size_t i, value_type & v){ values[i] = std::move( v); });
+        if ( 0 != count) {
+            return channel_op_status::success;
         }
+        return is_closed_() && is_empty_()
+            ? channel_op_status::closed
+            : channel_op_status::empty;
+    }
+
+    // blocks until at least one value is available, pops up to n values
+    channel_op_status pop_n( value_type * values, std::size_t n, std::size_t & count) {
+        count = 0;
+        if ( BOOST_UNLIKELY( 0 == n) ) {
+            return channel_op_status::success;
+        }
+        return pop_n_( n, [values](std::size_t i, value_type & v){ values[i] = std::move( v); },
+                       (std::chrono::steady_clock::time_point::max)(), count);
+    }
+
+    channel_op_status pop( value_type & value) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     (std::chrono::steady_clock::time_point::max)() );
     }
 
     value_type value_pop() {
-        context * active_ctx = context::active();
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( is_empty_() ) {
-                if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                    throw fiber_error{
-                        std::make_error_code( std::errc::operation_not_permitted),
-                        "boost fiber: channel is closed" };
-                }
-                waiting_consumers_.suspend_and_wait( lk, active_ctx);
-            } else {
-                value_type value = std::move( slots_[cidx_]);
-                cidx_ = (cidx_ + 1) % capacity_;
-                waiting_producers_.notify_one();
-                return value;
-            }
+        typename slot::storage_type storage;
+        value_type * p = reinterpret_cast< value_type * >( std::addressof( storage) );
+        if ( BOOST_UNLIKELY( channel_op_status::success != pop_(
+                        [p](value_type & v){ ::new ( static_cast< void * >( p) ) value_type( std::move( v) ); },
+                        (std::chrono::steady_clock::time_point::max)() ) ) ) {
+            throw fiber_error{
+                std::make_error_code( std::errc::operation_not_permitted),
+                "boost fiber: channel is closed" };
         }
+        value_type value( std::move( * p) );
+        p->~value_type();
+        return value;
     }
 
     template< typename Rep, typename Period >
@@ -279,25 +880,67 @@ public:
 
     template< typename Clock, typename Duration >
     channel_op_status pop_wait_until( value_type & value,
-                                      std::chrono::time_point< Clock, Duration > const& timeout_time_) {
-        context * active_ctx = context::active();
-        std::chrono::steady_clock::time_point timeout_time = detail::convert( timeout_time_);
-        for (;;) {
-            detail::spinlock_lock lk{ splk_ };
-            if ( is_empty_() ) {
-                if ( BOOST_UNLIKELY( is_closed_() ) ) {
-                    return channel_op_status::closed;
-                }
-                if ( ! waiting_consumers_.suspend_and_wait_until( lk, active_ctx, timeout_time)) {
-                    return channel_op_status::timeout;
-                }
-            } else {
-                value = std::move( slots_[cidx_]);
-                cidx_ = (cidx_ + 1) % capacity_;
-                waiting_producers_.notify_one();
-                return channel_op_status::success;
-            }
+                                      std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     detail::convert( timeout_time) );
+    }
+
+    // claims a free slot without blocking, see write_slot
+    channel_op_status try_reserve( write_slot & ws) {
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        return try_reserve_( ws)
+            ? channel_op_status::success
+            : channel_op_status::full;
+    }
+
+    channel_op_status reserve( write_slot & ws) {
+        return push_wait_( [this,&ws](){ return try_reserve_( ws); },
+                           (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status reserve_wait_for( write_slot & ws,
+                                        std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return reserve_wait_until( ws,
+                                   std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status reserve_wait_until( write_slot & ws,
+                                          std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_wait_( [this,&ws](){ return try_reserve_( ws); },
+                           detail::convert( timeout_time) );
+    }
+
+    // claims the next value without blocking, see read_slot
+    channel_op_status try_borrow( read_slot & rs) {
+        if ( try_borrow_( rs) ) {
+            return channel_op_status::success;
         }
+        return is_closed_() && is_empty_()
+            ? channel_op_status::closed
+            : channel_op_status::empty;
+    }
+
+    channel_op_status borrow( read_slot & rs) {
+        return pop_wait_( [this,&rs](){ return try_borrow_( rs); },
+                          (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status borrow_wait_for( read_slot & rs,
+                                       std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return borrow_wait_until( rs,
+                                  std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status borrow_wait_until( read_slot & rs,
+                                         std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return pop_wait_( [this,&rs](){ return try_borrow_( rs); },
+                          detail::convert( timeout_time) );
     }
 
     class iterator {
@@ -306,15 +949,32 @@ public:
 
         buffered_channel    *   chan_{ nullptr };
         storage_type            storage_;
+        // storage_ contains the value popped last
+        bool                    valid_{ false };
+
+        value_type * value_() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+
+        void destroy_() noexcept {
+            if ( valid_) {
+                value_()->~value_type();
+                valid_ = false;
+            }
+        }
 
-        void increment_( bool initial = false) {
+        void increment_() {
             BOOST_ASSERT( nullptr != chan_);
-            try {
-                if ( ! initial) {
-                    reinterpret_cast< value_type * >( std::addressof( storage_) )->~value_type();
-                }
-                ::new ( static_cast< void * >( std::addressof( storage_) ) ) value_type{ chan_->value_pop() };
-            } catch ( fiber_error const&) {
+            destroy_();
+            // one value at a time: a value popped ahead would be lost
+            // if the range-for loop is left early
+            if ( channel_op_status::success == chan_->pop_(
+                        [this](value_type & v){
+                            ::new ( static_cast< void * >( value_() ) ) value_type( std::move( v) );
+                        },
+                        (std::chrono::steady_clock::time_point::max)() ) ) {
+                valid_ = true;
+            } else {
                 chan_ = nullptr;
             }
         }
@@ -330,17 +990,22 @@ public:
 
         iterator() = default;
 
-        explicit iterator( buffered_channel< T > * chan) noexcept :
+        explicit iterator( buffered_channel< T > * chan) :
             chan_{ chan } {
-            increment_( true);
+            increment_();
         }
 
         iterator( iterator const& other) noexcept :
             chan_{ other.chan_ } {
         }
 
+        ~iterator() {
+            destroy_();
+        }
+
         iterator & operator=( iterator const& other) noexcept {
             if ( BOOST_LIKELY( this != & other) ) {
+                destroy_();
                 chan_ = other.chan_;
             }
             return * this;
@@ -355,7 +1020,6 @@ public:
         }
 
         iterator & operator++() {
-            reinterpret_cast< value_type * >( std::addressof( storage_) )->~value_type();
             increment_();
             return * this;
         }
@@ -363,11 +1027,11 @@ public:
         const iterator operator++( int) = delete;
 
         reference_t operator*() noexcept {
-            return * reinterpret_cast< value_type * >( std::addressof( storage_) );
+            return * value_();
         }
 
         pointer_t operator->() noexcept {
-            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+            return value_();
         }
     };
 
@@ -162,22 +162,22 @@ public:
     void wait( std::unique_lock< mutex > & lt) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         cnd_.wait( lt);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
     }
 
     template< typename Pred >
     void wait( std::unique_lock< mutex > & lt, Pred pred) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         cnd_.wait( lt, pred);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
     }
 
     template< typename Clock, typename Duration >
@@ -185,11 +185,11 @@ public:
                           std::chrono::time_point< Clock, Duration > const& timeout_time) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         cv_status result = cnd_.wait_until( lt, timeout_time);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         return result;
     }
 
@@ -198,11 +198,11 @@ public:
                      std::chrono::time_point< Clock, Duration > const& timeout_time, Pred pred) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         bool result = cnd_.wait_until( lt, timeout_time, pred);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         return result;
     }
 
@@ -211,11 +211,11 @@ public:
                         std::chrono::duration< Rep, Period > const& timeout_duration) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         cv_status result = cnd_.wait_for( lt, timeout_duration);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         return result;
     }
 
@@ -224,11 +224,11 @@ public:
                    std::chrono::duration< Rep, Period > const& timeout_duration, Pred pred) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         bool result = cnd_.wait_for( lt, timeout_duration, pred);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->owner_() );
         return result;
     }
 };
@@ -43,6 +43,7 @@
 #include <boost/fiber/policy.hpp>
 #include <boost/fiber/properties.hpp>
 #include <boost/fiber/segmented_stack.hpp>
+#include <boost/fiber/stack_cache.hpp>
 #include <boost/fiber/type.hpp>
 #include <boost/fiber/waker.hpp>
 
@@ -73,12 +74,21 @@ typedef intrusive::list_member_hook<
 >                                       ready_hook;
 
 struct sleep_tag;
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+typedef intrusive::list_member_hook<
+    intrusive::tag< sleep_tag >,
+    intrusive::link_mode<
+        intrusive::auto_unlink
+    >
+>                                       sleep_hook;
+#else
 typedef intrusive::set_member_hook<
     intrusive::tag< sleep_tag >,
     intrusive::link_mode<
         intrusive::auto_unlink
     >
 >                                       sleep_hook;
+#endif
 
 struct worker_tag;
 typedef intrusive::list_member_hook<
@@ -96,13 +106,20 @@ typedef intrusive::slist_member_hook<
     >
 >                                       terminated_hook;
 
-struct remote_ready_tag;
-typedef intrusive::slist_member_hook<
-    intrusive::tag< remote_ready_tag >,
-    intrusive::link_mode<
-        intrusive::safe_link
-    >
->                                       remote_ready_hook;
+// hook of the lock-free remote ready-queue (context_mpsc_queue)
+// `next` is written by the producers, `linked` is only used
+// for sanity checks
+struct remote_ready_hook {
+    std::atomic< remote_ready_hook * >  next{ nullptr };
+    bool                                linked{ false };
+
+    bool is_linked() const noexcept {
+        return linked;
+    }
+};
+
+class context_mpsc_queue;
+class context_timer_wheel;
 
 }
 
@@ -112,6 +129,8 @@ private:
     friend class main_context;
     template< typename Fn, typename ... Arg > friend class worker_context;
     friend class scheduler;
+    friend class detail::context_mpsc_queue;
+    friend class detail::context_timer_wheel;
 
     struct fss_data {
         void                                *   vp{ nullptr };
@@ -279,6 +298,14 @@ public:
 
     bool wake(const size_t) noexcept;
 
+    // like wake(), but a context of the active scheduler is
+    // resumed next (see scheduler::schedule_handoff())
+    bool handoff(const size_t) noexcept;
+
+    // makes the wakers of this epoch outdated without scheduling the context,
+    // returns false if one of them has already woken it
+    bool cancel_wake(const size_t) noexcept;
+
     waker create_waker() noexcept {
         // this operation makes all previously created wakers to be outdated
         return { this, ++waker_epoch_ };
@@ -332,11 +359,11 @@ public:
         lst.push_back( * this);
     }
 
-    template< typename List >
-    void remote_ready_link( List & lst) noexcept {
-        static_assert( std::is_same< typename List::value_traits::hook_type, detail::remote_ready_hook >::value, "not a remote-ready-queue");
+    template< typename Queue >
+    void remote_ready_link( Queue & q) noexcept {
+        static_assert( std::is_same< Queue, detail::context_mpsc_queue >::value, "not a remote-ready-queue");
         BOOST_ASSERT( ! remote_ready_is_linked() );
-        lst.push_back( * this);
+        q.push( this);
     }
 
     template< typename Set >
@@ -472,7 +499,9 @@ static intrusive_ptr< context > make_worker_context( launch policy,
                                                      Fn && fn, Arg ... arg) {
     typedef worker_context< Fn, Arg ... >   context_t;
 
-    auto sctx = salloc.allocate();
+    // stacks of terminated fibers are recycled if possible
+    auto stack_alloc = detail::make_stack_allocator( std::forward< StackAlloc >( salloc) );
+    auto sctx = stack_alloc.allocate();
     // reserve space for control structure
     void * storage = reinterpret_cast< void * >(
             ( reinterpret_cast< uintptr_t >( sctx.sp) - static_cast< uintptr_t >( sizeof( context_t) ) )
@@ -485,7 +514,7 @@ static intrusive_ptr< context > make_worker_context( launch policy,
             new ( storage) context_t{
                 policy,
                 boost::context::preallocated{ storage, size, sctx },
-                std::forward< StackAlloc >( salloc),
+                std::move( stack_alloc),
                 std::forward< Fn >( fn),
                 std::forward< Arg >( arg) ... } };
 }
@@ -0,0 +1,115 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_COUNTING_SEMAPHORE_H
+#define BOOST_FIBERS_COUNTING_SEMAPHORE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class BOOST_FIBERS_DECL counting_semaphore_base {
+private:
+    // the counter is kept in the upper bits of the state word
+    static constexpr std::ptrdiff_t waiters_bit = 1;
+    static constexpr std::ptrdiff_t count_unit = 2;
+
+    std::atomic< std::ptrdiff_t >   state_;
+    detail::spinlock                wait_queue_splk_{};
+    wait_queue                      wait_queue_{};
+
+    bool try_acquire_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
+
+public:
+    static constexpr std::ptrdiff_t max_value = PTRDIFF_MAX / count_unit;
+
+    counting_semaphore_base( std::ptrdiff_t desired, std::ptrdiff_t max);
+
+    ~counting_semaphore_base() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    counting_semaphore_base( counting_semaphore_base const&) = delete;
+    counting_semaphore_base & operator=( counting_semaphore_base const&) = delete;
+
+    void release( std::ptrdiff_t update = 1) noexcept;
+
+    void acquire();
+
+    bool try_acquire() noexcept;
+
+    template< typename Clock, typename Duration >
+    bool try_acquire_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time = detail::convert( timeout_time_);
+        return try_acquire_until_( timeout_time);
+    }
+
+    template< typename Rep, typename Period >
+    bool try_acquire_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return try_acquire_until_( std::chrono::steady_clock::now() + timeout_duration);
+    }
+};
+
+}
+
+template< std::ptrdiff_t LeastMaxValue = detail::counting_semaphore_base::max_value >
+class counting_semaphore : private detail::counting_semaphore_base {
+private:
+    static_assert( 0 <= LeastMaxValue && LeastMaxValue <= detail::counting_semaphore_base::max_value,
+                   "LeastMaxValue exceeds the maximum value of a counting_semaphore");
+
+public:
+    static constexpr std::ptrdiff_t max() noexcept {
+        return LeastMaxValue;
+    }
+
+    explicit counting_semaphore( std::ptrdiff_t desired) :
+        detail::counting_semaphore_base{ desired, LeastMaxValue } {
+    }
+
+    using detail::counting_semaphore_base::release;
+    using detail::counting_semaphore_base::acquire;
+    using detail::counting_semaphore_base::try_acquire;
+    using detail::counting_semaphore_base::try_acquire_until;
+    using detail::counting_semaphore_base::try_acquire_for;
+};
+
+using binary_semaphore = counting_semaphore< 1 >;
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_COUNTING_SEMAPHORE_H
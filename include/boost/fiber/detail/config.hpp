@@ -63,4 +63,51 @@
 # define BOOST_FIBERS_SPIN_BEFORE_YIELD 64
 #endif
 
+#if !defined(BOOST_FIBERS_SPIN_BEFORE_SUSPEND)
+// retries of mutex_policy::adaptive before the fiber gets suspended
+# define BOOST_FIBERS_SPIN_BEFORE_SUSPEND 128
+#endif
+
+#if !defined(BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD)
+// microseconds a fiber waits on a mutex_policy::adaptive mutex before
+// unlock() hands the ownership over to the waiters
+# define BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD 1000
+#endif
+
+#if !defined(BOOST_FIBERS_TIMER_WHEEL_TICK)
+// tick of the timer wheel in microseconds
+# define BOOST_FIBERS_TIMER_WHEEL_TICK 1000
+#endif
+
+#if !defined(BOOST_FIBERS_STACK_CACHE_HIGH_WATERMARK)
+# define BOOST_FIBERS_STACK_CACHE_HIGH_WATERMARK 64
+#endif
+
+#if !defined(BOOST_FIBERS_STACK_CACHE_LOW_WATERMARK)
+# define BOOST_FIBERS_STACK_CACHE_LOW_WATERMARK 32
+#endif
+
+#if !defined(BOOST_FIBERS_STEAL_BATCH_MAX)
+// max. number of context' moved by one steal operation
+# define BOOST_FIBERS_STEAL_BATCH_MAX 32
+#endif
+
+#if !defined(BOOST_FIBERS_IDLE_SPIN_DURATION)
+// microseconds an idle work-stealing scheduler spins before it parks
+// zero: park immediately
+# define BOOST_FIBERS_IDLE_SPIN_DURATION 0
+#endif
+
+#if !defined(BOOST_FIBERS_HANDOFF_LIMIT)
+// consecutive direct handoffs a scheduler resumes before it
+// returns to the ready-queue
+# define BOOST_FIBERS_HANDOFF_LIMIT 16
+#endif
+
+#if !defined(BOOST_FIBERS_TRACE_BUFFER_SIZE)
+// number of events kept per thread if tracing is enabled,
+// must be a power of two
+# define BOOST_FIBERS_TRACE_BUFFER_SIZE 16384
+#endif
+
 #endif // BOOST_FIBERS_DETAIL_CONFIG_H
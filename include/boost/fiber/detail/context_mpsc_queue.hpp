@@ -0,0 +1,127 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive/parent_from_member.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+// Dmitry Vyukov. Intrusive MPSC node-based queue.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-private-field"
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// intrusive multi-producer/single-consumer queue
+// push() might be called from any thread (one atomic exchange),
+// pop() must only be called by the thread owning the queue
+class context_mpsc_queue {
+private:
+    // shared cacheline, exchanged by producers
+    std::atomic< remote_ready_hook * >      head_;
+    char                                    pad1_[cacheline_length];
+    // owned by the consumer
+    remote_ready_hook                   *   tail_;
+    remote_ready_hook                       stub_{};
+    char                                    pad2_[cacheline_length];
+
+    static context * to_context_( remote_ready_hook * h) noexcept {
+        return intrusive::get_parent_from_member( h, & context::remote_ready_hook_);
+    }
+
+    void push_( remote_ready_hook * h) noexcept {
+        h->next.store( nullptr, std::memory_order_relaxed);
+        remote_ready_hook * prev = head_.exchange( h, std::memory_order_acq_rel);
+        // the consumer can not pass `prev` until its successor is published
+        prev->next.store( h, std::memory_order_release);
+    }
+
+public:
+    context_mpsc_queue() noexcept :
+        head_{ & stub_ },
+        tail_{ & stub_ } {
+    }
+
+    context_mpsc_queue( context_mpsc_queue const&) = delete;
+    context_mpsc_queue & operator=( context_mpsc_queue const&) = delete;
+
+    bool empty() const noexcept {
+        return & stub_ == tail_ &&
+               & stub_ == head_.load( std::memory_order_acquire);
+    }
+
+    void push( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        remote_ready_hook * h = & ctx->remote_ready_hook_;
+        BOOST_ASSERT( ! h->linked);
+        h->linked = true;
+        push_( h);
+    }
+
+    // returns nullptr if the queue is empty or if a producer
+    // has not finished linking its context yet; in the latter case
+    // the producer notifies the scheduler after push() returned
+    context * pop() noexcept {
+        remote_ready_hook * tail = tail_;
+        remote_ready_hook * next = tail->next.load( std::memory_order_acquire);
+        if ( & stub_ == tail) {
+            if ( nullptr == next) {
+                // queue is empty
+                return nullptr;
+            }
+            // skip stub
+            tail_ = next;
+            tail = next;
+            next = next->next.load( std::memory_order_acquire);
+        }
+        if ( nullptr == next) {
+            if ( tail != head_.load( std::memory_order_acquire) ) {
+                // a producer is between exchange and link
+                return nullptr;
+            }
+            // tail is the last element, re-insert stub
+            // so that tail can be detached
+            push_( & stub_);
+            next = tail->next.load( std::memory_order_acquire);
+            if ( nullptr == next) {
+                return nullptr;
+            }
+        }
+        tail_ = next;
+        tail->linked = false;
+        return to_context_( tail);
+    }
+};
+
+}}}
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic pop
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
@@ -8,6 +8,7 @@
 #ifndef BOOST_FIBERS_DETAIL_SPINLOCK_QUEUE_H
 #define BOOST_FIBERS_DETAIL_SPINLOCK_QUEUE_H
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <mutex>
@@ -107,6 +108,25 @@ public:
 		}
 		return c;
 	}
+
+    // steals up to half of the queued context' (at most `max`)
+    // with one lock acquisition, returns the number of stolen context'
+	std::size_t steal_batch( context ** ctxs, std::size_t max) {
+        spinlock_lock lk{ splk_ };
+		std::size_t size = (pidx_ + capacity_ - cidx_) % capacity_;
+		std::size_t count = (std::min)( (size + 1) / 2, max);
+		std::size_t n = 0;
+		for ( ; n < count; ++n) {
+			context * c = slots_[cidx_];
+            // stop at pinned context, must not be stolen
+            if ( c->is_context( type::pinned_context) ) {
+                break;
+            }
+			ctxs[n] = c;
+			cidx_ = (cidx_ + 1) % capacity_;
+		}
+		return n;
+	}
 };
 
 }}}
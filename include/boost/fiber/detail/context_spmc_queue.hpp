@@ -7,6 +7,7 @@
 #ifndef BOOST_FIBERS_DETAIL_CONTEXT_SPMC_QUEUE_H
 #define BOOST_FIBERS_DETAIL_CONTEXT_SPMC_QUEUE_H
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -186,6 +187,28 @@ public:
         }
         return ctx;
     }
+
+    // steals up to half of the queued context' (at most `max`)
+    // the owner pops without CAS as long as more than one context is
+    // queued, hence a range can not be claimed with a single CAS on top_
+    // -> each context is claimed by its own CAS, stops at the first failure
+    std::size_t steal_batch( context ** ctxs, std::size_t max) {
+        std::size_t top = top_.load( std::memory_order_acquire);
+        std::size_t bottom = bottom_.load( std::memory_order_acquire);
+        if ( bottom <= top) {
+            return 0;
+        }
+        std::size_t count = (std::min)( ( bottom - top + 1) / 2, max);
+        std::size_t n = 0;
+        for ( ; n < count; ++n) {
+            context * ctx = steal();
+            if ( nullptr == ctx) {
+                break;
+            }
+            ctxs[n] = ctx;
+        }
+        return n;
+    }
 };
 
 }}}
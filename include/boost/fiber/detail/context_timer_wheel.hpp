@@ -0,0 +1,238 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_TIMER_WHEEL_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+// George Varghese and Tony Lauck. 1987.
+// Hashed and hierarchical timing wheels: data structures for the efficient
+// implementation of a timer facility.
+// In Proceedings of the eleventh ACM Symposium on Operating systems principles
+// (SOSP '87). ACM, New York, NY, USA, 25-38.
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// hierarchical timing wheel used as sleep-queue
+// insert and cancel (unlink of the sleep-hook) are O(1)
+// deadlines are not rounded: a bucket only narrows the range of
+// candidates, a context is woken if and only if tp_ has been reached
+class context_timer_wheel {
+public:
+    typedef intrusive::list<
+                context,
+                intrusive::member_hook<
+                    context, sleep_hook, & context::sleep_hook_ >,
+                intrusive::constant_time_size< false >
+            >                                               bucket_type;
+    typedef bucket_type::value_traits                       value_traits;
+
+    typedef std::chrono::steady_clock::time_point           time_point;
+    typedef std::chrono::steady_clock::duration             duration;
+
+private:
+    static constexpr std::size_t    slot_bits = 6;
+    static constexpr std::size_t    slot_count = std::size_t{ 1 } << slot_bits;
+    static constexpr std::uint64_t  slot_mask = slot_count - 1;
+    static constexpr std::size_t    level_count = 4;
+
+    bucket_type                     wheel_[level_count][slot_count]{};
+    // deadlines beyond the horizon of the wheel
+    // re-distributed each time the top-most level wraps around
+    bucket_type                     overflow_{};
+    time_point                      origin_;
+    duration                        tick_;
+    // all ticks < current_ have been processed
+    std::uint64_t                   current_{ 0 };
+
+    std::uint64_t ticks_( time_point const& tp) const noexcept {
+        if ( tp <= origin_) {
+            return 0;
+        }
+        if ( (time_point::max)() == tp) {
+            return (std::numeric_limits< std::uint64_t >::max)();
+        }
+        return static_cast< std::uint64_t >( ( tp - origin_) / tick_);
+    }
+
+    time_point time_point_( std::uint64_t ticks) const noexcept {
+        return origin_ + tick_ * static_cast< duration::rep >( ticks);
+    }
+
+    void place_( context & ctx) noexcept {
+        std::uint64_t t = ticks_( ctx.tp_);
+        if ( t < current_) {
+            // deadline already passed, expire with the next tick
+            t = current_;
+        }
+        std::uint64_t delta = t - current_;
+        for ( std::size_t level = 0; level < level_count; ++level) {
+            if ( delta < ( std::uint64_t{ 1 } << ( slot_bits * ( level + 1) ) ) ) {
+                wheel_[level][( t >> ( slot_bits * level) ) & slot_mask].push_back( ctx);
+                return;
+            }
+        }
+        overflow_.push_back( ctx);
+    }
+
+    void cascade_( bucket_type & bucket) noexcept {
+        bucket_type tmp;
+        tmp.swap( bucket);
+        while ( ! tmp.empty() ) {
+            context & ctx = tmp.front();
+            tmp.pop_front();
+            place_( ctx);
+        }
+    }
+
+    // move current_ one tick forward and pull down the
+    // buckets of the upper levels that become due
+    void tick_forward_() noexcept {
+        ++current_;
+        for ( std::size_t level = 1; level < level_count; ++level) {
+            std::size_t shift = slot_bits * level;
+            if ( 0 != ( current_ & ( ( std::uint64_t{ 1 } << shift) - 1) ) ) {
+                return;
+            }
+            cascade_( wheel_[level][( current_ >> shift) & slot_mask]);
+        }
+        if ( 0 == ( current_ & ( ( std::uint64_t{ 1 } << ( slot_bits * level_count) ) - 1) ) ) {
+            cascade_( overflow_);
+        }
+    }
+
+    template< typename Fn >
+    void expire_bucket_( bucket_type & bucket, time_point const& now, Fn && fn) {
+        bucket_type::iterator e = bucket.end();
+        for ( bucket_type::iterator i = bucket.begin(); i != e;) {
+            context * ctx = & ( * i);
+            if ( ctx->tp_ <= now) {
+                i = bucket.erase( i);
+                fn( ctx);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+public:
+    explicit context_timer_wheel(
+            duration tick = std::chrono::microseconds{ BOOST_FIBERS_TIMER_WHEEL_TICK },
+            time_point origin = std::chrono::steady_clock::now() ) noexcept :
+        origin_{ origin },
+        tick_{ tick } {
+        BOOST_ASSERT( duration::zero() < tick_);
+    }
+
+    context_timer_wheel( context_timer_wheel const&) = delete;
+    context_timer_wheel & operator=( context_timer_wheel const&) = delete;
+
+    duration tick() const noexcept {
+        return tick_;
+    }
+
+    bool empty() const noexcept {
+        if ( ! overflow_.empty() ) {
+            return false;
+        }
+        for ( std::size_t level = 0; level < level_count; ++level) {
+            for ( std::size_t slot = 0; slot < slot_count; ++slot) {
+                if ( ! wheel_[level][slot].empty() ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void insert( context & ctx) noexcept {
+        place_( ctx);
+    }
+
+    // calls fn for each context with a deadline <= now
+    // the context is already unlinked when fn is invoked
+    template< typename Fn >
+    void expire( time_point const& now, Fn && fn) {
+        std::uint64_t target = ticks_( now);
+        if ( slot_count < target - current_ && empty() ) {
+            // nothing to do, skip the idle period
+            current_ = target;
+            return;
+        }
+        // every deadline in a bucket of an elapsed tick has been reached
+        while ( current_ < target) {
+            expire_bucket_( wheel_[0][current_ & slot_mask], now, fn);
+            tick_forward_();
+        }
+        // the current tick might contain deadlines not yet reached
+        expire_bucket_( wheel_[0][current_ & slot_mask], now, fn);
+    }
+
+    // returns a time point not later than the earliest deadline
+    // exact if the earliest deadline is stored in the lowest level
+    time_point next_deadline() const noexcept {
+        time_point tp = (time_point::max)();
+        for ( std::uint64_t i = 0; i < slot_count; ++i) {
+            bucket_type const& bucket = wheel_[0][( current_ + i) & slot_mask];
+            if ( ! bucket.empty() ) {
+                for ( context const& ctx : bucket) {
+                    if ( ctx.tp_ < tp) {
+                        tp = ctx.tp_;
+                    }
+                }
+                break;
+            }
+        }
+        // buckets of the upper levels are cascaded at the start of their range,
+        // which might be earlier than a deadline stored in the lowest level
+        for ( std::size_t level = 1; level < level_count; ++level) {
+            std::size_t shift = slot_bits * level;
+            std::uint64_t pos = current_ >> shift;
+            for ( std::uint64_t i = 1; i <= slot_count; ++i) {
+                if ( ! wheel_[level][( pos + i) & slot_mask].empty() ) {
+                    time_point start = time_point_( ( pos + i) << shift);
+                    if ( start < tp) {
+                        tp = start;
+                    }
+                    break;
+                }
+            }
+        }
+        if ( ! overflow_.empty() ) {
+            std::size_t shift = slot_bits * level_count;
+            time_point start = time_point_( ( ( current_ >> shift) + 1) << shift);
+            if ( start < tp) {
+                tp = start;
+            }
+        }
+        return tp;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_TIMER_WHEEL_H
@@ -7,6 +7,10 @@
 #ifndef BOOST_FIBERS_DETAIL_FUTEX_H
 #define BOOST_FIBERS_DETAIL_FUTEX_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
 #include <boost/config.hpp>
 #include <boost/predef.h> 
 
@@ -16,6 +20,7 @@
 extern "C" {
 #include <linux/futex.h>
 #include <sys/syscall.h>
+#include <time.h>
 }
 #elif BOOST_OS_WINDOWS
 #include <windows.h>
@@ -40,6 +45,15 @@ BOOST_FORCEINLINE
 int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x) {
     return 0 <= sys_futex( static_cast< void * >( addr), FUTEX_WAIT_PRIVATE, x) ? 0 : -1;
 }
+
+// returns -1 if the timeout expired (or on spurious failure)
+BOOST_FORCEINLINE
+int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x, std::chrono::nanoseconds const& timeout) {
+    ::timespec ts;
+    ts.tv_sec = static_cast< ::time_t >( std::chrono::duration_cast< std::chrono::seconds >( timeout).count() );
+    ts.tv_nsec = static_cast< long >( ( timeout % std::chrono::seconds{ 1 } ).count() );
+    return 0 <= ::syscall( SYS_futex, static_cast< void * >( addr), FUTEX_WAIT_PRIVATE, x, & ts, nullptr, 0) ? 0 : -1;
+}
 #elif BOOST_OS_WINDOWS
 BOOST_FORCEINLINE
 int futex_wake( std::atomic< std::int32_t > * addr) {
@@ -52,6 +66,14 @@ int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x) {
     ::WaitOnAddress( static_cast< volatile void * >( addr), & x, sizeof( x), INFINITE);
     return 0;
 }
+
+BOOST_FORCEINLINE
+int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x, std::chrono::nanoseconds const& timeout) {
+    // round up, WaitOnAddress() takes milliseconds
+    ::DWORD ms = static_cast< ::DWORD >(
+            std::chrono::duration_cast< std::chrono::milliseconds >( timeout + std::chrono::milliseconds{ 1 } - std::chrono::nanoseconds{ 1 } ).count() );
+    return ::WaitOnAddress( static_cast< volatile void * >( addr), & x, sizeof( x), ms) ? 0 : -1;
+}
 #else
 # warn "no futex support on this platform"
 #endif
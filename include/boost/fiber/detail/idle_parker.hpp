@@ -0,0 +1,131 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_IDLE_PARKER_H
+#define BOOST_FIBERS_DETAIL_IDLE_PARKER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/idle_policy.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
+#include <boost/fiber/detail/thread_parker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// spin-then-park idle loop of the work-stealing schedulers
+// the number of concurrently spinning threads is bounded by a counter
+// shared by all schedulers of a pool, so that an idle pool does not
+// burn all cores (compare to nmspinning of the Go runtime)
+class idle_parker {
+private:
+    thread_parker                   parker_{};
+    std::chrono::microseconds       spin_duration_;
+    std::uint32_t                   max_spinning_;
+    std::atomic< std::uint64_t >    spins_{ 0 };
+    std::atomic< std::uint64_t >    parks_{ 0 };
+    std::atomic< std::uint64_t >    wakeups_{ 0 };
+
+    // returns true if work has been found or the deadline has been reached
+    template< typename Fn >
+    bool spin_( std::chrono::steady_clock::time_point const& time_point,
+                std::atomic< std::uint32_t > & spinning, Fn && probe) noexcept {
+        if ( std::chrono::microseconds::zero() == spin_duration_) {
+            return false;
+        }
+        std::uint32_t n = spinning.load( std::memory_order_relaxed);
+        do {
+            if ( max_spinning_ <= n) {
+                return false;
+            }
+        } while ( ! spinning.compare_exchange_weak( n, n + 1, std::memory_order_acquire, std::memory_order_relaxed) );
+        spins_.fetch_add( 1, std::memory_order_relaxed);
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + spin_duration_;
+        bool found = false;
+        for ( std::uint32_t i = 1; ; ++i) {
+            if ( parker_.try_consume() || probe() ) {
+                found = true;
+                break;
+            }
+            cpu_relax();
+            // reading the clock is expensive
+            if ( 0 == ( i % 16) ) {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if ( time_point <= now) {
+                    // a sleeping fiber became ready
+                    found = true;
+                    break;
+                }
+                if ( deadline <= now) {
+                    break;
+                }
+            }
+        }
+        spinning.fetch_sub( 1, std::memory_order_release);
+        return found;
+    }
+
+public:
+    explicit idle_parker( algo::idle_policy const& policy) noexcept :
+        spin_duration_{ policy.spin_duration },
+        max_spinning_{ 0 != policy.max_spinning
+            ? policy.max_spinning
+            : (std::max)( 1u, std::thread::hardware_concurrency() / 2) } {
+    }
+
+    idle_parker( idle_parker const&) = delete;
+    idle_parker & operator=( idle_parker const&) = delete;
+
+    // probe() tries to find work (e.g. steal), returns true on success
+    // `parked` counts the threads of the pool currently parked
+    template< typename Fn >
+    void idle( std::chrono::steady_clock::time_point const& time_point,
+               std::atomic< std::uint32_t > & spinning,
+               std::atomic< std::uint32_t > & parked, Fn && probe) noexcept {
+        if ( spin_( time_point, spinning, std::forward< Fn >( probe) ) ) {
+            return;
+        }
+        parks_.fetch_add( 1, std::memory_order_relaxed);
+        parked.fetch_add( 1, std::memory_order_relaxed);
+        if ( parker_.park_until( time_point) ) {
+            wakeups_.fetch_add( 1, std::memory_order_relaxed);
+        }
+        parked.fetch_sub( 1, std::memory_order_relaxed);
+    }
+
+    void unpark() noexcept {
+        parker_.unpark();
+    }
+
+    algo::idle_statistics statistics() const noexcept {
+        algo::idle_statistics stats;
+        stats.spins = spins_.load( std::memory_order_relaxed);
+        stats.parks = parks_.load( std::memory_order_relaxed);
+        stats.wakeups = wakeups_.load( std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_IDLE_PARKER_H
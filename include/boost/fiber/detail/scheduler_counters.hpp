@@ -0,0 +1,121 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_SCHEDULER_COUNTERS_H
+#define BOOST_FIBERS_DETAIL_SCHEDULER_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/statistics.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-private-field"
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// counters of one scheduler
+// written by the thread running the scheduler with plain load/store
+// (no read-modify-write), except remote_wakeups; read from any thread
+class scheduler_counters {
+private:
+    char                                    pad1_[cacheline_length];
+
+    template< typename T >
+    static void add_( std::atomic< T > & counter, T n) noexcept {
+        counter.store( counter.load( std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    // owned by the scheduler's thread
+    std::atomic< std::uint64_t >            context_switches{ 0 };
+    std::atomic< std::uint64_t >            wakeups{ 0 };
+    std::atomic< std::int64_t >             ready{ 0 };
+    std::atomic< std::int64_t >             sleeping{ 0 };
+    std::atomic< std::uint64_t >            steal_attempts{ 0 };
+    std::atomic< std::uint64_t >            steals{ 0 };
+    std::atomic< std::uint64_t >            suspends{ 0 };
+    std::atomic< std::int64_t >             suspended_ns{ 0 };
+
+private:
+    char                                    pad2_[cacheline_length];
+
+public:
+    // incremented by other threads
+    std::atomic< std::uint64_t >            remote_wakeups{ 0 };
+
+private:
+    char                                    pad3_[cacheline_length];
+
+public:
+    void picked() noexcept {
+        add_( context_switches, std::uint64_t{ 1 });
+        add_( ready, std::int64_t{ -1 });
+    }
+
+    void woken() noexcept {
+        add_( wakeups, std::uint64_t{ 1 });
+        add_( ready, std::int64_t{ 1 });
+    }
+
+    void remote_woken() noexcept {
+        remote_wakeups.fetch_add( 1, std::memory_order_relaxed);
+    }
+
+    void slept( std::int64_t n) noexcept {
+        add_( sleeping, n);
+    }
+
+    void stole( std::uint64_t n) noexcept {
+        add_( steal_attempts, std::uint64_t{ 1 });
+        add_( steals, n);
+    }
+
+    void suspended( std::chrono::steady_clock::duration d) noexcept {
+        add_( suspends, std::uint64_t{ 1 });
+        add_( suspended_ns, static_cast< std::int64_t >(
+                    std::chrono::duration_cast< std::chrono::nanoseconds >( d).count() ) );
+    }
+
+    scheduler_statistics snapshot() const noexcept {
+        scheduler_statistics stats;
+        stats.context_switches = context_switches.load( std::memory_order_relaxed);
+        stats.wakeups = wakeups.load( std::memory_order_relaxed);
+        stats.remote_wakeups = remote_wakeups.load( std::memory_order_relaxed);
+        stats.ready = ready.load( std::memory_order_relaxed);
+        stats.sleeping = sleeping.load( std::memory_order_relaxed);
+        stats.steal_attempts = steal_attempts.load( std::memory_order_relaxed);
+        stats.steals = steals.load( std::memory_order_relaxed);
+        stats.suspends = suspends.load( std::memory_order_relaxed);
+        stats.suspended = std::chrono::nanoseconds{ suspended_ns.load( std::memory_order_relaxed) };
+        return stats;
+    }
+};
+
+}}}
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic pop
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_SCHEDULER_COUNTERS_H
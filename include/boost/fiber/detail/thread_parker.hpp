@@ -0,0 +1,140 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_THREAD_PARKER_H
+#define BOOST_FIBERS_DETAIL_THREAD_PARKER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+# include <boost/fiber/detail/futex.hpp>
+#else
+# include <condition_variable>
+# include <mutex>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// parks the thread running a scheduler until it gets notified
+// (algorithm::suspend_until() / algorithm::notify())
+//
+// the state word is
+//   notified: a notification is pending, next park() returns immediately
+//   empty:    the thread is running, no notification pending
+//   parked:   the thread is (about to be) blocked in the kernel
+//
+// unpark() of a running thread that has already been notified costs
+// one load, unpark() of a parked thread exactly one futex wake
+class thread_parker {
+private:
+    static constexpr std::int32_t   notified = 1;
+    static constexpr std::int32_t   empty = 0;
+    static constexpr std::int32_t   parked = -1;
+
+    std::atomic< std::int32_t >     value_{ empty };
+#if ! defined(BOOST_FIBERS_HAS_FUTEX)
+    std::mutex                      mtx_{};
+    std::condition_variable         cnd_{};
+#endif
+
+public:
+    thread_parker() = default;
+
+    thread_parker( thread_parker const&) = delete;
+    thread_parker & operator=( thread_parker const&) = delete;
+
+    void park() noexcept {
+        // notified -> empty: consume pending notification
+        // empty -> parked:   block
+        if ( notified == value_.fetch_sub( 1, std::memory_order_seq_cst) ) {
+            return;
+        }
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+        for (;;) {
+            futex_wait( & value_, parked);
+            std::int32_t expected = notified;
+            if ( value_.compare_exchange_strong( expected, empty, std::memory_order_acquire) ) {
+                return;
+            }
+            // spurious wakeup
+        }
+#else
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait( lk, [this](){ return notified == value_.load( std::memory_order_relaxed); });
+        value_.store( empty, std::memory_order_relaxed);
+#endif
+    }
+
+    // returns true if a notification was consumed
+    bool park_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+            park();
+            return true;
+        }
+        if ( notified == value_.fetch_sub( 1, std::memory_order_seq_cst) ) {
+            return true;
+        }
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if ( now < time_point) {
+            futex_wait( & value_, parked, time_point - now);
+        }
+#else
+        {
+            std::unique_lock< std::mutex > lk{ mtx_ };
+            cnd_.wait_until( lk, time_point, [this](){ return notified == value_.load( std::memory_order_relaxed); });
+        }
+#endif
+        // timeout, spurious wakeup or notified: consume a pending notification
+        // a spurious return is harmless, the scheduler re-checks its queues
+        return notified == value_.exchange( empty, std::memory_order_acquire);
+    }
+
+    // consumes a pending notification without blocking
+    bool try_consume() noexcept {
+        std::int32_t expected = notified;
+        return notified == value_.load( std::memory_order_relaxed) &&
+               value_.compare_exchange_strong( expected, empty, std::memory_order_acquire);
+    }
+
+    void unpark() noexcept {
+        // seq_cst: must not be reordered before the preceding publication
+        // of the context (remote ready-queue), otherwise the wakeup might get lost
+        if ( notified == value_.load( std::memory_order_seq_cst) ) {
+            return;
+        }
+        if ( parked == value_.exchange( notified, std::memory_order_seq_cst) ) {
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+            futex_wake( & value_);
+#else
+            // synchronize with the predicate check of the parked thread
+            mtx_.lock();
+            mtx_.unlock();
+            cnd_.notify_one();
+#endif
+        }
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_THREAD_PARKER_H
@@ -0,0 +1,108 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_TRACE_H
+#define BOOST_FIBERS_DETAIL_TRACE_H
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+# include <atomic>
+# include <chrono>
+# include <cstddef>
+# include <cstdint>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+
+namespace boost {
+namespace fibers {
+
+class context;
+
+namespace detail {
+
+enum class trace_kind : std::uint32_t {
+    resume = 0,
+    suspend,
+    terminate,
+    steal,
+    remote_wake,
+    // the owning thread has terminated, the buffer is reused
+    exit
+};
+
+// flags of trace_kind::resume
+enum : std::uint32_t {
+    trace_main_context = 1,
+    trace_dispatcher_context = 2
+};
+
+struct trace_record {
+    std::int64_t        ts;
+    void        const*  ctx;
+    std::uint32_t       arg;
+    trace_kind          kind;
+};
+
+// ring buffer of the events of one thread
+// written only by the owning thread (records are overwritten if
+// the buffer is full), read by trace::dump_chrome_json()
+// a buffer is handed over to a thread started after the owning thread
+// has terminated, which continues to write at head
+class trace_buffer {
+public:
+    static constexpr std::size_t    capacity = BOOST_FIBERS_TRACE_BUFFER_SIZE;
+
+    static_assert( 0 == ( capacity & ( capacity - 1) ), "BOOST_FIBERS_TRACE_BUFFER_SIZE must be a power of two");
+
+    std::uint32_t                   tid;
+    std::atomic< std::uint64_t >    head{ 0 };
+    trace_record                    records[capacity];
+
+    explicit trace_buffer( std::uint32_t tid_) noexcept :
+        tid{ tid_ } {
+    }
+
+    void push( trace_kind kind, void const* ctx, std::uint32_t arg) noexcept {
+        std::uint64_t h = head.load( std::memory_order_relaxed);
+        trace_record & r = records[h & ( capacity - 1)];
+        r.ts = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now().time_since_epoch() ).count();
+        r.ctx = ctx;
+        r.arg = arg;
+        r.kind = kind;
+        head.store( h + 1, std::memory_order_release);
+    }
+};
+
+// records an event into the buffer of the calling thread, the buffer
+// is taken from the registry on first use and returned at thread exit
+// events recorded after the buffer has been returned are discarded
+BOOST_FIBERS_DECL void trace( trace_kind, void const*, std::uint32_t) noexcept;
+
+}}}
+
+# define BOOST_FIBERS_TRACE( kind, ctx, arg) \
+    ::boost::fibers::detail::trace( ::boost::fibers::detail::trace_kind::kind, ctx, static_cast< std::uint32_t >( arg) )
+
+#else
+
+# define BOOST_FIBERS_TRACE( kind, ctx, arg) ((void)0)
+
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_TRACE_H
@@ -7,6 +7,8 @@
 #ifndef BOOST_FIBERS_FIXEDSIZE_STACK_H
 #define BOOST_FIBERS_FIXEDSIZE_STACK_H
 
+#include <cstddef>
+
 #include <boost/config.hpp>
 #include <boost/context/fixedsize_stack.hpp>
 
@@ -19,9 +21,25 @@
 namespace boost {
 namespace fibers {
 
-using fixedsize_stack = boost::context::fixedsize_stack;
+// remembers the requested stack size so that
+// stacks can be recycled by the stack cache
+class fixedsize_stack : public boost::context::fixedsize_stack {
+private:
+    std::size_t     size_;
+
+public:
+    fixedsize_stack( std::size_t size = traits_type::default_size() ) noexcept :
+        boost::context::fixedsize_stack( size),
+        size_( size) {
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+};
+
 #if !defined(BOOST_USE_SEGMENTED_STACKS)
-using   default_stack = boost::context::default_stack;
+using   default_stack = fixedsize_stack;
 #endif
 
 }}
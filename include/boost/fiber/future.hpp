@@ -8,3 +8,5 @@
 #include <boost/fiber/future/future.hpp>
 #include <boost/fiber/future/packaged_task.hpp>
 #include <boost/fiber/future/promise.hpp>
+#include <boost/fiber/future/when_all.hpp>
+#include <boost/fiber/future/when_any.hpp>
@@ -13,18 +13,20 @@
 #include <cstddef>
 #include <exception>
 #include <memory>
-#include <mutex>
 #include <type_traits>
+#include <utility>
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/intrusive_ptr.hpp>
 
+#include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/future/future_status.hpp>
-#include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/exceptions.hpp>
-#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/waker.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -34,68 +36,120 @@ namespace boost {
 namespace fibers {
 namespace detail {
 
+// attached to a shared state by future<>::then(), when_all() and when_any();
+// run() is invoked exactly once by the fiber that makes the state ready
+// (or by the attaching fiber if the state is already ready)
+struct continuation {
+    continuation    *   next{ nullptr };
+
+    virtual ~continuation() = default;
+
+    virtual void run() noexcept = 0;
+};
+
 class shared_state_base {
 private:
-    std::atomic< std::size_t >  use_count_{ 0 };
-    mutable condition_variable  waiters_{};
+    // bits of state_
+    // set_value()/set_exception() has been called
+    static constexpr unsigned int   satisfied_bit = 1;
+    // the value or the exception has been stored
+    static constexpr unsigned int   ready_bit = 2;
+    // at least one fiber waits in waiters_ or a continuation is attached
+    static constexpr unsigned int   waiter_bit = 4;
+
+    std::atomic< std::size_t >              use_count_{ 0 };
+    mutable std::atomic< unsigned int >     state_{ 0 };
+    // only taken if a fiber has to wait
+    mutable detail::spinlock                splk_{};
+    mutable wait_queue                      waiters_{};
+    continuation                        *   continuations_{ nullptr };
+
+    // returns false if the state became ready
+    bool enlist_waiter_() const noexcept {
+        unsigned int state = state_.load( std::memory_order_acquire);
+        do {
+            if ( 0 != ( state & ready_bit) ) {
+                return false;
+            }
+        } while ( ! state_.compare_exchange_weak( state, state | waiter_bit,
+                                                  std::memory_order_acq_rel, std::memory_order_acquire) );
+        return true;
+    }
 
 protected:
-    mutable mutex       mtx_{};
-    bool                ready_{ false };
     std::exception_ptr  except_{};
 
-    void mark_ready_and_notify_( std::unique_lock< mutex > & lk) noexcept {
-        BOOST_ASSERT( lk.owns_lock() );
-        ready_ = true;
-        lk.unlock();
-        waiters_.notify_all();
+    bool is_ready_() const noexcept {
+        return 0 != ( state_.load( std::memory_order_acquire) & ready_bit);
     }
 
-    void owner_destroyed_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( ! ready_) {
-            set_exception_(
-                    std::make_exception_ptr( broken_promise() ),
-                    lk);
+    // fn stores the value; if it throws, the state can be set again
+    template< typename Fn >
+    void set_( Fn && fn) {
+        if ( BOOST_UNLIKELY( 0 != ( state_.fetch_or( satisfied_bit, std::memory_order_acquire) & satisfied_bit) ) ) {
+            throw promise_already_satisfied{};
         }
-    }
-
-    void set_exception_( std::exception_ptr except, std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( BOOST_UNLIKELY( ready_) ) {
-            throw promise_already_satisfied();
+        try {
+            fn();
+        } catch (...) {
+            state_.fetch_and( ~satisfied_bit, std::memory_order_relaxed);
+            throw;
+        }
+        // the waiters set waiter_bit while holding splk_ and release it
+        // after they have been suspended
+        if ( 0 != ( state_.fetch_or( ready_bit, std::memory_order_acq_rel) & waiter_bit) ) {
+            continuation * head = nullptr;
+            {
+                detail::spinlock_lock lk{ splk_ };
+                waiters_.notify_all();
+                std::swap( head, continuations_);
+            }
+            // restore the order of attachment
+            continuation * c = nullptr;
+            while ( nullptr != head) {
+                continuation * nxt = head->next;
+                head->next = c;
+                c = head;
+                head = nxt;
+            }
+            run_continuations_( c);
         }
-        except_ = except;
-        mark_ready_and_notify_( lk);
-    }
-
-    std::exception_ptr get_exception_ptr_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        wait_( lk);
-        return except_;
     }
 
-    void wait_( std::unique_lock< mutex > & lk) const {
-        BOOST_ASSERT( lk.owns_lock() );
-        waiters_.wait( lk, [this](){ return ready_; });
+    static void run_continuations_( continuation * c) noexcept {
+        while ( nullptr != c) {
+            continuation * nxt = c->next;
+            c->run();
+            delete c;
+            c = nxt;
+        }
     }
 
-    template< typename Rep, typename Period >
-    future_status wait_for_( std::unique_lock< mutex > & lk,
-                             std::chrono::duration< Rep, Period > const& timeout_duration) const {
-        BOOST_ASSERT( lk.owns_lock() );
-        return waiters_.wait_for( lk, timeout_duration, [this](){ return ready_; })
-                    ? future_status::ready
-                    : future_status::timeout;
+    void wait_() const {
+        while ( ! is_ready_() ) {
+            context * active_ctx = context::active();
+            detail::spinlock_lock lk{ splk_ };
+            if ( ! enlist_waiter_() ) {
+                break;
+            }
+            waiters_.suspend_and_wait( lk, active_ctx);
+        }
     }
 
-    template< typename Clock, typename Duration >
-    future_status wait_until_( std::unique_lock< mutex > & lk,
-                               std::chrono::time_point< Clock, Duration > const& timeout_time) const {
-        BOOST_ASSERT( lk.owns_lock() );
-        return waiters_.wait_until( lk, timeout_time, [this](){ return ready_; })
+    future_status wait_until_( std::chrono::steady_clock::time_point const& timeout_time) const {
+        while ( ! is_ready_() ) {
+            context * active_ctx = context::active();
+            detail::spinlock_lock lk{ splk_ };
+            if ( ! enlist_waiter_() ) {
+                break;
+            }
+            if ( ! waiters_.suspend_and_wait_until( lk, active_ctx, timeout_time) ) {
+                return is_ready_()
                     ? future_status::ready
                     : future_status::timeout;
+            }
+        }
+        return future_status::ready;
     }
 
     virtual void deallocate_future() noexcept = 0;
@@ -103,41 +157,63 @@ protected:
 public:
     shared_state_base() = default;
 
-    virtual ~shared_state_base() = default;
+    virtual ~shared_state_base() {
+        // never became ready
+        while ( nullptr != continuations_) {
+            continuation * nxt = continuations_->next;
+            delete continuations_;
+            continuations_ = nxt;
+        }
+    }
 
     shared_state_base( shared_state_base const&) = delete;
     shared_state_base & operator=( shared_state_base const&) = delete;
 
     void owner_destroyed() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        owner_destroyed_( lk);
+        if ( 0 == ( state_.load( std::memory_order_relaxed) & satisfied_bit) ) {
+            try {
+                set_exception( std::make_exception_ptr( broken_promise() ) );
+            } catch ( promise_already_satisfied const&) {
+                // set concurrently
+            }
+        }
     }
 
     void set_exception( std::exception_ptr except) {
-        std::unique_lock< mutex > lk{ mtx_ };
-        set_exception_( except, lk);
+        set_( [this,&except](){ except_ = std::move( except); });
     }
 
     std::exception_ptr get_exception_ptr() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        return get_exception_ptr_( lk);
+        wait_();
+        return except_;
+    }
+
+    // takes ownership of c; runs it at once if the state is already ready
+    void attach( continuation * c) noexcept {
+        {
+            detail::spinlock_lock lk{ splk_ };
+            if ( enlist_waiter_() ) {
+                c->next = continuations_;
+                continuations_ = c;
+                return;
+            }
+        }
+        c->next = nullptr;
+        run_continuations_( c);
     }
 
     void wait() const {
-        std::unique_lock< mutex > lk{ mtx_ };
-        wait_( lk);
+        wait_();
     }
 
     template< typename Rep, typename Period >
     future_status wait_for( std::chrono::duration< Rep, Period > const& timeout_duration) const {
-        std::unique_lock< mutex > lk{ mtx_ };
-        return wait_for_( lk, timeout_duration);
+        return wait_until_( std::chrono::steady_clock::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
     future_status wait_until( std::chrono::time_point< Clock, Duration > const& timeout_time) const {
-        std::unique_lock< mutex > lk{ mtx_ };
-        return wait_until_( lk, timeout_time);
+        return wait_until_( detail::convert( timeout_time) );
     }
 
     friend inline
@@ -159,40 +235,13 @@ class shared_state : public shared_state_base {
 private:
     typename std::aligned_storage< sizeof( R), alignof( R) >::type  storage_{};
 
-    void set_value_( R const& value, std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( BOOST_UNLIKELY( ready_) ) {
-            throw promise_already_satisfied{};
-        }
-        ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( value );
-        mark_ready_and_notify_( lk);
-    }
-
-    void set_value_( R && value, std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( BOOST_UNLIKELY( ready_) ) {
-            throw promise_already_satisfied{};
-        }
-        ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( std::move( value) );
-        mark_ready_and_notify_( lk);
-    }
-
-    R & get_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        wait_( lk);
-        if ( except_) {
-            std::rethrow_exception( except_);
-        }
-        return * reinterpret_cast< R * >( std::addressof( storage_) );
-    }
-
 public:
     typedef intrusive_ptr< shared_state >    ptr_type;
 
     shared_state() = default;
 
     virtual ~shared_state() {
-        if ( ready_ && ! except_) {
+        if ( is_ready_() && ! except_) {
             reinterpret_cast< R * >( std::addressof( storage_) )->~R();
         }
     }
@@ -201,18 +250,23 @@ public:
     shared_state & operator=( shared_state const&) = delete;
 
     void set_value( R const& value) {
-        std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( value, lk);
+        set_( [this,&value](){
+                ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( value );
+              });
     }
 
     void set_value( R && value) {
-        std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( std::move( value), lk);
+        set_( [this,&value](){
+                ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( std::move( value) );
+              });
     }
 
     R & get() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        return get_( lk);
+        wait_();
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+        return * reinterpret_cast< R * >( std::addressof( storage_) );
     }
 };
 
@@ -221,24 +275,6 @@ class shared_state< R & > : public shared_state_base {
 private:
     R   *   value_{ nullptr };
 
-    void set_value_( R & value, std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( BOOST_UNLIKELY( ready_) ) {
-            throw promise_already_satisfied();
-        }
-        value_ = std::addressof( value);
-        mark_ready_and_notify_( lk);
-    }
-
-    R & get_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        wait_( lk);
-        if ( except_) {
-            std::rethrow_exception( except_);
-        }
-        return * value_;
-    }
-
 public:
     typedef intrusive_ptr< shared_state >    ptr_type;
 
@@ -250,37 +286,20 @@ public:
     shared_state & operator=( shared_state const&) = delete;
 
     void set_value( R & value) {
-        std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( value, lk);
+        set_( [this,&value](){ value_ = std::addressof( value); });
     }
 
     R & get() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        return get_( lk);
-    }
-};
-
-template<>
-class shared_state< void > : public shared_state_base {
-private:
-    inline
-    void set_value_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        if ( BOOST_UNLIKELY( ready_) ) {
-            throw promise_already_satisfied();
-        }
-        mark_ready_and_notify_( lk);
-    }
-
-    inline
-    void get_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( lk.owns_lock() );
-        wait_( lk);
+        wait_();
         if ( except_) {
             std::rethrow_exception( except_);
         }
+        return * value_;
     }
+};
 
+template<>
+class shared_state< void > : public shared_state_base {
 public:
     typedef intrusive_ptr< shared_state >    ptr_type;
 
@@ -293,14 +312,15 @@ public:
 
     inline
     void set_value() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( lk);
+        set_( [](){});
     }
 
     inline
     void get() {
-        std::unique_lock< mutex > lk{ mtx_ };
-        get_( lk);
+        wait_();
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
     }
 };
 
@@ -0,0 +1,126 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_WHEN_H
+#define BOOST_FIBERS_DETAIL_WHEN_H
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/future/detail/shared_state.hpp>
+#include <boost/fiber/future/future.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// futures are moved into the sequence, shared_futures are copied
+template< typename R >
+future< R > take_future( future< R > & f) noexcept {
+    return std::move( f);
+}
+
+template< typename R >
+shared_future< R > take_future( shared_future< R > & f) {
+    return f;
+}
+
+template< std::size_t I, std::size_t N >
+struct for_each_future {
+    template< typename Tuple, typename Fn >
+    static void apply( Tuple & t, Fn & fn) {
+        fn( std::get< I >( t) );
+        for_each_future< I + 1, N >::apply( t, fn);
+    }
+};
+
+template< std::size_t N >
+struct for_each_future< N, N > {
+    template< typename Tuple, typename Fn >
+    static void apply( Tuple &, Fn &) noexcept {
+    }
+};
+
+struct state_collector {
+    std::vector< shared_state_base * >  &   states;
+
+    template< typename F >
+    void operator()( F const& f) const {
+        if ( BOOST_UNLIKELY( ! f.valid() ) ) {
+            throw future_uninitialized{};
+        }
+        states.push_back( future_access::state( f) );
+    }
+};
+
+template< typename F >
+std::vector< shared_state_base * > collect_states( std::vector< F > const& futures) {
+    std::vector< shared_state_base * > states;
+    states.reserve( futures.size() );
+    state_collector collector{ states };
+    for ( F const& f : futures) {
+        collector( f);
+    }
+    return states;
+}
+
+template< typename ... F >
+std::vector< shared_state_base * > collect_states( std::tuple< F ... > const& futures) {
+    std::vector< shared_state_base * > states;
+    states.reserve( sizeof ... ( F) );
+    state_collector collector{ states };
+    for_each_future< 0, sizeof ... ( F) >::apply( futures, collector);
+    return states;
+}
+
+// State::on_ready() is called from the fiber that made the future at
+// position index ready
+template< typename State >
+class when_continuation : public continuation {
+private:
+    std::shared_ptr< State >    state_;
+    std::size_t                 index_;
+
+public:
+    when_continuation( std::shared_ptr< State > const& state, std::size_t index) noexcept :
+        state_{ state },
+        index_{ index } {
+    }
+
+    void run() noexcept override final {
+        state_->on_ready( index_);
+    }
+};
+
+// the shared states are collected before the first continuation is attached
+// because State might hand the sequence over to its promise as soon as a
+// continuation has been run
+template< typename State >
+void attach_continuations( std::shared_ptr< State > const& state,
+                           std::vector< shared_state_base * > const& states) {
+    for ( std::size_t i = 0; i < states.size(); ++i) {
+        states[i]->attach( new when_continuation< State >{ state, i });
+    }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_WHEN_H
@@ -10,14 +10,19 @@
 #include <algorithm>
 #include <chrono>
 #include <exception>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include <boost/config.hpp>
 
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/fiber.hpp>
 #include <boost/fiber/future/detail/shared_state.hpp>
+#include <boost/fiber/future/detail/shared_state_object.hpp>
 #include <boost/fiber/future/future_status.hpp>
+#include <boost/fiber/policy.hpp>
 
 namespace boost {
 namespace fibers {
@@ -99,6 +104,11 @@ struct future_base {
 template< typename R >
 struct promise_base;
 
+struct future_access;
+
+template< typename F, typename Fn >
+struct then_result;
+
 }
 
 template< typename R >
@@ -116,6 +126,7 @@ private:
     friend class shared_future< R >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_access;
 
     explicit future( typename base_type::ptr_type const& p) noexcept :
         base_type{ p } {
@@ -140,6 +151,12 @@ public:
 
     shared_future< R > share();
 
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( Fn && fn);
+
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( launch policy, Fn && fn);
+
     R get() {
         if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
             throw future_uninitialized{};
@@ -165,6 +182,7 @@ private:
     friend class shared_future< R & >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_access;
 
     explicit future( typename base_type::ptr_type const& p) noexcept :
         base_type{ p  } {
@@ -189,6 +207,12 @@ public:
 
     shared_future< R & > share();
 
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( Fn && fn);
+
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( launch policy, Fn && fn);
+
     R & get() {
         if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
             throw future_uninitialized{};
@@ -214,6 +238,7 @@ private:
     friend class shared_future< void >;
     template< typename Signature >
     friend class packaged_task;
+    friend struct detail::future_access;
 
     explicit future( base_type::ptr_type const& p) noexcept :
         base_type{ p } {
@@ -240,6 +265,12 @@ public:
 
     shared_future< void > share();
 
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( Fn && fn);
+
+    template< typename Fn >
+    future< typename detail::then_result< future, Fn >::type > then( launch policy, Fn && fn);
+
     inline
     void get() {
         if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
@@ -263,6 +294,8 @@ class shared_future : private detail::future_base< R > {
 private:
     typedef detail::future_base< R >   base_type;
 
+    friend struct detail::future_access;
+
     explicit shared_future( typename base_type::ptr_type const& p) noexcept :
         base_type{ p } {
     }
@@ -322,6 +355,8 @@ class shared_future< R & > : private detail::future_base< R & > {
 private:
     typedef detail::future_base< R & >  base_type;
 
+    friend struct detail::future_access;
+
     explicit shared_future( typename base_type::ptr_type const& p) noexcept :
         base_type{ p } {
     }
@@ -381,6 +416,8 @@ class shared_future< void > : private detail::future_base< void > {
 private:
     typedef detail::future_base< void > base_type;
 
+    friend struct detail::future_access;
+
     explicit shared_future( base_type::ptr_type const& p) noexcept :
         base_type{ p } {
     }
@@ -470,6 +507,183 @@ future< void >::share() {
     return shared_future< void >{ std::move( * this) };
 }
 
+namespace detail {
+
+struct future_access {
+    template< typename F >
+    static shared_state_base * state( F const& f) noexcept {
+        return f.state_.get();
+    }
+
+    template< typename R >
+    static future< R > make_future( typename shared_state< R >::ptr_type const& p) noexcept {
+        return future< R >{ p };
+    }
+};
+
+template< typename F, typename Fn >
+struct then_result {
+    typedef decltype(
+        std::declval< typename std::decay< Fn >::type & >()( std::declval< F >() ) )  result_type;
+
+    typedef typename std::conditional<
+        std::is_lvalue_reference< result_type >::value,
+        result_type,
+        typename std::decay< result_type >::type
+    >::type                                                                 type;
+};
+
+template< typename R >
+struct then_setter {
+    template< typename Fn, typename F >
+    static void set( shared_state< R > * state, Fn & fn, F && f) {
+        state->set_value( fn( std::forward< F >( f) ) );
+    }
+};
+
+template<>
+struct then_setter< void > {
+    template< typename Fn, typename F >
+    static void set( shared_state< void > * state, Fn & fn, F && f) {
+        fn( std::forward< F >( f) );
+        state->set_value();
+    }
+};
+
+// invokes fn with the ready antecedent and stores the outcome
+template< typename F, typename Fn >
+class then_task {
+public:
+    typedef typename then_result< F, Fn >::type             result_type;
+    typedef typename shared_state< result_type >::ptr_type  ptr_type;
+
+private:
+    F           f_;
+    Fn          fn_;
+    ptr_type    state_;
+
+public:
+    then_task( F && f, Fn && fn, ptr_type const& state) :
+        f_{ std::move( f) },
+        fn_( std::move( fn) ),
+        state_{ state } {
+    }
+
+    then_task( then_task && other) = default;
+
+    void operator()() {
+        try {
+            then_setter< result_type >::set( state_.get(), fn_, std::move( f_) );
+        } catch (...) {
+            state_->set_exception( std::current_exception() );
+        }
+    }
+};
+
+template< typename F, typename Fn >
+class then_continuation : public continuation {
+private:
+    typedef then_task< F, Fn >  task_type;
+
+    launch                              policy_;
+    typename task_type::ptr_type        state_;
+    task_type                           task_;
+
+public:
+    then_continuation( launch policy, F && f, Fn && fn, typename task_type::ptr_type const& state) :
+        policy_{ policy },
+        state_{ state },
+        task_{ std::move( f), std::move( fn), state } {
+    }
+
+    void run() noexcept override final {
+        if ( launch::post == policy_) {
+            // runs on the scheduler of the fiber that made the antecedent ready
+            try {
+                fiber{ launch::post, std::move( task_) }.detach();
+            } catch (...) {
+                state_->set_exception( std::current_exception() );
+            }
+        } else {
+            task_();
+        }
+    }
+};
+
+template< typename F, typename Fn >
+future< typename then_result< F, Fn >::type >
+make_then( launch policy, F && f, Fn && fn) {
+    typedef typename then_result< F, Fn >::type                         result_type;
+    typedef then_continuation< F, typename std::decay< Fn >::type >     continuation_type;
+    typedef shared_state_object< result_type, std::allocator< char > >         object_type;
+    typedef std::allocator_traits< typename object_type::allocator_type >      traits_type;
+
+    typename object_type::allocator_type a{};
+    typename traits_type::pointer ptr{ traits_type::allocate( a, 1) };
+    try {
+        traits_type::construct( a, ptr, a);
+    } catch (...) {
+        traits_type::deallocate( a, ptr, 1);
+        throw;
+    }
+    typename shared_state< result_type >::ptr_type state{ ptr };
+    shared_state_base * antecedent = future_access::state( f);
+    antecedent->attach(
+        new continuation_type{ policy, std::move( f), typename std::decay< Fn >::type( std::forward< Fn >( fn) ), state });
+    return future_access::make_future< result_type >( state);
+}
+
+}
+
+template< typename R >
+template< typename Fn >
+future< typename detail::then_result< future< R >, Fn >::type >
+future< R >::then( Fn && fn) {
+    return then( launch::dispatch, std::forward< Fn >( fn) );
+}
+
+template< typename R >
+template< typename Fn >
+future< typename detail::then_result< future< R >, Fn >::type >
+future< R >::then( launch policy, Fn && fn) {
+    if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
+        throw future_uninitialized{};
+    }
+    return detail::make_then( policy, std::move( * this), std::forward< Fn >( fn) );
+}
+
+template< typename R >
+template< typename Fn >
+future< typename detail::then_result< future< R & >, Fn >::type >
+future< R & >::then( Fn && fn) {
+    return then( launch::dispatch, std::forward< Fn >( fn) );
+}
+
+template< typename R >
+template< typename Fn >
+future< typename detail::then_result< future< R & >, Fn >::type >
+future< R & >::then( launch policy, Fn && fn) {
+    if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
+        throw future_uninitialized{};
+    }
+    return detail::make_then( policy, std::move( * this), std::forward< Fn >( fn) );
+}
+
+template< typename Fn >
+future< typename detail::then_result< future< void >, Fn >::type >
+future< void >::then( Fn && fn) {
+    return then( launch::dispatch, std::forward< Fn >( fn) );
+}
+
+template< typename Fn >
+future< typename detail::then_result< future< void >, Fn >::type >
+future< void >::then( launch policy, Fn && fn) {
+    if ( BOOST_UNLIKELY( ! base_type::valid() ) ) {
+        throw future_uninitialized{};
+    }
+    return detail::make_then( policy, std::move( * this), std::forward< Fn >( fn) );
+}
+
 }}
 
 #endif
@@ -0,0 +1,97 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_WHEN_ALL_HPP
+#define BOOST_FIBERS_WHEN_ALL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/future/detail/when.hpp>
+#include <boost/fiber/future/future.hpp>
+#include <boost/fiber/future/promise.hpp>
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+template< typename Sequence >
+class when_all_state {
+private:
+    // one for each future plus one for when_all() itself
+    std::atomic< std::size_t >  count_;
+    promise< Sequence >         promise_{};
+
+public:
+    Sequence                    futures;
+
+    when_all_state( Sequence && seq, std::size_t count) :
+        count_{ count + 1 },
+        futures( std::move( seq) ) {
+    }
+
+    future< Sequence > get_future() {
+        return promise_.get_future();
+    }
+
+    void on_ready( std::size_t) noexcept {
+        if ( 1 == count_.fetch_sub( 1, std::memory_order_acq_rel) ) {
+            try {
+                promise_.set_value( std::move( futures) );
+            } catch (...) {
+                promise_.set_exception( std::current_exception() );
+            }
+        }
+    }
+};
+
+template< typename Sequence >
+future< Sequence > when_all_( Sequence && seq) {
+    std::vector< shared_state_base * > states{ collect_states( seq) };
+    std::shared_ptr< when_all_state< Sequence > > state{
+        std::make_shared< when_all_state< Sequence > >( std::move( seq), states.size() ) };
+    future< Sequence > f{ state->get_future() };
+    attach_continuations( state, states);
+    state->on_ready( states.size() );
+    return f;
+}
+
+}
+
+template< typename InputIterator >
+future<
+    std::vector<
+        typename std::iterator_traits< InputIterator >::value_type
+    >
+>
+when_all( InputIterator first, InputIterator last) {
+    std::vector< typename std::iterator_traits< InputIterator >::value_type > futures;
+    for ( ; first != last; ++first) {
+        futures.push_back( detail::take_future( * first) );
+    }
+    return detail::when_all_( std::move( futures) );
+}
+
+template< typename ... Futures >
+future< std::tuple< typename std::decay< Futures >::type ... > >
+when_all( Futures && ... futures) {
+    return detail::when_all_(
+        std::tuple< typename std::decay< Futures >::type ... >{ std::forward< Futures >( futures) ... } );
+}
+
+}}
+
+#endif // BOOST_FIBERS_WHEN_ALL_HPP
@@ -0,0 +1,111 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_WHEN_ANY_HPP
+#define BOOST_FIBERS_WHEN_ANY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/future/detail/when.hpp>
+#include <boost/fiber/future/future.hpp>
+#include <boost/fiber/future/promise.hpp>
+
+namespace boost {
+namespace fibers {
+
+template< typename Sequence >
+struct when_any_result {
+    std::size_t     index{ static_cast< std::size_t >( -1) };
+    Sequence        futures{};
+};
+
+namespace detail {
+
+template< typename Sequence >
+class when_any_state {
+private:
+    std::atomic< bool >                         done_{ false };
+    promise< when_any_result< Sequence > >      promise_{};
+
+public:
+    Sequence                                    futures;
+
+    explicit when_any_state( Sequence && seq) :
+        futures( std::move( seq) ) {
+    }
+
+    future< when_any_result< Sequence > > get_future() {
+        return promise_.get_future();
+    }
+
+    // only the first ready future completes the result
+    void on_ready( std::size_t index) noexcept {
+        if ( ! done_.exchange( true, std::memory_order_acq_rel) ) {
+            try {
+                when_any_result< Sequence > result;
+                result.index = index;
+                result.futures = std::move( futures);
+                promise_.set_value( std::move( result) );
+            } catch (...) {
+                promise_.set_exception( std::current_exception() );
+            }
+        }
+    }
+};
+
+template< typename Sequence >
+future< when_any_result< Sequence > > when_any_( Sequence && seq) {
+    std::vector< shared_state_base * > states{ collect_states( seq) };
+    std::shared_ptr< when_any_state< Sequence > > state{
+        std::make_shared< when_any_state< Sequence > >( std::move( seq) ) };
+    future< when_any_result< Sequence > > f{ state->get_future() };
+    if ( states.empty() ) {
+        state->on_ready( static_cast< std::size_t >( -1) );
+    } else {
+        attach_continuations( state, states);
+    }
+    return f;
+}
+
+}
+
+template< typename InputIterator >
+future<
+    when_any_result<
+        std::vector<
+            typename std::iterator_traits< InputIterator >::value_type
+        >
+    >
+>
+when_any( InputIterator first, InputIterator last) {
+    std::vector< typename std::iterator_traits< InputIterator >::value_type > futures;
+    for ( ; first != last; ++first) {
+        futures.push_back( detail::take_future( * first) );
+    }
+    return detail::when_any_( std::move( futures) );
+}
+
+template< typename ... Futures >
+future< when_any_result< std::tuple< typename std::decay< Futures >::type ... > > >
+when_any( Futures && ... futures) {
+    return detail::when_any_(
+        std::tuple< typename std::decay< Futures >::type ... >{ std::forward< Futures >( futures) ... } );
+}
+
+}}
+
+#endif // BOOST_FIBERS_WHEN_ANY_HPP
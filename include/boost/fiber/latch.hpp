@@ -0,0 +1,83 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_LATCH_H
+#define BOOST_FIBERS_LATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL latch {
+private:
+    // the counter is kept in the upper bits of the state word
+    static constexpr std::ptrdiff_t waiters_bit = 1;
+    static constexpr std::ptrdiff_t count_unit = 2;
+
+    // wait() sets waiters_bit
+    mutable std::atomic< std::ptrdiff_t >   state_;
+    mutable detail::spinlock                wait_queue_splk_{};
+    mutable wait_queue                      wait_queue_{};
+
+public:
+    static constexpr std::ptrdiff_t max() noexcept {
+        return PTRDIFF_MAX / count_unit;
+    }
+
+    explicit latch( std::ptrdiff_t expected);
+
+    ~latch() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    latch( latch const&) = delete;
+    latch & operator=( latch const&) = delete;
+
+    void count_down( std::ptrdiff_t update = 1) noexcept;
+
+    bool try_wait() const noexcept {
+        return count_unit > state_.load( std::memory_order_acquire);
+    }
+
+    void wait() const;
+
+    void arrive_and_wait( std::ptrdiff_t update = 1) {
+        count_down( update);
+        wait();
+    }
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_LATCH_H
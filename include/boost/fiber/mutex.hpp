@@ -7,6 +7,9 @@
 #ifndef BOOST_FIBERS_MUTEX_H
 #define BOOST_FIBERS_MUTEX_H
 
+#include <atomic>
+#include <cstdint>
+
 #include <boost/config.hpp>
 
 #include <boost/assert.hpp>
@@ -30,19 +33,54 @@ namespace fibers {
 
 class condition_variable;
 
+// how a fiber blocked on a mutex acquires it
+enum class mutex_policy {
+    // suspend at once; unlock() releases the mutex and resumes one waiter
+    // that competes with fibers calling lock() in the meantime
+    suspend = 1,
+    // spin for a short time before suspending; once a waiter has lost the
+    // mutex for longer than BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD, unlock()
+    // hands the ownership over to the resumed waiter
+    adaptive
+};
+
 class BOOST_FIBERS_DECL mutex {
 private:
     friend class condition_variable;
 
-    detail::spinlock            wait_queue_splk_{};
-    wait_queue                  wait_queue_{};
-    context                 *   owner_{ nullptr };
+    // the owning context and waiters_bit packed into one word; contexts
+    // are aligned, bit 0 is never part of their address
+    static constexpr std::uintptr_t waiters_bit = 1;
+
+    std::atomic< std::uintptr_t >   state_{ 0 };
+    detail::spinlock                wait_queue_splk_{};
+    wait_queue                      wait_queue_{};
+    mutex_policy                    policy_{ mutex_policy::suspend };
+    // unlock() passes the ownership to the first waiter
+    bool                            handoff_{ false };
+
+    context * owner_() const noexcept {
+        return reinterpret_cast< context * >( state_.load( std::memory_order_relaxed) & ~waiters_bit);
+    }
+
+    bool try_acquire_( context *) noexcept;
+
+    // marks the mutex contended, returns false if it has been released
+    bool enlist_waiter_() noexcept;
+
+    void release_() noexcept;
+
+    void lock_slow_( context *);
 
 public:
     mutex() = default;
 
+    explicit mutex( mutex_policy policy) noexcept :
+        policy_{ policy } {
+    }
+
     ~mutex() {
-        BOOST_ASSERT( nullptr == owner_);
+        BOOST_ASSERT( nullptr == owner_() );
         BOOST_ASSERT( wait_queue_.empty() );
     }
 
@@ -8,10 +8,11 @@
 #ifndef BOOST_FIBERS_NUMA_ALGO_WORK_STEALING_H
 #define BOOST_FIBERS_NUMA_ALGO_WORK_STEALING_H
 
-#include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -19,13 +20,18 @@
 #include <boost/intrusive_ptr.hpp>
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/algo/idle_policy.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/context_spinlock_queue.hpp>
 #include <boost/fiber/detail/context_spmc_queue.hpp>
+#include <boost/fiber/detail/idle_parker.hpp>
+#include <boost/fiber/detail/scheduler_counters.hpp>
+#include <boost/fiber/detail/thread_barrier.hpp>
 #include <boost/fiber/numa/pin_thread.hpp>
 #include <boost/fiber/numa/topology.hpp>
 #include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/statistics.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -36,10 +42,13 @@ namespace fibers {
 namespace numa {
 namespace algo {
 
+class work_stealing_pool;
+
 class BOOST_FIBERS_DECL work_stealing : public boost::fibers::algo::algorithm {
 private:
-    static std::vector< intrusive_ptr< work_stealing > >    schedulers_;
+    friend class work_stealing_pool;
 
+    work_stealing_pool                                  &   pool_;
     std::uint32_t                                           cpu_id_;
     std::vector< std::uint32_t >                            local_cpus_;
     std::vector< std::uint32_t >                            remote_cpus_;
@@ -48,19 +57,41 @@ private:
 #else
     detail::context_spinlock_queue                          rqueue_{};
 #endif
-    std::mutex                                              mtx_{};
-    std::condition_variable                                 cnd_{};
-    bool                                                    flag_{ false };
+    detail::idle_parker                                     idle_;
     bool                                                    suspend_;
+    // counters of the scheduler running this algorithm
+    std::shared_ptr< detail::scheduler_counters >           counters_;
+    // counters at the time the scheduler joined the pool
+    boost::fibers::scheduler_statistics                     baseline_;
+
+    boost::fibers::scheduler_statistics statistics_() const noexcept;
+
+    context * take_batch_( context **, std::size_t) noexcept;
+
+    bool probe_() noexcept;
 
-    static void init_( std::vector< boost::fibers::numa::node > const&,
-                       std::vector< intrusive_ptr< work_stealing > > &);
+    work_stealing( work_stealing_pool &, std::uint32_t, std::uint32_t,
+                   boost::fibers::algo::idle_policy const&, bool);
 
 public:
+    // suspend == false: an idle thread keeps looping through pick_next()
+    // suspend == true:  an idle thread parks (spins first only if
+    //                   BOOST_FIBERS_IDLE_SPIN_DURATION is non-zero)
+    work_stealing( work_stealing_pool &, std::uint32_t, std::uint32_t,
+                   bool = false);
+
+    work_stealing( work_stealing_pool &, std::uint32_t, std::uint32_t,
+                   boost::fibers::algo::idle_policy const&);
+
+    // join the process-wide default pool spanning all cpus of `topo`
     work_stealing( std::uint32_t, std::uint32_t,
                    std::vector< boost::fibers::numa::node > const&,
                    bool = false);
 
+    work_stealing( std::uint32_t, std::uint32_t,
+                   std::vector< boost::fibers::numa::node > const&,
+                   boost::fibers::algo::idle_policy const&);
+
     work_stealing( work_stealing const&) = delete;
     work_stealing( work_stealing &&) = delete;
 
@@ -75,6 +106,11 @@ public:
         return rqueue_.steal();
     }
 
+    // moves up to half of the ready context' (at most `max`) into `ctxs`
+    virtual std::size_t steal_batch( context ** ctxs, std::size_t max) noexcept {
+        return rqueue_.steal_batch( ctxs, max);
+    }
+
     virtual bool has_ready_fibers() const noexcept {
         return ! rqueue_.empty();
     }
@@ -82,6 +118,54 @@ public:
     virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
 
     virtual void notify() noexcept;
+
+    boost::fibers::algo::idle_statistics statistics() const noexcept {
+        return idle_.statistics();
+    }
+};
+
+// set of numa::algo::work_stealing schedulers stealing from each other,
+// one thread per logical cpu of the topology
+// the constructor of the schedulers blocks until all threads have joined
+// the pool must outlive the threads (or they must install another
+// scheduling algorithm before the pool gets destroyed)
+class BOOST_FIBERS_DECL work_stealing_pool {
+private:
+    friend class work_stealing;
+
+    std::vector< boost::fibers::numa::node >                topo_;
+    // indexed by cpu ID, contains a nullptr for offline cpus
+    // keeps the schedulers alive as long as other threads might steal
+    // written under mtx_ before barrier_ has been passed, thieves read
+    // it after the barrier without locking
+    std::vector< intrusive_ptr< work_stealing > >           schedulers_;
+    mutable std::mutex                                      mtx_{};
+    detail::thread_barrier                                  barrier_;
+    // number of schedulers spinning for work
+    std::atomic< std::uint32_t >                            spinning_{ 0 };
+    // number of schedulers parked
+    std::atomic< std::uint32_t >                            parked_{ 0 };
+
+    void attach_( std::uint32_t, work_stealing *);
+
+public:
+    explicit work_stealing_pool( std::vector< boost::fibers::numa::node > const& topo);
+
+    ~work_stealing_pool();
+
+    work_stealing_pool( work_stealing_pool const&) = delete;
+    work_stealing_pool & operator=( work_stealing_pool const&) = delete;
+
+    std::vector< boost::fibers::numa::node > const& topology() const noexcept {
+        return topo_;
+    }
+
+    // counters of the members (since they joined the pool)
+    // threads that have not joined yet are not included
+    std::vector< boost::fibers::scheduler_statistics > member_statistics() const;
+
+    // sum over all members
+    boost::fibers::scheduler_statistics statistics() const;
 };
 
 }}}}
@@ -16,6 +16,7 @@
 #include <boost/fiber/detail/convert.hpp>
 #include <boost/fiber/fiber.hpp>
 #include <boost/fiber/scheduler.hpp>
+#include <boost/fiber/statistics.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -75,8 +76,18 @@ bool has_ready_fibers() noexcept {
     return boost::fibers::context::active()->get_scheduler()->has_ready_fibers();
 }
 
+inline
+stack_cache & get_stack_cache() noexcept {
+    return boost::fibers::context::active()->get_scheduler()->get_stack_cache();
+}
+
+inline
+scheduler_statistics get_scheduler_statistics() noexcept {
+    return boost::fibers::context::active()->get_scheduler()->statistics();
+}
+
 template< typename SchedAlgo, typename ... Args >
-void use_scheduling_algorithm( Args && ... args) noexcept {
+void use_scheduling_algorithm( Args && ... args) {
     boost::fibers::context::active()->get_scheduler()
         ->set_algo( new SchedAlgo( std::forward< Args >( args) ... ) );
 }
@@ -7,6 +7,8 @@
 #ifndef BOOST_FIBERS_PROTECTED_FIXEDSIZE_STACK_H
 #define BOOST_FIBERS_PROTECTED_FIXEDSIZE_STACK_H
 
+#include <cstddef>
+
 #include <boost/config.hpp>
 #include <boost/context/protected_fixedsize_stack.hpp>
 
@@ -19,7 +21,22 @@
 namespace boost {
 namespace fibers {
 
-using protected_fixedsize_stack = boost::context::protected_fixedsize_stack;
+// remembers the requested stack size so that
+// stacks can be recycled by the stack cache
+class protected_fixedsize_stack : public boost::context::protected_fixedsize_stack {
+private:
+    std::size_t     size_;
+
+public:
+    protected_fixedsize_stack( std::size_t size = traits_type::default_size() ) noexcept :
+        boost::context::protected_fixedsize_stack( size),
+        size_( size) {
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+};
 
 }}
 
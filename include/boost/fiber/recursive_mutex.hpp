@@ -9,7 +9,9 @@
 #ifndef BOOST_FIBERS_RECURSIVE_MUTEX_H
 #define BOOST_FIBERS_RECURSIVE_MUTEX_H
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 
 #include <boost/config.hpp>
 
@@ -38,16 +40,32 @@ class BOOST_FIBERS_DECL recursive_mutex {
 private:
     friend class condition_variable;
 
-    detail::spinlock            wait_queue_splk_{};
-    wait_queue                  wait_queue_{};
-    context                 *   owner_{ nullptr };
-    std::size_t                 count_{ 0 };
+    // the owning context and waiters_bit packed into one word; contexts
+    // are aligned, bit 0 is never part of their address
+    static constexpr std::uintptr_t waiters_bit = 1;
+
+    std::atomic< std::uintptr_t >   state_{ 0 };
+    detail::spinlock                wait_queue_splk_{};
+    wait_queue                      wait_queue_{};
+    // only accessed by the owner
+    std::size_t                     count_{ 0 };
+
+    context * owner_() const noexcept {
+        return reinterpret_cast< context * >( state_.load( std::memory_order_relaxed) & ~waiters_bit);
+    }
+
+    bool try_acquire_( context *) noexcept;
+
+    // marks the mutex contended, returns false if it has been released
+    bool enlist_waiter_() noexcept;
+
+    void release_() noexcept;
 
 public:
     recursive_mutex() = default;
 
     ~recursive_mutex() {
-        BOOST_ASSERT( nullptr == owner_);
+        BOOST_ASSERT( nullptr == owner_() );
         BOOST_ASSERT( 0 == count_);
         BOOST_ASSERT( wait_queue_.empty() );
     }
@@ -7,6 +7,7 @@
 #define BOOST_FIBERS_FIBER_MANAGER_H
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -22,8 +23,15 @@
 #include <boost/fiber/algo/algorithm.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/context_mpsc_queue.hpp>
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+# include <boost/fiber/detail/context_timer_wheel.hpp>
+#endif
 #include <boost/fiber/detail/data.hpp>
+#include <boost/fiber/detail/scheduler_counters.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/stack_cache.hpp>
+#include <boost/fiber/statistics.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -52,6 +60,9 @@ public:
                 intrusive::constant_time_size< false >
             >                                               ready_queue_type;
 private:
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+    typedef detail::context_timer_wheel                     sleep_queue_type;
+#else
     typedef intrusive::multiset<
                 context,
                 intrusive::member_hook<
@@ -59,6 +70,7 @@ private:
                 intrusive::constant_time_size< false >,
                 intrusive::compare< timepoint_less >
             >                                               sleep_queue_type;
+#endif
     typedef intrusive::list<
                 context,
                 intrusive::member_hook<
@@ -72,19 +84,13 @@ private:
                 intrusive::linear< true >,
                 intrusive::cache_last< true >
             >                                               terminated_queue_type;
-    typedef intrusive::slist<
-                context,
-                intrusive::member_hook<
-                    context, detail::remote_ready_hook, & context::remote_ready_hook_ >,
-                intrusive::linear< true >,
-                intrusive::cache_last< true >
-            >                                               remote_ready_queue_type;
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     // remote ready-queue contains context' signaled by schedulers
     // running in other threads
-    detail::spinlock                                            remote_ready_splk_{};
-    remote_ready_queue_type                                     remote_ready_queue_{};
+    // lock-free: producers push with one atomic exchange,
+    // only the dispatcher-context pops
+    detail::context_mpsc_queue                                  remote_ready_queue_{};
 #endif
     algo::algorithm::ptr_t             algo_;
     // sleep-queue contains context' which have been called
@@ -96,12 +102,23 @@ private:
     worker_queue_type                                           worker_queue_{};
     // terminated-queue contains context' which have been terminated
     terminated_queue_type                                       terminated_queue_{};
+    // stacks of terminated fibers, reused by the next launch
+    // must be destroyed after all context' have been released
+    stack_cache                                                 stack_cache_{};
     intrusive_ptr< context >                                    dispatcher_ctx_{};
     context                                                 *   main_ctx_{ nullptr };
     bool                                                        shutdown_{ false };
+    // context woken by a handoff, resumed before the ready-queue
+    context                                                 *   handoff_ctx_{ nullptr };
+    // handoff contexts resumed in a row
+    std::size_t                                                 handoffs_{ 0 };
+    // shared with the scheduling algorithm, might outlive the scheduler
+    std::shared_ptr< detail::scheduler_counters >               counters_;
 
     void release_terminated_() noexcept;
 
+    context * pick_next_() noexcept;
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void remote_ready2ready_() noexcept;
 #endif
@@ -118,6 +135,9 @@ public:
 
     void schedule( context *) noexcept;
 
+    // ctx will be resumed next, bypassing the ready-queue
+    void schedule_handoff( context *) noexcept;
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void schedule_from_remote( context *) noexcept;
 #endif
@@ -143,6 +163,19 @@ public:
 
     void set_algo( algo::algorithm::ptr_t) noexcept;
 
+    stack_cache & get_stack_cache() noexcept {
+        return stack_cache_;
+    }
+
+    std::shared_ptr< detail::scheduler_counters > const& get_counters() const noexcept {
+        return counters_;
+    }
+
+    // might be called from any thread
+    scheduler_statistics statistics() const noexcept {
+        return counters_->snapshot();
+    }
+
     void attach_main_context( context *) noexcept;
 
     void attach_dispatcher_context( intrusive_ptr< context >) noexcept;
@@ -0,0 +1,184 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SELECT_H
+#define BOOST_FIBERS_SELECT_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/buffered_channel.hpp>
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/unbuffered_channel.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// one channel operation of a select
+// the wakers of all cases share the epoch of one waiting period,
+// so the first channel that notifies the fiber resumes it and the
+// wakers left in the other wait-queues are outdated
+class select_case {
+public:
+    waker_with_hook     hook{ waker{} };
+
+    virtual ~select_case() = default;
+
+    // completes the operation if possible without blocking,
+    // returns success or closed if the case has been selected
+    virtual channel_op_status try_() = 0;
+
+    // links hook into the wait-queue of the channel,
+    // returns true if the operation might complete now
+    virtual bool enlist_() = 0;
+
+    // unlinks hook from the wait-queue
+    virtual void delist_( bool selected) = 0;
+};
+
+BOOST_FIBERS_DECL
+channel_op_status select_cases( std::size_t &, select_case **, std::size_t,
+                                std::chrono::steady_clock::time_point const&);
+
+template< typename Channel >
+class select_push_case : public select_case {
+private:
+    using value_type = typename Channel::value_type;
+
+    Channel     &   chan_;
+    value_type      value_;
+
+public:
+    template< typename V >
+    select_push_case( Channel & chan, V && value) :
+        chan_{ chan },
+        value_( std::forward< V >( value) ) {
+    }
+
+    channel_op_status try_() override final {
+        // value_ is moved only if pushed
+        return chan_.try_push( std::move( value_) );
+    }
+
+    bool enlist_() override final {
+        return chan_.enlist_producer_( hook);
+    }
+
+    void delist_( bool selected) override final {
+        chan_.delist_producer_( hook, selected);
+    }
+};
+
+template< typename Channel >
+class select_pop_case : public select_case {
+private:
+    using value_type = typename Channel::value_type;
+
+    Channel     &   chan_;
+    value_type  &   value_;
+
+public:
+    select_pop_case( Channel & chan, value_type & value) :
+        chan_{ chan },
+        value_( value) {
+    }
+
+    channel_op_status try_() override final {
+        return chan_.try_pop( value_);
+    }
+
+    bool enlist_() override final {
+        return chan_.enlist_consumer_( hook);
+    }
+
+    void delist_( bool selected) override final {
+        chan_.delist_consumer_( hook, selected);
+    }
+};
+
+template< typename ... Cases >
+channel_op_status select_( std::size_t & index,
+                           std::chrono::steady_clock::time_point const& timeout_time,
+                           Cases && ... cases) {
+    static_assert( 0 < sizeof ... ( Cases), "select requires at least one case");
+    select_case * c[] = { std::addressof( cases) ... };
+    return select_cases( index, c, sizeof ... ( Cases), timeout_time);
+}
+
+}
+
+// a push to a buffered_channel as case of select()
+template< typename T >
+detail::select_push_case< buffered_channel< T > >
+select_push( buffered_channel< T > & chan, typename buffered_channel< T >::value_type const& value) {
+    return detail::select_push_case< buffered_channel< T > >{ chan, value };
+}
+
+template< typename T >
+detail::select_push_case< buffered_channel< T > >
+select_push( buffered_channel< T > & chan, typename buffered_channel< T >::value_type && value) {
+    return detail::select_push_case< buffered_channel< T > >{ chan, std::move( value) };
+}
+
+// a pop from a buffered_channel as case of select()
+template< typename T >
+detail::select_pop_case< buffered_channel< T > >
+select_pop( buffered_channel< T > & chan, typename buffered_channel< T >::value_type & value) {
+    return detail::select_pop_case< buffered_channel< T > >{ chan, value };
+}
+
+// a pop from an unbuffered_channel as case of select()
+template< typename T >
+detail::select_pop_case< unbuffered_channel< T > >
+select_pop( unbuffered_channel< T > & chan, typename unbuffered_channel< T >::value_type & value) {
+    return detail::select_pop_case< unbuffered_channel< T > >{ chan, value };
+}
+
+// blocks until one of the cases can complete and performs exactly this one
+// cases are tried in the order given; index is set to the selected case,
+// returns the status of its operation (success or closed)
+template< typename ... Cases >
+channel_op_status select( std::size_t & index, Cases && ... cases) {
+    return detail::select_( index, (std::chrono::steady_clock::time_point::max)(),
+                            std::forward< Cases >( cases) ... );
+}
+
+template< typename Clock, typename Duration, typename ... Cases >
+channel_op_status select_wait_until( std::size_t & index,
+                                     std::chrono::time_point< Clock, Duration > const& timeout_time,
+                                     Cases && ... cases) {
+    return detail::select_( index, detail::convert( timeout_time),
+                            std::forward< Cases >( cases) ... );
+}
+
+template< typename Rep, typename Period, typename ... Cases >
+channel_op_status select_wait_for( std::size_t & index,
+                                   std::chrono::duration< Rep, Period > const& timeout_duration,
+                                   Cases && ... cases) {
+    return detail::select_( index, std::chrono::steady_clock::now() + timeout_duration,
+                            std::forward< Cases >( cases) ... );
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SELECT_H
@@ -0,0 +1,91 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SHARED_MUTEX_H
+#define BOOST_FIBERS_SHARED_MUTEX_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL shared_mutex {
+private:
+    // the low bits of the state word are flags, the number of readers
+    // holding the mutex is counted in the upper bits
+    static constexpr std::size_t writer_bit = 1;
+    // a queued writer blocks new readers (writer preference)
+    static constexpr std::size_t writers_waiting_bit = 2;
+    static constexpr std::size_t readers_waiting_bit = 4;
+    static constexpr std::size_t reader_unit = 8;
+
+    std::atomic< std::size_t >  state_{ 0 };
+    detail::spinlock            wait_queue_splk_{};
+    wait_queue                  readers_queue_{};
+    wait_queue                  writers_queue_{};
+
+    static std::size_t readers_( std::size_t state) noexcept {
+        return state / reader_unit;
+    }
+
+    // releases all queued readers in one batch; requires wait_queue_splk_
+    // to be held and writer_bit to be owned by the caller, clears writer_bit
+    std::size_t wake_readers_() noexcept;
+
+public:
+    shared_mutex() = default;
+
+    ~shared_mutex() {
+        BOOST_ASSERT( 0 == ( state_.load( std::memory_order_relaxed) & ~readers_waiting_bit) );
+        BOOST_ASSERT( readers_queue_.empty() );
+        BOOST_ASSERT( writers_queue_.empty() );
+    }
+
+    shared_mutex( shared_mutex const&) = delete;
+    shared_mutex & operator=( shared_mutex const&) = delete;
+
+    void lock();
+
+    bool try_lock() noexcept;
+
+    void unlock() noexcept;
+
+    void lock_shared();
+
+    bool try_lock_shared() noexcept;
+
+    void unlock_shared() noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SHARED_MUTEX_H
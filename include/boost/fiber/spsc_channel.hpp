@@ -0,0 +1,431 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_FIBERS_SPSC_CHANNEL_H
+#define BOOST_FIBERS_SPSC_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/waker.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// bounded channel for exactly one producing and one consuming fiber
+// (which may run on different threads)
+// the ring is wait-free; each side keeps a cached copy of the other
+// side's index, so the shared index is read only if the ring looks
+// full (producer) or empty (consumer)
+template< typename T >
+class spsc_channel {
+public:
+    using value_type = typename std::remove_reference<T>::type;
+
+private:
+    typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+    // read-mostly
+    storage_type                *   slots_;
+    std::size_t                     capacity_;
+    std::atomic< bool >             closed_{ false };
+    char                            pad1_[cacheline_length];
+    // written by the producer
+    std::atomic< std::size_t >      pidx_{ 0 };
+    std::size_t                     cached_cidx_{ 0 };
+    char                            pad2_[cacheline_length];
+    // written by the consumer
+    std::atomic< std::size_t >      cidx_{ 0 };
+    std::size_t                     cached_pidx_{ 0 };
+    char                            pad3_[cacheline_length];
+    // slow path
+    std::atomic< bool >             producer_waiting_{ false };
+    std::atomic< bool >             consumer_waiting_{ false };
+    mutable detail::spinlock        splk_{};
+    wait_queue                      waiting_producer_{};
+    wait_queue                      waiting_consumer_{};
+
+    value_type * slot_( std::size_t idx) const noexcept {
+        return reinterpret_cast< value_type * >( std::addressof( slots_[idx & ( capacity_ - 1)]) );
+    }
+
+    bool is_closed_() const noexcept {
+        return closed_.load( std::memory_order_acquire);
+    }
+
+    // the index is published seq_cst and the waiting flag of the other
+    // side is loaded afterwards; a fiber about to block sets its flag
+    // and re-checks the index (both seq_cst), so no wakeup is lost
+    template< typename V >
+    bool try_enqueue_( V && value) {
+        std::size_t pidx = pidx_.load( std::memory_order_relaxed);
+        // holds capacity - 1 values, like buffered_channel
+        if ( capacity_ - 1 <= pidx - cached_cidx_) {
+            cached_cidx_ = cidx_.load( std::memory_order_acquire);
+            if ( capacity_ - 1 <= pidx - cached_cidx_) {
+                return false;
+            }
+        }
+        // nothing has been published if the constructor throws
+        ::new ( static_cast< void * >( slot_( pidx) ) ) value_type( std::forward< V >( value) );
+        pidx_.store( pidx + 1, std::memory_order_seq_cst);
+        if ( BOOST_UNLIKELY( consumer_waiting_.load( std::memory_order_seq_cst) ) ) {
+            detail::spinlock_lock lk{ splk_ };
+            waiting_consumer_.notify_one();
+        }
+        return true;
+    }
+
+    // fn is applied to the value before it is destroyed
+    template< typename Fn >
+    bool try_dequeue_( Fn && fn) {
+        std::size_t cidx = cidx_.load( std::memory_order_relaxed);
+        if ( cidx == cached_pidx_) {
+            cached_pidx_ = pidx_.load( std::memory_order_acquire);
+            if ( cidx == cached_pidx_) {
+                return false;
+            }
+        }
+        value_type * v = slot_( cidx);
+        fn( * v);
+        v->~value_type();
+        cidx_.store( cidx + 1, std::memory_order_seq_cst);
+        if ( BOOST_UNLIKELY( producer_waiting_.load( std::memory_order_seq_cst) ) ) {
+            detail::spinlock_lock lk{ splk_ };
+            waiting_producer_.notify_one();
+        }
+        return true;
+    }
+
+    // returns false on timeout
+    bool wait_not_full_( std::chrono::steady_clock::time_point const& timeout_time) {
+        context * active_ctx = context::active();
+        bool timed_out = false;
+        detail::spinlock_lock lk{ splk_ };
+        producer_waiting_.store( true, std::memory_order_seq_cst);
+        if ( capacity_ - 1 <= pidx_.load( std::memory_order_relaxed) - cidx_.load( std::memory_order_seq_cst) &&
+             ! is_closed_() ) {
+            if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                waiting_producer_.suspend_and_wait( lk, active_ctx);
+            } else {
+                timed_out = ! waiting_producer_.suspend_and_wait_until( lk, active_ctx, timeout_time);
+            }
+        }
+        producer_waiting_.store( false, std::memory_order_relaxed);
+        return ! timed_out;
+    }
+
+    // returns false on timeout
+    bool wait_not_empty_( std::chrono::steady_clock::time_point const& timeout_time) {
+        context * active_ctx = context::active();
+        bool timed_out = false;
+        detail::spinlock_lock lk{ splk_ };
+        consumer_waiting_.store( true, std::memory_order_seq_cst);
+        if ( cidx_.load( std::memory_order_relaxed) == pidx_.load( std::memory_order_seq_cst) &&
+             ! is_closed_() ) {
+            if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                waiting_consumer_.suspend_and_wait( lk, active_ctx);
+            } else {
+                timed_out = ! waiting_consumer_.suspend_and_wait_until( lk, active_ctx, timeout_time);
+            }
+        }
+        consumer_waiting_.store( false, std::memory_order_relaxed);
+        return ! timed_out;
+    }
+
+    template< typename V >
+    channel_op_status push_( V && value, std::chrono::steady_clock::time_point const& timeout_time) {
+        for (;;) {
+            if ( BOOST_UNLIKELY( is_closed_() ) ) {
+                return channel_op_status::closed;
+            }
+            if ( try_enqueue_( std::forward< V >( value) ) ) {
+                return channel_op_status::success;
+            }
+            if ( ! wait_not_full_( timeout_time) ) {
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+    template< typename Fn >
+    channel_op_status pop_( Fn && fn, std::chrono::steady_clock::time_point const& timeout_time) {
+        for (;;) {
+            if ( try_dequeue_( fn) ) {
+                return channel_op_status::success;
+            }
+            if ( BOOST_UNLIKELY( is_closed_() ) ) {
+                // values pushed before close() are still delivered
+                return try_dequeue_( fn)
+                    ? channel_op_status::success
+                    : channel_op_status::closed;
+            }
+            if ( ! wait_not_empty_( timeout_time) ) {
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+public:
+    explicit spsc_channel( std::size_t capacity) :
+            capacity_{ capacity } {
+        if ( BOOST_UNLIKELY( 2 > capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) ) {
+            throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: buffer capacity is invalid" };
+        }
+        slots_ = new storage_type[capacity_];
+    }
+
+    ~spsc_channel() {
+        close();
+        std::size_t pidx = pidx_.load( std::memory_order_relaxed);
+        for ( std::size_t idx = cidx_.load( std::memory_order_relaxed); idx != pidx; ++idx) {
+            slot_( idx)->~value_type();
+        }
+        delete [] slots_;
+    }
+
+    spsc_channel( spsc_channel const&) = delete;
+    spsc_channel & operator=( spsc_channel const&) = delete;
+
+    bool is_closed() const noexcept {
+        return is_closed_();
+    }
+
+    void close() noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( ! closed_.load( std::memory_order_relaxed) ) {
+            closed_.store( true, std::memory_order_seq_cst);
+            waiting_producer_.notify_all();
+            waiting_consumer_.notify_all();
+        }
+    }
+
+    channel_op_status try_push( value_type const& value) {
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        return try_enqueue_( value)
+            ? channel_op_status::success
+            : channel_op_status::full;
+    }
+
+    channel_op_status try_push( value_type && value) {
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        return try_enqueue_( std::move( value) )
+            ? channel_op_status::success
+            : channel_op_status::full;
+    }
+
+    channel_op_status push( value_type const& value) {
+        return push_( value, (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    channel_op_status push( value_type && value) {
+        return push_( std::move( value), (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type const& value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until( value,
+                                std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type && value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until( std::forward< value_type >( value),
+                                std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type const& value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( value, detail::convert( timeout_time) );
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type && value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_( std::move( value), detail::convert( timeout_time) );
+    }
+
+    channel_op_status try_pop( value_type & value) {
+        if ( try_dequeue_( [&value](value_type & v){ value = std::move( v); }) ) {
+            return channel_op_status::success;
+        }
+        if ( is_closed_() ) {
+            return try_dequeue_( [&value](value_type & v){ value = std::move( v); })
+                ? channel_op_status::success
+                : channel_op_status::closed;
+        }
+        return channel_op_status::empty;
+    }
+
+    channel_op_status pop( value_type & value) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    value_type value_pop() {
+        storage_type storage;
+        value_type * p = reinterpret_cast< value_type * >( std::addressof( storage) );
+        if ( BOOST_UNLIKELY( channel_op_status::success != pop_(
+                        [p](value_type & v){ ::new ( static_cast< void * >( p) ) value_type( std::move( v) ); },
+                        (std::chrono::steady_clock::time_point::max)() ) ) ) {
+            throw fiber_error{
+                std::make_error_code( std::errc::operation_not_permitted),
+                "boost fiber: channel is closed" };
+        }
+        value_type value{ std::move( * p) };
+        p->~value_type();
+        return value;
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status pop_wait_for( value_type & value,
+                                    std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return pop_wait_until( value,
+                               std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status pop_wait_until( value_type & value,
+                                      std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     detail::convert( timeout_time) );
+    }
+
+    class iterator {
+    private:
+        spsc_channel    *   chan_{ nullptr };
+        storage_type        storage_;
+        bool                valid_{ false };
+
+        value_type * value_() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+
+        void destroy_() noexcept {
+            if ( valid_) {
+                value_()->~value_type();
+                valid_ = false;
+            }
+        }
+
+        void increment_() {
+            BOOST_ASSERT( nullptr != chan_);
+            destroy_();
+            if ( channel_op_status::success == chan_->pop_(
+                        [this](value_type & v){ ::new ( static_cast< void * >( value_() ) ) value_type( std::move( v) ); },
+                        (std::chrono::steady_clock::time_point::max)() ) ) {
+                valid_ = true;
+            } else {
+                chan_ = nullptr;
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type *;
+        using reference = value_type &;
+
+        using pointer_t = pointer;
+        using reference_t = reference;
+
+        iterator() = default;
+
+        explicit iterator( spsc_channel< T > * chan) :
+            chan_{ chan } {
+            increment_();
+        }
+
+        // the current value is not copied
+        iterator( iterator const& other) noexcept :
+            chan_{ other.chan_ } {
+        }
+
+        ~iterator() {
+            destroy_();
+        }
+
+        iterator & operator=( iterator const& other) noexcept {
+            if ( BOOST_LIKELY( this != & other) ) {
+                destroy_();
+                chan_ = other.chan_;
+            }
+            return * this;
+        }
+
+        bool operator==( iterator const& other) const noexcept {
+            return other.chan_ == chan_;
+        }
+
+        bool operator!=( iterator const& other) const noexcept {
+            return other.chan_ != chan_;
+        }
+
+        iterator & operator++() {
+            increment_();
+            return * this;
+        }
+
+        const iterator operator++( int) = delete;
+
+        reference_t operator*() noexcept {
+            return * value_();
+        }
+
+        pointer_t operator->() noexcept {
+            return value_();
+        }
+    };
+
+    friend class iterator;
+};
+
+template< typename T >
+typename spsc_channel< T >::iterator
+begin( spsc_channel< T > & chan) {
+    return typename spsc_channel< T >::iterator( & chan);
+}
+
+template< typename T >
+typename spsc_channel< T >::iterator
+end( spsc_channel< T > &) {
+    return typename spsc_channel< T >::iterator();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SPSC_CHANNEL_H
@@ -0,0 +1,177 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_STACK_CACHE_H
+#define BOOST_FIBERS_STACK_CACHE_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <boost/config.hpp>
+#include <boost/context/stack_context.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/protected_fixedsize_stack.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct stack_cache_statistics {
+    // launches served from the cache
+    std::size_t     hits{ 0 };
+    // launches that had to allocate a new stack
+    std::size_t     misses{ 0 };
+    // stacks of terminated fibers kept for reuse
+    std::size_t     recycled{ 0 };
+    // stacks returned to their allocator (trimming, clear())
+    std::size_t     released{ 0 };
+    // stacks currently cached
+    std::size_t     size{ 0 };
+    // highest number of stacks cached at once
+    std::size_t     peak{ 0 };
+};
+
+// per-scheduler (per-thread) cache of stacks of terminated fibers
+// if more than the high watermark of stacks would be cached,
+// the cache is trimmed down to the low watermark
+class BOOST_FIBERS_DECL stack_cache {
+public:
+    typedef void ( * deallocate_fn)( boost::context::stack_context &);
+
+private:
+    // stored at the top of the cached stack
+    struct node {
+        boost::context::stack_context   sctx;
+        deallocate_fn                   deallocate;
+        std::size_t                     size;
+        node                        *   next;
+    };
+
+    node                    *   head_{ nullptr };
+    std::size_t                 low_watermark_;
+    std::size_t                 high_watermark_;
+    stack_cache_statistics      stats_{};
+
+    void release_( node *) noexcept;
+
+    void trim_( std::size_t) noexcept;
+
+public:
+    // the stack cache of the scheduler running in this thread
+    // nullptr if no scheduler exists (yet or anymore)
+    static stack_cache * current() noexcept;
+
+    stack_cache() noexcept;
+
+    ~stack_cache();
+
+    stack_cache( stack_cache const&) = delete;
+    stack_cache & operator=( stack_cache const&) = delete;
+
+    // a high watermark of 0 disables the cache
+    void set_watermarks( std::size_t low, std::size_t high) noexcept;
+
+    std::size_t low_watermark() const noexcept {
+        return low_watermark_;
+    }
+
+    std::size_t high_watermark() const noexcept {
+        return high_watermark_;
+    }
+
+    stack_cache_statistics statistics() const noexcept {
+        return stats_;
+    }
+
+    // return all cached stacks to their allocators
+    void clear() noexcept;
+
+    // take a stack allocated by `fn` with the requested `size`
+    bool pop( deallocate_fn fn, std::size_t size, boost::context::stack_context &) noexcept;
+
+    // keep a stack for reuse, returns false if the stack must be deallocated
+    bool push( deallocate_fn fn, std::size_t size, boost::context::stack_context const&) noexcept;
+};
+
+namespace detail {
+
+// stack allocators whose deallocate() only depends on the stack_context
+// and that report the requested stack size
+template< typename StackAlloc >
+struct is_stack_recyclable : public std::false_type {};
+
+template<>
+struct is_stack_recyclable< fixedsize_stack > : public std::true_type {};
+
+template<>
+struct is_stack_recyclable< protected_fixedsize_stack > : public std::true_type {};
+
+// takes stacks from and returns stacks to the stack cache of the
+// current thread, falls back to the wrapped allocator
+template< typename StackAlloc >
+class recycling_stack {
+private:
+    StackAlloc      salloc_;
+
+    static void deallocate_( boost::context::stack_context & sctx) {
+        StackAlloc{}.deallocate( sctx);
+    }
+
+public:
+    explicit recycling_stack( StackAlloc const& salloc) :
+        salloc_( salloc) {
+    }
+
+    boost::context::stack_context allocate() {
+        boost::context::stack_context sctx;
+        stack_cache * cache = stack_cache::current();
+        if ( nullptr != cache && cache->pop( & recycling_stack::deallocate_, salloc_.size(), sctx) ) {
+            return sctx;
+        }
+        return salloc_.allocate();
+    }
+
+    void deallocate( boost::context::stack_context & sctx) noexcept {
+        stack_cache * cache = stack_cache::current();
+        if ( nullptr == cache || ! cache->push( & recycling_stack::deallocate_, salloc_.size(), sctx) ) {
+            salloc_.deallocate( sctx);
+        }
+    }
+};
+
+template< typename StackAlloc >
+typename std::enable_if<
+    is_stack_recyclable< typename std::decay< StackAlloc >::type >::value,
+    recycling_stack< typename std::decay< StackAlloc >::type >
+>::type
+make_stack_allocator( StackAlloc && salloc) {
+    return recycling_stack< typename std::decay< StackAlloc >::type >{ salloc };
+}
+
+template< typename StackAlloc >
+typename std::enable_if<
+    ! is_stack_recyclable< typename std::decay< StackAlloc >::type >::value,
+    typename std::decay< StackAlloc >::type
+>::type
+make_stack_allocator( StackAlloc && salloc) {
+    return std::forward< StackAlloc >( salloc);
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_STACK_CACHE_H
@@ -0,0 +1,78 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_STATISTICS_H
+#define BOOST_FIBERS_STATISTICS_H
+
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// snapshot of the runtime counters of one scheduler (or the sum
+// over the schedulers of a pool)
+struct scheduler_statistics {
+    // context' resumed by the scheduler
+    std::uint64_t               context_switches{ 0 };
+    // context' made ready (including remote wakeups)
+    std::uint64_t               wakeups{ 0 };
+    // context' made ready by other threads
+    std::uint64_t               remote_wakeups{ 0 };
+    // context' made ready minus context' picked; with work-stealing
+    // only the sum over all schedulers of a pool is meaningful
+    std::int64_t                ready{ 0 };
+    // context' in the sleep-queue
+    std::int64_t                sleeping{ 0 };
+    // steal operations and context' stolen by the scheduler
+    std::uint64_t               steal_attempts{ 0 };
+    std::uint64_t               steals{ 0 };
+    // calls of algorithm::suspend_until() and time spent in it
+    std::uint64_t               suspends{ 0 };
+    std::chrono::nanoseconds    suspended{ 0 };
+
+    scheduler_statistics & operator+=( scheduler_statistics const& other) noexcept {
+        context_switches += other.context_switches;
+        wakeups += other.wakeups;
+        remote_wakeups += other.remote_wakeups;
+        ready += other.ready;
+        sleeping += other.sleeping;
+        steal_attempts += other.steal_attempts;
+        steals += other.steals;
+        suspends += other.suspends;
+        suspended += other.suspended;
+        return * this;
+    }
+
+    scheduler_statistics & operator-=( scheduler_statistics const& other) noexcept {
+        context_switches -= other.context_switches;
+        wakeups -= other.wakeups;
+        remote_wakeups -= other.remote_wakeups;
+        ready -= other.ready;
+        sleeping -= other.sleeping;
+        steal_attempts -= other.steal_attempts;
+        steals -= other.steals;
+        suspends -= other.suspends;
+        suspended -= other.suspended;
+        return * this;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_STATISTICS_H
@@ -7,7 +7,9 @@
 #ifndef BOOST_FIBERS_TIMED_MUTEX_H
 #define BOOST_FIBERS_TIMED_MUTEX_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
@@ -36,9 +38,24 @@ class BOOST_FIBERS_DECL timed_mutex {
 private:
     friend class condition_variable;
 
-    detail::spinlock            wait_queue_splk_{};
-    wait_queue                  wait_queue_{};
-    context                 *   owner_{ nullptr };
+    // the owning context and waiters_bit packed into one word; contexts
+    // are aligned, bit 0 is never part of their address
+    static constexpr std::uintptr_t waiters_bit = 1;
+
+    std::atomic< std::uintptr_t >   state_{ 0 };
+    detail::spinlock                wait_queue_splk_{};
+    wait_queue                      wait_queue_{};
+
+    context * owner_() const noexcept {
+        return reinterpret_cast< context * >( state_.load( std::memory_order_relaxed) & ~waiters_bit);
+    }
+
+    bool try_acquire_( context *) noexcept;
+
+    // marks the mutex contended, returns false if it has been released
+    bool enlist_waiter_() noexcept;
+
+    void release_() noexcept;
 
     bool try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
 
@@ -46,7 +63,7 @@ public:
     timed_mutex() = default;
 
     ~timed_mutex() {
-        BOOST_ASSERT( nullptr == owner_);
+        BOOST_ASSERT( nullptr == owner_() );
         BOOST_ASSERT( wait_queue_.empty() );
     }
 
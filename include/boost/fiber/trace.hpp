@@ -0,0 +1,44 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_TRACE_H
+#define BOOST_FIBERS_TRACE_H
+
+#include <ostream>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace trace {
+
+// true if the library has been built with BOOST_FIBERS_ENABLE_TRACE
+BOOST_FIBERS_DECL bool enabled() noexcept;
+
+// writes the events recorded by all threads in Chrome trace-event
+// JSON format (chrome://tracing, Perfetto UI)
+// the traced threads should be quiescent, events recorded
+// concurrently might be lost or torn
+BOOST_FIBERS_DECL void dump_chrome_json( std::ostream &);
+
+// discards the recorded events
+// the traced threads must be quiescent, clear() resets the
+// buffers without synchronizing with the threads writing them
+BOOST_FIBERS_DECL void clear() noexcept;
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_TRACE_H
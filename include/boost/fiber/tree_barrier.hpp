@@ -0,0 +1,79 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_TREE_BARRIER_H
+#define BOOST_FIBERS_TREE_BARRIER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// combining tree: each thread arrives at its own leaf, only the last local
+// arrival climbs to the shared inner nodes; the fiber completing a node
+// releases the fibers waiting at that node on its way back down
+class BOOST_FIBERS_DECL tree_barrier {
+private:
+    struct node {
+        char                            pad_[cacheline_length];
+        // arrivals missing in the current phase
+        std::atomic< std::size_t >      count{ 0 };
+        std::size_t                     initial{ 0 };
+        node                        *   parent{ nullptr };
+        // scheduler arriving at a leaf, claimed at its first arrival
+        std::atomic< scheduler * >      owner{ nullptr };
+        detail::spinlock                splk{};
+        // guarded by splk
+        std::size_t                     phase{ 0 };
+        wait_queue                      queue{};
+    };
+
+    std::size_t                         threads_;
+    std::unique_ptr< node[] >           nodes_;
+
+    node * leaf_( scheduler *);
+
+    bool arrive_( node *, std::size_t, context *);
+
+public:
+    explicit tree_barrier( std::size_t threads, std::size_t fibers_per_thread, std::size_t fan_in = 4);
+
+    tree_barrier( tree_barrier const&) = delete;
+    tree_barrier & operator=( tree_barrier const&) = delete;
+
+    bool wait();
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_TREE_BARRIER_H
@@ -0,0 +1,509 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_FIBERS_UNBOUNDED_CHANNEL_H
+#define BOOST_FIBERS_UNBOUNDED_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/waker.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// unbounded channel for many producing fibers and one consuming fiber
+// (which may run on different threads)
+template< typename T >
+class unbounded_channel {
+public:
+    using value_type = typename std::remove_reference<T>::type;
+
+    // called by push() with the number of values in the channel
+    using soft_limit_callback = std::function< void( std::size_t) >;
+
+private:
+    // the values are stored in a linked list of blocks; a position of
+    // the channel is `lap * ( block_size + 1) + offset`, the offset
+    // `block_size` marks a block whose successor is being installed by
+    // the producer that claimed its last slot
+    // blocks are recycled by the consumer through a freelist, so the
+    // channel does not allocate once it has grown to its working size
+    static constexpr std::size_t block_size = 32;
+    static constexpr std::size_t lap = block_size + 1;
+
+    struct slot {
+        typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+        std::atomic< bool >         ready{ false };
+        storage_type                storage;
+
+        value_type * value() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage) );
+        }
+    };
+
+    struct block {
+        // successor in the channel or in the freelist
+        std::atomic< block * >      next{ nullptr };
+        slot                        slots[block_size];
+    };
+
+    // read-mostly
+    std::atomic< bool >                                 closed_{ false };
+    std::size_t                                         soft_limit_;
+    soft_limit_callback                                 soft_limit_fn_;
+    char                                                pad1_[cacheline_length];
+    // producers
+    std::atomic< std::size_t >                          tidx_{ 0 };
+    std::atomic< block * >                              tblock_;
+    char                                                pad2_[cacheline_length];
+    // consumer
+    std::atomic< std::size_t >                          hidx_{ 0 };
+    block                                           *   hblock_;
+    char                                                pad3_[cacheline_length];
+    // pushed by the consumer (and by producers returning an unused spare),
+    // popped by the installing producer only
+    std::atomic< block * >                              free_{ nullptr };
+    std::atomic< bool >                                 consumer_waiting_{ false };
+    mutable detail::spinlock                            splk_{};
+    wait_queue                                          waiting_consumers_{};
+
+    static std::size_t position_( std::size_t idx) noexcept {
+        return ( idx / lap) * block_size + idx % lap;
+    }
+
+    std::size_t size_() const noexcept {
+        return position_( tidx_.load( std::memory_order_relaxed) ) -
+               position_( hidx_.load( std::memory_order_relaxed) );
+    }
+
+    bool is_empty_() const noexcept {
+        return hidx_.load( std::memory_order_relaxed) == tidx_.load( std::memory_order_seq_cst);
+    }
+
+    bool is_closed_() const noexcept {
+        return closed_.load( std::memory_order_acquire);
+    }
+
+    // a slot has been claimed but the value is not yet published
+    static void backoff_( std::size_t & retries) noexcept {
+#if !defined(BOOST_FIBERS_SPIN_SINGLE_CORE)
+        if ( BOOST_FIBERS_SPIN_BEFORE_YIELD > retries) {
+            ++retries;
+            cpu_relax();
+            return;
+        }
+#endif
+        context::active()->yield();
+        std::this_thread::yield();
+    }
+
+    // only one producer pops at a time (no ABA)
+    block * pop_free_() noexcept {
+        block * b = free_.load( std::memory_order_acquire);
+        while ( nullptr != b &&
+                ! free_.compare_exchange_weak( b, b->next.load( std::memory_order_relaxed),
+                                               std::memory_order_acquire, std::memory_order_acquire) ) {
+        }
+        return b;
+    }
+
+    void push_free_( block * b) noexcept {
+        block * top = free_.load( std::memory_order_relaxed);
+        do {
+            b->next.store( top, std::memory_order_relaxed);
+        } while ( ! free_.compare_exchange_weak( top, b, std::memory_order_release, std::memory_order_relaxed) );
+    }
+
+    // the index is advanced by seq_cst CAS and the waiting flag of the
+    // consumer is loaded right after it; a consumer about to block sets
+    // the flag and re-checks the index (both seq_cst)
+    // the move constructor of value_type must not throw, a claimed slot
+    // has to be published
+    void enqueue_( value_type && value) {
+        block * spare = nullptr;
+        std::size_t retries = 0;
+        for (;;) {
+            std::size_t tidx = tidx_.load( std::memory_order_acquire);
+            std::size_t offset = tidx % lap;
+            if ( BOOST_UNLIKELY( block_size == offset) ) {
+                // another producer is installing the next block
+                backoff_( retries);
+                continue;
+            }
+            if ( BOOST_UNLIKELY( block_size == offset + 1 &&
+                                 nullptr == spare &&
+                                 nullptr == free_.load( std::memory_order_acquire) ) ) {
+                // allocated before the last slot is claimed, the channel
+                // stays usable if it throws
+                spare = new block;
+            }
+            block * b = tblock_.load( std::memory_order_acquire);
+            if ( tidx_.compare_exchange_weak( tidx, tidx + 1, std::memory_order_seq_cst, std::memory_order_relaxed) ) {
+                bool waiting = consumer_waiting_.load( std::memory_order_seq_cst);
+                if ( BOOST_UNLIKELY( block_size == offset + 1) ) {
+                    // the freelist cannot have been drained since it was checked
+                    block * next = pop_free_();
+                    if ( nullptr == next) {
+                        next = spare;
+                        spare = nullptr;
+                    }
+                    next->next.store( nullptr, std::memory_order_relaxed);
+                    tblock_.store( next, std::memory_order_release);
+                    tidx_.store( tidx + 2, std::memory_order_release);
+                    b->next.store( next, std::memory_order_release);
+                }
+                if ( nullptr != spare) {
+                    push_free_( spare);
+                }
+                slot & s = b->slots[offset];
+                ::new ( static_cast< void * >( s.value() ) ) value_type( std::move( value) );
+                s.ready.store( true, std::memory_order_release);
+                if ( BOOST_UNLIKELY( waiting) ) {
+                    detail::spinlock_lock lk{ splk_ };
+                    waiting_consumers_.notify_one();
+                }
+                return;
+            }
+        }
+    }
+
+    // fn is applied to the value before it is destroyed
+    template< typename Fn >
+    bool try_dequeue_( Fn && fn) {
+        std::size_t hidx = hidx_.load( std::memory_order_relaxed);
+        std::size_t offset = hidx % lap;
+        slot & s = hblock_->slots[offset];
+        if ( ! s.ready.load( std::memory_order_acquire) ) {
+            // empty (or the value is not yet published)
+            return false;
+        }
+        fn( * s.value() );
+        s.value()->~value_type();
+        s.ready.store( false, std::memory_order_relaxed);
+        if ( BOOST_UNLIKELY( block_size == offset + 1) ) {
+            // the successor has been linked before the last value was published
+            block * b = hblock_;
+            hblock_ = b->next.load( std::memory_order_acquire);
+            BOOST_ASSERT( nullptr != hblock_);
+            hidx_.store( hidx + 2, std::memory_order_relaxed);
+            // no producer refers to b any more
+            push_free_( b);
+        } else {
+            hidx_.store( hidx + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // slow path of the consumer, returns false on timeout
+    // returns without blocking if a value is about to be published
+    bool wait_not_empty_( std::chrono::steady_clock::time_point const& timeout_time, std::size_t & retries) {
+        context * active_ctx = context::active();
+        bool timed_out = false;
+        detail::spinlock_lock lk{ splk_ };
+        consumer_waiting_.store( true, std::memory_order_seq_cst);
+        if ( is_empty_() && ! is_closed_() ) {
+            if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+                waiting_consumers_.suspend_and_wait( lk, active_ctx);
+            } else {
+                timed_out = ! waiting_consumers_.suspend_and_wait_until( lk, active_ctx, timeout_time);
+            }
+        } else {
+            lk.unlock();
+            backoff_( retries);
+        }
+        consumer_waiting_.store( false, std::memory_order_relaxed);
+        return ! timed_out;
+    }
+
+    channel_op_status push_( value_type && value) {
+        if ( BOOST_UNLIKELY( is_closed_() ) ) {
+            return channel_op_status::closed;
+        }
+        enqueue_( std::move( value) );
+        if ( BOOST_UNLIKELY( 0 != soft_limit_) ) {
+            std::size_t size = size_();
+            if ( soft_limit_ < size) {
+                soft_limit_fn_( size);
+            }
+        }
+        return channel_op_status::success;
+    }
+
+    template< typename Fn >
+    channel_op_status pop_( Fn && fn, std::chrono::steady_clock::time_point const& timeout_time) {
+        std::size_t retries = 0;
+        for (;;) {
+            if ( try_dequeue_( fn) ) {
+                return channel_op_status::success;
+            }
+            if ( BOOST_UNLIKELY( is_closed_() ) ) {
+                if ( is_empty_() ) {
+                    return channel_op_status::closed;
+                }
+                // a producer is publishing its value
+                backoff_( retries);
+            } else if ( ! wait_not_empty_( timeout_time, retries) ) {
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+public:
+    unbounded_channel() :
+        unbounded_channel{ 0, soft_limit_callback{} } {
+    }
+
+    // fn( size) is called by push() whenever the channel holds more than
+    // soft_limit values; the value has been enqueued anyway
+    unbounded_channel( std::size_t soft_limit, soft_limit_callback fn) :
+            soft_limit_{ soft_limit },
+            soft_limit_fn_( std::move( fn) ) {
+        if ( BOOST_UNLIKELY( 0 != soft_limit_ && ! soft_limit_fn_) ) {
+            throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: soft-limit callback is empty" };
+        }
+        hblock_ = new block;
+        tblock_.store( hblock_, std::memory_order_relaxed);
+    }
+
+    ~unbounded_channel() {
+        close();
+        std::size_t tidx = tidx_.load( std::memory_order_relaxed);
+        for ( std::size_t hidx = hidx_.load( std::memory_order_relaxed); hidx != tidx; ++hidx) {
+            std::size_t offset = hidx % lap;
+            if ( block_size == offset) {
+                continue;
+            }
+            slot & s = hblock_->slots[offset];
+            if ( s.ready.load( std::memory_order_relaxed) ) {
+                s.value()->~value_type();
+            }
+            if ( block_size == offset + 1) {
+                block * b = hblock_;
+                hblock_ = b->next.load( std::memory_order_relaxed);
+                delete b;
+            }
+        }
+        delete hblock_;
+        block * b = free_.load( std::memory_order_relaxed);
+        while ( nullptr != b) {
+            block * next = b->next.load( std::memory_order_relaxed);
+            delete b;
+            b = next;
+        }
+    }
+
+    unbounded_channel( unbounded_channel const&) = delete;
+    unbounded_channel & operator=( unbounded_channel const&) = delete;
+
+    bool is_closed() const noexcept {
+        return is_closed_();
+    }
+
+    void close() noexcept {
+        detail::spinlock_lock lk{ splk_ };
+        if ( ! closed_.load( std::memory_order_relaxed) ) {
+            closed_.store( true, std::memory_order_seq_cst);
+            waiting_consumers_.notify_all();
+        }
+    }
+
+    // never blocks
+    channel_op_status push( value_type const& value) {
+        // copy before a slot gets claimed
+        return push_( value_type{ value });
+    }
+
+    channel_op_status push( value_type && value) {
+        return push_( std::move( value) );
+    }
+
+    channel_op_status try_push( value_type const& value) {
+        return push_( value_type{ value });
+    }
+
+    channel_op_status try_push( value_type && value) {
+        return push_( std::move( value) );
+    }
+
+    channel_op_status try_pop( value_type & value) {
+        if ( try_dequeue_( [&value](value_type & v){ value = std::move( v); }) ) {
+            return channel_op_status::success;
+        }
+        return is_closed_() && is_empty_()
+            ? channel_op_status::closed
+            : channel_op_status::empty;
+    }
+
+    channel_op_status pop( value_type & value) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     (std::chrono::steady_clock::time_point::max)() );
+    }
+
+    value_type value_pop() {
+        typename slot::storage_type storage;
+        value_type * p = reinterpret_cast< value_type * >( std::addressof( storage) );
+        if ( BOOST_UNLIKELY( channel_op_status::success != pop_(
+                        [p](value_type & v){ ::new ( static_cast< void * >( p) ) value_type( std::move( v) ); },
+                        (std::chrono::steady_clock::time_point::max)() ) ) ) {
+            throw fiber_error{
+                std::make_error_code( std::errc::operation_not_permitted),
+                "boost fiber: channel is closed" };
+        }
+        value_type value{ std::move( * p) };
+        p->~value_type();
+        return value;
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status pop_wait_for( value_type & value,
+                                    std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return pop_wait_until( value,
+                               std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status pop_wait_until( value_type & value,
+                                      std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return pop_( [&value](value_type & v){ value = std::move( v); },
+                     detail::convert( timeout_time) );
+    }
+
+    class iterator {
+    private:
+        typedef typename slot::storage_type storage_type;
+
+        unbounded_channel   *   chan_{ nullptr };
+        storage_type            storage_;
+        bool                    valid_{ false };
+
+        value_type * value_() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+
+        void destroy_() noexcept {
+            if ( valid_) {
+                value_()->~value_type();
+                valid_ = false;
+            }
+        }
+
+        void increment_() {
+            BOOST_ASSERT( nullptr != chan_);
+            destroy_();
+            if ( channel_op_status::success == chan_->pop_(
+                        [this](value_type & v){ ::new ( static_cast< void * >( value_() ) ) value_type( std::move( v) ); },
+                        (std::chrono::steady_clock::time_point::max)() ) ) {
+                valid_ = true;
+            } else {
+                chan_ = nullptr;
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type *;
+        using reference = value_type &;
+
+        using pointer_t = pointer;
+        using reference_t = reference;
+
+        iterator() = default;
+
+        explicit iterator( unbounded_channel< T > * chan) :
+            chan_{ chan } {
+            increment_();
+        }
+
+        // the current value is not copied
+        iterator( iterator const& other) noexcept :
+            chan_{ other.chan_ } {
+        }
+
+        ~iterator() {
+            destroy_();
+        }
+
+        iterator & operator=( iterator const& other) noexcept {
+            if ( BOOST_LIKELY( this != & other) ) {
+                destroy_();
+                chan_ = other.chan_;
+            }
+            return * this;
+        }
+
+        bool operator==( iterator const& other) const noexcept {
+            return other.chan_ == chan_;
+        }
+
+        bool operator!=( iterator const& other) const noexcept {
+            return other.chan_ != chan_;
+        }
+
+        iterator & operator++() {
+            increment_();
+            return * this;
+        }
+
+        const iterator operator++( int) = delete;
+
+        reference_t operator*() noexcept {
+            return * value_();
+        }
+
+        pointer_t operator->() noexcept {
+            return value_();
+        }
+    };
+
+    friend class iterator;
+};
+
+template< typename T >
+typename unbounded_channel< T >::iterator
+begin( unbounded_channel< T > & chan) {
+    return typename unbounded_channel< T >::iterator( & chan);
+}
+
+template< typename T >
+typename unbounded_channel< T >::iterator
+end( unbounded_channel< T > &) {
+    return typename unbounded_channel< T >::iterator();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_UNBOUNDED_CHANNEL_H
@@ -33,6 +33,21 @@
 
 namespace boost {
 namespace fibers {
+namespace detail {
+
+template< typename Channel >
+class select_pop_case;
+
+}
+
+// how a fiber blocked on an unbuffered_channel gets resumed
+enum class handoff_policy {
+    // through the ready-queue of its scheduler
+    ready_queue = 1,
+    // before the ready-queue, if it runs on the same thread; the
+    // producer and the consumer switch to each other directly
+    direct
+};
 
 template< typename T >
 class unbuffered_channel {
@@ -59,6 +74,7 @@ private:
     std::atomic< slot * >       slot_{ nullptr };
     // shared cacheline
     std::atomic_bool            closed_{ false };
+    handoff_policy              policy_{ handoff_policy::ready_queue };
     mutable detail::spinlock    splk_producers_{};
     wait_queue                  waiting_producers_{};
     mutable detail::spinlock    splk_consumers_{};
@@ -69,6 +85,24 @@ private:
         return nullptr == slot_.load( std::memory_order_acquire);
     }
 
+    // resumes the producer which owns the consumed slot
+    void wake_producer_( slot * s) {
+        if ( handoff_policy::direct == policy_) {
+            s->w.handoff();
+        } else {
+            s->w.wake();
+        }
+    }
+
+    // the lock of the consumers must be held
+    void notify_consumer_() {
+        if ( handoff_policy::direct == policy_) {
+            waiting_consumers_.notify_one_handoff();
+        } else {
+            waiting_consumers_.notify_one();
+        }
+    }
+
     bool try_push_( slot * own_slot) {
         for (;;) {
             slot * s = slot_.load( std::memory_order_acquire);
@@ -94,9 +128,32 @@ private:
         }
     }
 
+    // select support
+    bool enlist_consumer_( waker_with_hook & w) {
+        detail::spinlock_lock lk{ splk_consumers_ };
+        waiting_consumers_.enqueue( w);
+        return ! is_empty_() || is_closed();
+    }
+
+    void delist_consumer_( waker_with_hook & w, bool selected) {
+        detail::spinlock_lock lk{ splk_consumers_ };
+        bool notified = ! w.is_linked();
+        waiting_consumers_.remove( w);
+        if ( notified && ! selected && ! is_empty_() ) {
+            waiting_consumers_.notify_one();
+        }
+    }
+
+    template< typename Channel >
+    friend class detail::select_pop_case;
+
 public:
     unbuffered_channel() = default;
 
+    explicit unbuffered_channel( handoff_policy policy) noexcept :
+        policy_{ policy } {
+    }
+
     ~unbuffered_channel() {
         close();
     }
@@ -135,7 +192,7 @@ public:
             s.w = active_ctx->create_waker();
             if ( try_push_( & s) ) {
                 detail::spinlock_lock lk{ splk_consumers_ };
-                waiting_consumers_.notify_one();
+                notify_consumer_();
                 // suspend till value has been consumed
                 active_ctx->suspend( lk);
                 // resumed
@@ -169,7 +226,7 @@ public:
             s.w = active_ctx->create_waker();
             if ( try_push_( & s) ) {
                 detail::spinlock_lock lk{ splk_consumers_ };
-                waiting_consumers_.notify_one();
+                notify_consumer_();
                 // suspend till value has been consumed
                 active_ctx->suspend( lk);
                 // resumed
@@ -219,7 +276,7 @@ public:
             s.w = active_ctx->create_waker();
             if ( try_push_( & s) ) {
                 detail::spinlock_lock lk{ splk_consumers_ };
-                waiting_consumers_.notify_one();
+                notify_consumer_();
                 // suspend this producer
                 if ( ! active_ctx->wait_until(timeout_time, lk, waker(s.w))) {
                     // clear slot
@@ -265,7 +322,7 @@ public:
             s.w = active_ctx->create_waker();
             if ( try_push_( & s) ) {
                 detail::spinlock_lock lk{ splk_consumers_ };
-                waiting_consumers_.notify_one();
+                notify_consumer_();
                 // suspend this producer
                 if ( ! active_ctx->wait_until(timeout_time, lk, waker(s.w))) {
                     // clear slot
@@ -308,7 +365,7 @@ public:
                 }
                 value = std::move( s->value);
                 // notify context
-                s->w.wake();
+                wake_producer_( s);
                 return channel_op_status::success;
             }
             detail::spinlock_lock lk{ splk_consumers_ };
@@ -323,6 +380,23 @@ public:
         }
     }
 
+    channel_op_status try_pop( value_type & value) {
+        slot * s = try_pop_();
+        if ( nullptr != s) {
+            {
+                detail::spinlock_lock lk{ splk_producers_ };
+                waiting_producers_.notify_one();
+            }
+            value = std::move( s->value);
+            // notify context
+            wake_producer_( s);
+            return channel_op_status::success;
+        }
+        return is_closed()
+            ? channel_op_status::closed
+            : channel_op_status::empty;
+    }
+
     value_type value_pop() {
         context * active_ctx = context::active();
         slot * s = nullptr;
@@ -335,7 +409,7 @@ public:
                 // consume value
                 value_type value = std::move( s->value);
                 // notify context
-                s->w.wake();
+                wake_producer_( s);
                 return std::move( value);
             }
             detail::spinlock_lock lk{ splk_consumers_ };
@@ -374,7 +448,7 @@ public:
                 // consume value
                 value = std::move( s->value);
                 // notify context
-                s->w.wake();
+                wake_producer_( s);
                 return channel_op_status::success;
             }
             detail::spinlock_lock lk{ splk_consumers_ };
@@ -27,6 +27,7 @@ private:
 
 public:
     friend class context;
+    friend class wait_queue;
 
     waker() = default;
 
@@ -36,6 +37,15 @@ public:
     {}
 
     bool wake() const noexcept;
+
+    // like wake(), but a context of the active scheduler is resumed
+    // before the fibers in the ready-queue
+    bool handoff() const noexcept;
+
+    // wakers of the same epoch may be linked into several wait-queues,
+    // only the first one to fire resumes the context
+    // cancel() invalidates all of them; returns false if one has fired already
+    bool cancel() const noexcept;
 };
 
 
@@ -56,6 +66,9 @@ public:
 
 public:
     detail::waker_queue_hook waker_queue_hook_{};
+    // set by a notifier that resumed the fiber, only read by the waiting
+    // fiber with the lock protecting the queue held
+    bool notified_{ false };
 };
 
 namespace detail {
@@ -74,13 +87,25 @@ private:
 
 public:
     void suspend_and_wait( detail::spinlock_lock &, context *);
+    // returns false if the fiber has not been notified before timeout_time
     bool suspend_and_wait_until( detail::spinlock_lock &,
                                  context *,
                                  std::chrono::steady_clock::time_point const&);
-    void notify_one();
-    void notify_all();
+    // returns the context of the resumed fiber, nullptr if none was waiting
+    context * notify_one();
+    void notify_one_handoff();
+    // returns the number of resumed fibers
+    std::size_t notify_all();
+
+    // link/unlink a waker without suspending (e.g. select),
+    // the lock protecting the queue must be held
+    void enqueue( waker_with_hook &);
+    void remove( waker_with_hook &);
 
     bool empty() const;
+
+    // number of linked wakers, O(n)
+    std::size_t size() const;
 };
 
 }}
@@ -0,0 +1,85 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// bulk-synchronous phases of fibers spread over several threads:
+// barrier (mutex + condition_variable) vs. tree_barrier
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+template< typename Barrier >
+duration_type measure( Barrier & b, std::uint64_t threads, std::uint64_t fibers, std::uint64_t phases) {
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > workers;
+    for ( std::uint64_t t = 0; t < threads; ++t) {
+        workers.emplace_back( [&b,fibers,phases](){
+                                  std::vector< boost::fibers::fiber > fs;
+                                  for ( std::uint64_t f = 0; f < fibers; ++f) {
+                                      fs.emplace_back( [&b,phases](){
+                                                           for ( std::uint64_t i = 0; i < phases; ++i) {
+                                                               b.wait();
+                                                           }
+                                                       });
+                                  }
+                                  for ( boost::fibers::fiber & f : fs) {
+                                      f.join();
+                                  }
+                              });
+    }
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    return clock_type::now() - start;
+}
+
+void print( char const* name, std::uint64_t threads, std::uint64_t fibers, std::uint64_t phases, duration_type duration) {
+    std::cout << threads << " thread(s) x " << fibers << " fiber(s), " << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / phases
+              << " ns per phase" << std::endl;
+}
+
+void run( std::uint64_t threads, std::uint64_t fibers, std::uint64_t phases) {
+    {
+        boost::fibers::barrier b( threads * fibers);
+        // warm up
+        measure( b, threads, fibers, phases / 10 + 1);
+        print( "barrier     ", threads, fibers, phases, measure( b, threads, fibers, phases) );
+    }
+    {
+        boost::fibers::tree_barrier b( threads, fibers);
+        print( "tree_barrier", threads, fibers, phases, measure( b, threads, fibers, phases) );
+    }
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t phases{ 10000 };
+        if ( 1 < argc) {
+            phases = std::stoull( argv[1]);
+        }
+        run( 1, 16, phases);
+        run( 4, 4, phases);
+        run( 16, 4, phases);
+        run( 64, 4, phases / 10 + 1);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
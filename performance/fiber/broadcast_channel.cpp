@@ -0,0 +1,129 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// one publisher, N subscribers (fibers of one thread):
+// one buffered_channel per subscriber vs. one broadcast_channel
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 1024;
+constexpr std::size_t subscribers = 8;
+
+// a message with a heap allocated payload, like the pub/sub example
+using message_type = std::string;
+
+message_type make_message( std::uint64_t i) {
+    return message_type( 64, static_cast< char >( 'a' + i % 26) );
+}
+
+duration_type measure_buffered( std::uint64_t count) {
+    using channel_type = boost::fibers::buffered_channel< message_type >;
+    std::vector< std::unique_ptr< channel_type > > channels;
+    std::vector< boost::fibers::fiber > fibers;
+    std::uint64_t received = 0;
+    for ( std::size_t i = 0; i < subscribers; ++i) {
+        channels.emplace_back( new channel_type{ capacity });
+    }
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < subscribers; ++i) {
+        channel_type & chan = * channels[i];
+        fibers.emplace_back( [&chan,&received](){
+                                 message_type msg;
+                                 while ( boost::fibers::channel_op_status::success == chan.pop( msg) ) {
+                                     received += msg.size();
+                                 }
+                             });
+    }
+    for ( std::uint64_t i = 0; i < count; ++i) {
+        message_type msg = make_message( i);
+        for ( auto & chan : channels) {
+            chan->push( msg);
+        }
+    }
+    for ( auto & chan : channels) {
+        chan->close();
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( 64 * subscribers * count != received) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+duration_type measure_broadcast( std::uint64_t count) {
+    using channel_type = boost::fibers::broadcast_channel< message_type >;
+    channel_type chan{ capacity };
+    std::vector< std::unique_ptr< channel_type::subscriber > > subs;
+    std::vector< boost::fibers::fiber > fibers;
+    std::uint64_t received = 0;
+    for ( std::size_t i = 0; i < subscribers; ++i) {
+        subs.emplace_back( new channel_type::subscriber{ chan });
+    }
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < subscribers; ++i) {
+        channel_type::subscriber & sub = * subs[i];
+        fibers.emplace_back( [&sub,&received](){
+                                 message_type msg;
+                                 while ( boost::fibers::channel_op_status::success == sub.pop( msg) ) {
+                                     received += msg.size();
+                                 }
+                             });
+    }
+    for ( std::uint64_t i = 0; i < count; ++i) {
+        chan.push( make_message( i) );
+    }
+    chan.close();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( 64 * subscribers * count != received) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+void print( char const* name, std::uint64_t count, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / count
+              << " ns per published message" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 200000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // warm up
+        measure_buffered( count / 10 + 1);
+        measure_broadcast( count / 10 + 1);
+        print( "buffered_channel per subscriber", count, measure_buffered( count) );
+        print( "broadcast_channel              ", count, measure_broadcast( count) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
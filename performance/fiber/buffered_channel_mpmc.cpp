@@ -0,0 +1,121 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// buffered_channel throughput
+// P producer threads and C consumer threads, each running a few fibers,
+// share one channel; the sweep covers P, C in { 1, 2, 4 }
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t fibers_per_thread = 4;
+
+void produce( channel_type & chan, std::uint64_t count) {
+    std::vector< boost::fibers::fiber > fibers;
+    for ( std::size_t i = 0; i < fibers_per_thread; ++i) {
+        fibers.emplace_back( [&chan,count](){
+                                for ( std::uint64_t j = 0; j < count; ++j) {
+                                    chan.push( j);
+                                }
+                            });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+}
+
+void consume( channel_type & chan, std::atomic< std::uint64_t > & received) {
+    std::vector< boost::fibers::fiber > fibers;
+    for ( std::size_t i = 0; i < fibers_per_thread; ++i) {
+        fibers.emplace_back( [&chan,&received](){
+                                std::uint64_t n = 0, value = 0;
+                                while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+                                    ++n;
+                                }
+                                received += n;
+                            });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+}
+
+duration_type measure( std::size_t producers, std::size_t consumers,
+                       std::size_t capacity, std::uint64_t messages) {
+    channel_type chan{ capacity };
+    std::atomic< std::uint64_t > received{ 0 };
+    // messages per producer fiber
+    std::uint64_t count = messages / ( producers * fibers_per_thread);
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > consumer_threads;
+    for ( std::size_t i = 0; i < consumers; ++i) {
+        consumer_threads.emplace_back( consume, std::ref( chan), std::ref( received) );
+    }
+    std::vector< std::thread > producer_threads;
+    for ( std::size_t i = 0; i < producers; ++i) {
+        producer_threads.emplace_back( produce, std::ref( chan), count);
+    }
+    for ( std::thread & t : producer_threads) {
+        t.join();
+    }
+    chan.close();
+    for ( std::thread & t : consumer_threads) {
+        t.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( count * producers * fibers_per_thread != received) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t messages{ 1000000 };
+        std::size_t capacity{ 1024 };
+        if ( 1 < argc) {
+            messages = std::stoull( argv[1]);
+        }
+        if ( 2 < argc) {
+            capacity = std::stoul( argv[2]);
+        }
+        std::size_t counts[] = { 1, 2, 4 };
+        // warm up
+        measure( 1, 1, capacity, messages / 10 + 1);
+        std::cout << "messages: " << messages << ", capacity: " << capacity << std::endl;
+        for ( std::size_t p : counts) {
+            for ( std::size_t c : counts) {
+                duration_type duration = measure( p, c, capacity, messages);
+                double seconds = std::chrono::duration< double >( duration).count();
+                std::cout << "producers: " << p << ", consumers: " << c
+                          << ", throughput: " << std::fixed << std::setprecision( 0)
+                          << messages / seconds << " msg/s" << std::endl;
+            }
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// large records through a buffered_channel, producer and consumer are
+// fibers of the same thread
+// push/pop:         record built by the producer, copied into and out of the slot
+// reserve/borrow:   record built in the slot, read in the slot
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 64;
+
+template< std::size_t Size >
+struct record {
+    std::uint64_t   data[Size / sizeof( std::uint64_t)];
+
+    record() = default;
+
+    explicit record( std::uint64_t v) {
+        for ( std::uint64_t & d : data) {
+            d = v;
+        }
+    }
+};
+
+template< std::size_t Size >
+duration_type measure_push_pop( std::uint64_t count) {
+    using channel_type = boost::fibers::buffered_channel< record< Size > >;
+    channel_type chan{ capacity };
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    boost::fibers::fiber consumer{ [&chan,&sum](){
+                                        record< Size > r;
+                                        while ( boost::fibers::channel_op_status::success == chan.pop( r) ) {
+                                            sum += r.data[0];
+                                        }
+                                   }};
+    boost::fibers::fiber producer{ [&chan,count](){
+                                        for ( std::uint64_t i = 0; i < count; ++i) {
+                                            chan.push( record< Size >{ i });
+                                        }
+                                        chan.close();
+                                   }};
+    producer.join();
+    consumer.join();
+    duration_type duration = clock_type::now() - start;
+    if ( count * ( count - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+template< std::size_t Size >
+duration_type measure_reserve_borrow( std::uint64_t count) {
+    using channel_type = boost::fibers::buffered_channel< record< Size > >;
+    channel_type chan{ capacity };
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    boost::fibers::fiber consumer{ [&chan,&sum](){
+                                        typename channel_type::read_slot rs;
+                                        while ( boost::fibers::channel_op_status::success == chan.borrow( rs) ) {
+                                            sum += rs->data[0];
+                                            rs.release();
+                                        }
+                                   }};
+    boost::fibers::fiber producer{ [&chan,count](){
+                                        typename channel_type::write_slot ws;
+                                        for ( std::uint64_t i = 0; i < count; ++i) {
+                                            chan.reserve( ws);
+                                            ws.emplace( i);
+                                            ws.commit();
+                                        }
+                                        chan.close();
+                                   }};
+    producer.join();
+    consumer.join();
+    duration_type duration = clock_type::now() - start;
+    if ( count * ( count - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+void print( char const* name, std::size_t size, std::uint64_t count, duration_type duration) {
+    std::cout << name << ": record size: " << size << " bytes, "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / count
+              << " ns per message" << std::endl;
+}
+
+template< std::size_t Size >
+void run( std::uint64_t count) {
+    print( "push/pop      ", Size, count, measure_push_pop< Size >( count) );
+    print( "reserve/borrow", Size, count, measure_reserve_borrow< Size >( count) );
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 100000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // warm up
+        measure_push_pop< 64 >( count / 10 + 1);
+        measure_reserve_borrow< 64 >( count / 10 + 1);
+        run< 64 >( count);
+        run< 1024 >( count);
+        run< 8192 >( count);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
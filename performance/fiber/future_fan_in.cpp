@@ -0,0 +1,100 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// fan-in of many futures: one waiter fiber per future vs. when_all()
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::uint64_t width = 1000;
+
+// each future is awaited by its own fiber
+std::uint64_t fan_in_fibers( std::vector< boost::fibers::promise< std::uint64_t > > & promises) {
+    std::uint64_t sum = 0;
+    std::vector< boost::fibers::fiber > waiters;
+    waiters.reserve( width);
+    for ( auto & p : promises) {
+        waiters.emplace_back( [&sum]( boost::fibers::future< std::uint64_t > f){
+                                  sum += f.get();
+                              },
+                              p.get_future() );
+    }
+    for ( std::uint64_t i = 0; i < width; ++i) {
+        promises[i].set_value( i);
+    }
+    for ( boost::fibers::fiber & f : waiters) {
+        f.join();
+    }
+    return sum;
+}
+
+// the futures are combined by when_all()
+std::uint64_t fan_in_when_all( std::vector< boost::fibers::promise< std::uint64_t > > & promises) {
+    std::vector< boost::fibers::future< std::uint64_t > > futures;
+    futures.reserve( width);
+    for ( auto & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    boost::fibers::future< std::vector< boost::fibers::future< std::uint64_t > > > all{
+        boost::fibers::when_all( futures.begin(), futures.end() ) };
+    for ( std::uint64_t i = 0; i < width; ++i) {
+        promises[i].set_value( i);
+    }
+    std::uint64_t sum = 0;
+    for ( auto & f : all.get() ) {
+        sum += f.get();
+    }
+    return sum;
+}
+
+template< typename Fn >
+duration_type measure( std::uint64_t rounds, Fn fn) {
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t r = 0; r < rounds; ++r) {
+        std::vector< boost::fibers::promise< std::uint64_t > > promises( width);
+        if ( width * ( width - 1) / 2 != fn( promises) ) {
+            throw std::runtime_error("invalid result");
+        }
+    }
+    return clock_type::now() - start;
+}
+
+void print( char const* name, std::uint64_t rounds, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / ( rounds * width)
+              << " ns per future" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t rounds{ 1000 };
+        if ( 1 < argc) {
+            rounds = std::stoull( argv[1]);
+        }
+        // warm up
+        measure( rounds / 10 + 1, fan_in_fibers);
+        measure( rounds / 10 + 1, fan_in_when_all);
+        print( "waiter fibers", rounds, measure( rounds, fan_in_fibers) );
+        print( "when_all     ", rounds, measure( rounds, fan_in_when_all) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// short critical sections on a mutex contended by fibers running on
+// several threads: mutex_policy::suspend vs. mutex_policy::adaptive
+// reports the mean cost of lock()/unlock() and the longest wait in lock()
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+struct result {
+    duration_type   duration;
+    duration_type   max_wait;
+};
+
+result measure( boost::fibers::mutex_policy policy, std::uint64_t threads,
+                std::uint64_t fibers, std::uint64_t count) {
+    boost::fibers::mutex mtx{ policy };
+    std::uint64_t counter = 0;
+    std::atomic< duration_type::rep > max_wait{ 0 };
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > workers;
+    for ( std::uint64_t t = 0; t < threads; ++t) {
+        workers.emplace_back( [&mtx,&counter,&max_wait,fibers,count](){
+                                  std::vector< boost::fibers::fiber > fs;
+                                  for ( std::uint64_t f = 0; f < fibers; ++f) {
+                                      fs.emplace_back( [&mtx,&counter,&max_wait,count](){
+                                                           duration_type::rep longest = 0;
+                                                           for ( std::uint64_t i = 0; i < count; ++i) {
+                                                               time_point_type t0{ clock_type::now() };
+                                                               mtx.lock();
+                                                               longest = std::max( longest, ( clock_type::now() - t0).count() );
+                                                               ++counter;
+                                                               mtx.unlock();
+                                                           }
+                                                           duration_type::rep current = max_wait.load();
+                                                           while ( current < longest && ! max_wait.compare_exchange_weak( current, longest) );
+                                                       });
+                                  }
+                                  for ( boost::fibers::fiber & f : fs) {
+                                      f.join();
+                                  }
+                              });
+    }
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    if ( threads * fibers * count != counter) {
+        throw std::runtime_error("invalid result");
+    }
+    return result{ duration, duration_type{ max_wait.load() } };
+}
+
+void run( std::uint64_t threads, std::uint64_t fibers, std::uint64_t count) {
+    // warm up
+    measure( boost::fibers::mutex_policy::suspend, threads, fibers, count / 10 + 1);
+    for ( boost::fibers::mutex_policy policy : { boost::fibers::mutex_policy::suspend, boost::fibers::mutex_policy::adaptive }) {
+        result r = measure( policy, threads, fibers, count);
+        std::cout << threads << " thread(s) x " << fibers << " fiber(s), "
+                  << ( boost::fibers::mutex_policy::suspend == policy ? "suspend " : "adaptive") << ": "
+                  << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( r.duration).count() ) / ( threads * fibers * count)
+                  << " ns per lock, longest wait "
+                  << std::chrono::duration_cast< std::chrono::microseconds >( r.max_wait).count()
+                  << " us" << std::endl;
+    }
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 100000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        run( 1, 4, count);
+        run( 2, 1, count);
+        run( 4, 1, count);
+        run( 4, 4, count);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,77 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// cost of uncontended lock()/unlock() and try_lock()/unlock()
+// on the mutex types of Boost.Fiber
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+template< typename Mutex >
+duration_type measure_lock( std::uint64_t count) {
+    Mutex mtx;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < count; ++i) {
+        mtx.lock();
+        mtx.unlock();
+    }
+    return clock_type::now() - start;
+}
+
+template< typename Mutex >
+duration_type measure_try_lock( std::uint64_t count) {
+    Mutex mtx;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < count; ++i) {
+        if ( ! mtx.try_lock() ) {
+            throw std::runtime_error("try_lock() failed");
+        }
+        mtx.unlock();
+    }
+    return clock_type::now() - start;
+}
+
+void print( char const* name, std::uint64_t count, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / count
+              << " ns" << std::endl;
+}
+
+template< typename Mutex >
+void run( std::string const& name, std::uint64_t count) {
+    // warm up
+    measure_lock< Mutex >( count / 10 + 1);
+    print( ( name + "::lock()    ").c_str(), count, measure_lock< Mutex >( count) );
+    print( ( name + "::try_lock()").c_str(), count, measure_try_lock< Mutex >( count) );
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 1000000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        run< boost::fibers::mutex >( "mutex                ", count);
+        run< boost::fibers::timed_mutex >( "timed_mutex          ", count);
+        run< boost::fibers::recursive_mutex >( "recursive_mutex      ", count);
+        run< boost::fibers::recursive_timed_mutex >( "recursive_timed_mutex", count);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,77 @@
+
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// cross-thread ping-pong latency
+// one fiber on the main thread and one fiber on a second thread bounce
+// a token through two channels; the schedulers of both threads run out
+// of work after each message, so every round trip parks and wakes
+// (algorithm::suspend_until() / algorithm::notify()) each thread once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+void pong( channel_type & ping, channel_type & pong, std::uint64_t rounds) {
+    boost::fibers::fiber{ [&ping,&pong,rounds](){
+                            for ( std::uint64_t i = 0; i < rounds; ++i) {
+                                pong.push( ping.value_pop() + 1);
+                            }
+                        }}.join();
+}
+
+duration_type measure( std::uint64_t rounds) {
+    channel_type ping{ 2 }, pong{ 2 };
+    std::thread t{ ::pong, std::ref( ping), std::ref( pong), rounds };
+    duration_type duration{ duration_type::zero() };
+    boost::fibers::fiber{ [&ping,&pong,rounds,&duration](){
+                            std::uint64_t value = 0;
+                            time_point_type start{ clock_type::now() };
+                            for ( std::uint64_t i = 0; i < rounds; ++i) {
+                                ping.push( value);
+                                value = pong.value_pop();
+                            }
+                            duration = clock_type::now() - start;
+                            if ( rounds != value) {
+                                throw std::runtime_error("invalid result");
+                            }
+                        }}.join();
+    t.join();
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t rounds{ 100000 };
+        if ( 1 < argc) {
+            rounds = std::stoull( argv[1]);
+        }
+        // warm up
+        measure( rounds / 10 + 1);
+        duration_type duration = measure( rounds);
+        std::cout << "rounds: " << rounds
+                  << ", round trip: "
+                  << std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() / rounds << " ns"
+                  << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
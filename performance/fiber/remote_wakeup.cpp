@@ -0,0 +1,93 @@
+
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// measures cross-thread wakeups (scheduler::schedule_from_remote())
+// N producer threads push into channels consumed by fibers running
+// on the main thread; a tiny channel capacity forces nearly every
+// push/pop to suspend and to be resumed by the other thread
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+static constexpr std::uint64_t iterations = 100000;
+
+void producer( channel_type & c) {
+    for ( std::uint64_t i = 0; i < iterations; ++i) {
+        c.push( i);
+    }
+}
+
+void consumer( channel_type & c, std::uint64_t & sum) {
+    for ( std::uint64_t i = 0; i < iterations; ++i) {
+        sum += c.value_pop();
+    }
+}
+
+duration_type measure( std::uint32_t producer_count) {
+    std::vector< std::unique_ptr< channel_type > > channels;
+    std::vector< std::uint64_t > sums( producer_count, 0);
+    for ( std::uint32_t i = 0; i < producer_count; ++i) {
+        channels.emplace_back( new channel_type{ 2 } );
+    }
+    std::vector< boost::fibers::fiber > fibers;
+    for ( std::uint32_t i = 0; i < producer_count; ++i) {
+        fibers.emplace_back( consumer, std::ref( * channels[i]), std::ref( sums[i]) );
+    }
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < producer_count; ++i) {
+        threads.emplace_back( producer, std::ref( * channels[i]) );
+    }
+    for ( auto & f : fibers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    for ( std::uint64_t sum : sums) {
+        if ( iterations * ( iterations - 1) / 2 != sum) {
+            throw std::runtime_error("invalid result");
+        }
+    }
+    return duration;
+}
+
+int main() {
+    try {
+        std::uint32_t max_producers = (std::max)( 1u, std::thread::hardware_concurrency() - 1);
+        for ( std::uint32_t n = 1; n <= max_producers; n *= 2) {
+            duration_type duration = measure( n);
+            auto ms = std::chrono::duration_cast< std::chrono::milliseconds >( duration).count();
+            std::uint64_t items = n * iterations;
+            std::cout << "producers: " << n
+                      << ", duration: " << ms << " ms"
+                      << ", throughput: " << items * 1000 / (std::max)( decltype(ms){ 1 }, ms) << " items/s"
+                      << std::endl;
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
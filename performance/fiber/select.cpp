@@ -0,0 +1,159 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// fan-in of N channels into one consumer
+// select: the consumer waits on all N channels with select()
+// relay:  one relay fiber per channel forwards into a merged channel
+// producers and consumer run on the same thread
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 64;
+
+struct result {
+    duration_type   duration;
+    std::uint64_t   context_switches;
+};
+
+std::vector< boost::fibers::fiber > produce( std::vector< std::unique_ptr< channel_type > > & chans, std::uint64_t count) {
+    std::vector< boost::fibers::fiber > producers;
+    for ( std::unique_ptr< channel_type > & chan : chans) {
+        channel_type * c = chan.get();
+        producers.emplace_back( [c,count](){
+                                    for ( std::uint64_t i = 0; i < count; ++i) {
+                                        c->push( i);
+                                    }
+                                });
+    }
+    return producers;
+}
+
+std::size_t select_one( std::vector< std::unique_ptr< channel_type > > & c, std::uint64_t & value) {
+    namespace bf = boost::fibers;
+    std::size_t index = 0;
+    switch ( c.size() ) {
+    case 2:
+        bf::select( index, bf::select_pop( * c[0], value), bf::select_pop( * c[1], value) );
+        break;
+    case 4:
+        bf::select( index, bf::select_pop( * c[0], value), bf::select_pop( * c[1], value),
+                           bf::select_pop( * c[2], value), bf::select_pop( * c[3], value) );
+        break;
+    case 8:
+        bf::select( index, bf::select_pop( * c[0], value), bf::select_pop( * c[1], value),
+                           bf::select_pop( * c[2], value), bf::select_pop( * c[3], value),
+                           bf::select_pop( * c[4], value), bf::select_pop( * c[5], value),
+                           bf::select_pop( * c[6], value), bf::select_pop( * c[7], value) );
+        break;
+    default:
+        throw std::invalid_argument("unsupported number of channels");
+    }
+    return index;
+}
+
+result measure_select( std::size_t n, std::uint64_t count) {
+    std::vector< std::unique_ptr< channel_type > > chans;
+    for ( std::size_t i = 0; i < n; ++i) {
+        chans.emplace_back( new channel_type{ capacity });
+    }
+    std::uint64_t switches = boost::fibers::get_scheduler_statistics().context_switches;
+    time_point_type start{ clock_type::now() };
+    std::vector< boost::fibers::fiber > producers = produce( chans, count);
+    std::uint64_t sum = 0, value = 0;
+    for ( std::uint64_t i = 0; i < n * count; ++i) {
+        select_one( chans, value);
+        sum += value;
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( boost::fibers::fiber & f : producers) {
+        f.join();
+    }
+    if ( n * ( count * ( count - 1) / 2) != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return { duration, boost::fibers::get_scheduler_statistics().context_switches - switches };
+}
+
+result measure_relay( std::size_t n, std::uint64_t count) {
+    std::vector< std::unique_ptr< channel_type > > chans;
+    for ( std::size_t i = 0; i < n; ++i) {
+        chans.emplace_back( new channel_type{ capacity });
+    }
+    channel_type merged{ capacity };
+    std::uint64_t switches = boost::fibers::get_scheduler_statistics().context_switches;
+    time_point_type start{ clock_type::now() };
+    std::vector< boost::fibers::fiber > producers = produce( chans, count);
+    std::vector< boost::fibers::fiber > relays;
+    for ( std::unique_ptr< channel_type > & chan : chans) {
+        channel_type * c = chan.get();
+        relays.emplace_back( [c,&merged,count](){
+                                for ( std::uint64_t i = 0; i < count; ++i) {
+                                    merged.push( c->value_pop() );
+                                }
+                            });
+    }
+    std::uint64_t sum = 0;
+    for ( std::uint64_t i = 0; i < n * count; ++i) {
+        sum += merged.value_pop();
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( boost::fibers::fiber & f : producers) {
+        f.join();
+    }
+    for ( boost::fibers::fiber & f : relays) {
+        f.join();
+    }
+    if ( n * ( count * ( count - 1) / 2) != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return { duration, boost::fibers::get_scheduler_statistics().context_switches - switches };
+}
+
+void print( char const* name, std::size_t n, std::uint64_t count, result const& r) {
+    std::uint64_t messages = n * count;
+    std::cout << name << ": channels: " << n
+              << ", per message: "
+              << std::chrono::duration_cast< std::chrono::nanoseconds >( r.duration).count() / messages << " ns, "
+              << static_cast< double >( r.context_switches) / messages << " context switches"
+              << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 100000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // warm up
+        measure_select( 2, count / 10 + 1);
+        measure_relay( 2, count / 10 + 1);
+        for ( std::size_t n : { 2, 4, 8 }) {
+            print( "select", n, count, measure_select( n, count) );
+            print( "relay ", n, count, measure_relay( n, count) );
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
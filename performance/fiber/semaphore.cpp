@@ -0,0 +1,115 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// acquire()/release() of a counting semaphore emulated by mutex,
+// condition_variable and counter vs. counting_semaphore; uncontended
+// and with fibers on several threads competing for a few slots
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+class emulated_semaphore {
+private:
+    boost::fibers::mutex                mtx_{};
+    boost::fibers::condition_variable   cond_{};
+    std::ptrdiff_t                      count_;
+
+public:
+    explicit emulated_semaphore( std::ptrdiff_t desired) :
+        count_{ desired } {
+    }
+
+    void acquire() {
+        std::unique_lock< boost::fibers::mutex > lk{ mtx_ };
+        cond_.wait( lk, [this](){ return 0 < count_; });
+        --count_;
+    }
+
+    void release() {
+        {
+            std::unique_lock< boost::fibers::mutex > lk{ mtx_ };
+            ++count_;
+        }
+        cond_.notify_one();
+    }
+};
+
+template< typename Semaphore >
+duration_type measure( std::uint64_t threads, std::uint64_t fibers, std::uint64_t slots, std::uint64_t count) {
+    Semaphore sem{ static_cast< std::ptrdiff_t >( slots) };
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > workers;
+    for ( std::uint64_t t = 0; t < threads; ++t) {
+        workers.emplace_back( [&sem,fibers,count](){
+                                  std::vector< boost::fibers::fiber > fs;
+                                  for ( std::uint64_t f = 0; f < fibers; ++f) {
+                                      fs.emplace_back( [&sem,count](){
+                                                           for ( std::uint64_t i = 0; i < count; ++i) {
+                                                               sem.acquire();
+                                                               if ( 0 == i % 16) {
+                                                                   boost::this_fiber::yield();
+                                                               }
+                                                               sem.release();
+                                                           }
+                                                       });
+                                  }
+                                  for ( boost::fibers::fiber & f : fs) {
+                                      f.join();
+                                  }
+                              });
+    }
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    return clock_type::now() - start;
+}
+
+void print( char const* name, std::uint64_t threads, std::uint64_t fibers, std::uint64_t count, duration_type duration) {
+    std::cout << threads << " thread(s) x " << fibers << " fiber(s), " << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / ( threads * fibers * count)
+              << " ns per acquire/release" << std::endl;
+}
+
+void run( std::uint64_t threads, std::uint64_t fibers, std::uint64_t slots, std::uint64_t count) {
+    // warm up
+    measure< emulated_semaphore >( threads, fibers, slots, count / 10 + 1);
+    print( "mutex + condition_variable", threads, fibers, count,
+           measure< emulated_semaphore >( threads, fibers, slots, count) );
+    print( "counting_semaphore        ", threads, fibers, count,
+           measure< boost::fibers::counting_semaphore<> >( threads, fibers, slots, count) );
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 100000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // uncontended
+        run( 1, 1, 1, count);
+        run( 1, 8, 2, count);
+        run( 4, 4, 4, count);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// read-mostly table guarded by mutex vs. shared_mutex; fibers on several
+// threads look up the table, every 64th operation updates it
+// reports the mean cost of one operation
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::uint64_t table_size = 1024;
+constexpr std::uint64_t write_ratio = 64;
+
+struct exclusive {
+    boost::fibers::mutex    mtx{};
+
+    void lock_shared() {
+        mtx.lock();
+    }
+
+    void unlock_shared() {
+        mtx.unlock();
+    }
+
+    void lock() {
+        mtx.lock();
+    }
+
+    void unlock() {
+        mtx.unlock();
+    }
+};
+
+template< typename Mutex >
+duration_type measure( std::uint64_t threads, std::uint64_t fibers, std::uint64_t count) {
+    Mutex mtx;
+    std::map< std::uint64_t, std::uint64_t > table;
+    for ( std::uint64_t i = 0; i < table_size; ++i) {
+        table[i] = i;
+    }
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > workers;
+    for ( std::uint64_t t = 0; t < threads; ++t) {
+        workers.emplace_back( [&mtx,&table,t,fibers,count](){
+                                  std::vector< boost::fibers::fiber > fs;
+                                  for ( std::uint64_t f = 0; f < fibers; ++f) {
+                                      fs.emplace_back( [&mtx,&table,t,f,count](){
+                                                           std::uint64_t key = t * 7919 + f * 104729;
+                                                           for ( std::uint64_t i = 0; i < count; ++i) {
+                                                               key = ( key * 6364136223846793005ULL + 1442695040888963407ULL);
+                                                               std::uint64_t k = ( key >> 33) % table_size;
+                                                               if ( 0 == i % write_ratio) {
+                                                                   mtx.lock();
+                                                                   ++table[k];
+                                                                   mtx.unlock();
+                                                               } else {
+                                                                   mtx.lock_shared();
+                                                                   if ( table.find( k) == table.end() ) {
+                                                                       throw std::runtime_error("invalid table");
+                                                                   }
+                                                                   mtx.unlock_shared();
+                                                               }
+                                                           }
+                                                       });
+                                  }
+                                  for ( boost::fibers::fiber & f : fs) {
+                                      f.join();
+                                  }
+                              });
+    }
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    return clock_type::now() - start;
+}
+
+void print( char const* name, std::uint64_t threads, std::uint64_t fibers, std::uint64_t count, duration_type duration) {
+    std::cout << threads << " thread(s) x " << fibers << " fiber(s), " << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / ( threads * fibers * count)
+              << " ns per operation" << std::endl;
+}
+
+void run( std::uint64_t threads, std::uint64_t fibers, std::uint64_t count) {
+    // warm up
+    measure< exclusive >( threads, fibers, count / 10 + 1);
+    print( "mutex       ", threads, fibers, count, measure< exclusive >( threads, fibers, count) );
+    print( "shared_mutex", threads, fibers, count, measure< boost::fibers::shared_mutex >( threads, fibers, count) );
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::uint64_t count{ 100000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        run( 1, 4, count);
+        run( 2, 1, count);
+        run( 4, 1, count);
+        run( 4, 4, count);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// timeout-heavy workload for the sleep-queue of the scheduler
+// build with BOOST_FIBERS_USE_TIMER_WHEEL defined (library and benchmark)
+// to measure the timer wheel instead of the multiset
+//
+//  - sleep:   many fibers sleeping for short random durations
+//             (insert + expire)
+//  - timeout: many fibers blocked in a timed pop that is satisfied long
+//             before the deadline (insert + cancel)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using allocator_type = boost::fibers::fixedsize_stack;
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+static constexpr std::size_t rounds = 10;
+
+void sleeper( std::uint32_t seed) {
+    std::minstd_rand generator{ seed };
+    std::uniform_int_distribution< int > distribution{ 0, 10000 };
+    for ( std::size_t i = 0; i < rounds; ++i) {
+        boost::this_fiber::sleep_for( std::chrono::microseconds{ distribution( generator) } );
+    }
+}
+
+void waiter( channel_type & c, std::uint64_t & sum) {
+    std::uint64_t value = 0;
+    for ( std::size_t i = 0; i < rounds; ++i) {
+        if ( boost::fibers::channel_op_status::success != c.pop_wait_for( value, std::chrono::seconds{ 60 } ) ) {
+            throw std::runtime_error("timeout");
+        }
+        sum += value;
+    }
+}
+
+duration_type measure_sleep( allocator_type & salloc, std::size_t count) {
+    std::vector< boost::fibers::fiber > fibers;
+    fibers.reserve( count);
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < count; ++i) {
+        fibers.emplace_back( std::allocator_arg, salloc, sleeper, static_cast< std::uint32_t >( i + 1) );
+    }
+    for ( auto & f : fibers) {
+        f.join();
+    }
+    return clock_type::now() - start;
+}
+
+duration_type measure_timeout( allocator_type & salloc, std::size_t count) {
+    channel_type c{ 1024 };
+    std::uint64_t sum{ 0 };
+    std::vector< boost::fibers::fiber > fibers;
+    fibers.reserve( count);
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < count; ++i) {
+        fibers.emplace_back( std::allocator_arg, salloc, waiter, std::ref( c), std::ref( sum) );
+    }
+    for ( std::uint64_t i = 0; i < count * rounds; ++i) {
+        c.push( i);
+    }
+    for ( auto & f : fibers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    std::uint64_t n = count * rounds;
+    if ( n * ( n - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::size_t count{ 10000 };
+        if ( 1 < argc) {
+            count = std::stoul( argv[1]);
+        }
+        allocator_type salloc{ 2*allocator_type::traits_type::page_size() };
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+        std::cout << "sleep-queue: timer wheel" << std::endl;
+#else
+        std::cout << "sleep-queue: multiset" << std::endl;
+#endif
+        duration_type duration = measure_sleep( salloc, count);
+        std::cout << "sleep: fibers: " << count << ", duration: "
+                  << std::chrono::duration_cast< std::chrono::milliseconds >( duration).count() << " ms" << std::endl;
+        duration = measure_timeout( salloc, count);
+        std::cout << "timeout: fibers: " << count << ", duration: "
+                  << std::chrono::duration_cast< std::chrono::milliseconds >( duration).count() << " ms" << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
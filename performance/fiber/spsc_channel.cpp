@@ -0,0 +1,103 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// one producer, one consumer: buffered_channel vs. spsc_channel
+// same thread:  producer and consumer are fibers of one thread
+// cross thread: producer runs on its own thread
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 1024;
+
+template< typename Channel >
+std::uint64_t consume( Channel & chan) {
+    std::uint64_t sum = 0, value = 0;
+    while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+        sum += value;
+    }
+    return sum;
+}
+
+template< typename Channel >
+void produce( Channel & chan, std::uint64_t count) {
+    for ( std::uint64_t i = 0; i < count; ++i) {
+        chan.push( i);
+    }
+    chan.close();
+}
+
+template< typename Channel >
+duration_type measure_same_thread( std::uint64_t count) {
+    Channel chan{ capacity };
+    std::uint64_t sum = 0;
+    time_point_type start{ clock_type::now() };
+    boost::fibers::fiber consumer{ [&chan,&sum](){ sum = consume( chan); } };
+    boost::fibers::fiber producer{ [&chan,count](){ produce( chan, count); } };
+    producer.join();
+    consumer.join();
+    duration_type duration = clock_type::now() - start;
+    if ( count * ( count - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+template< typename Channel >
+duration_type measure_cross_thread( std::uint64_t count) {
+    Channel chan{ capacity };
+    time_point_type start{ clock_type::now() };
+    std::thread producer{ [&chan,count](){ produce( chan, count); } };
+    std::uint64_t sum = consume( chan);
+    duration_type duration = clock_type::now() - start;
+    producer.join();
+    if ( count * ( count - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+void print( char const* name, std::uint64_t count, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / count
+              << " ns per message" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    using buffered_type = boost::fibers::buffered_channel< std::uint64_t >;
+    using spsc_type = boost::fibers::spsc_channel< std::uint64_t >;
+    try {
+        std::uint64_t count{ 1000000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // warm up
+        measure_same_thread< buffered_type >( count / 10 + 1);
+        measure_same_thread< spsc_type >( count / 10 + 1);
+        print( "same thread,  buffered_channel", count, measure_same_thread< buffered_type >( count) );
+        print( "same thread,  spsc_channel    ", count, measure_same_thread< spsc_type >( count) );
+        print( "cross thread, buffered_channel", count, measure_cross_thread< buffered_type >( count) );
+        print( "cross thread, spsc_channel    ", count, measure_cross_thread< spsc_type >( count) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// many producers, one consumer: buffered_channel vs. unbounded_channel
+// each producer runs on its own thread, the consumer is the main fiber
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+constexpr std::size_t capacity = 1024;
+constexpr std::uint64_t producers = 4;
+
+template< typename Channel >
+struct factory {
+    static Channel * create() {
+        return new Channel{ capacity };
+    }
+};
+
+template< typename T >
+struct factory< boost::fibers::unbounded_channel< T > > {
+    static boost::fibers::unbounded_channel< T > * create() {
+        return new boost::fibers::unbounded_channel< T >{};
+    }
+};
+
+template< typename Channel >
+duration_type measure( std::uint64_t count) {
+    std::unique_ptr< Channel > chan{ factory< Channel >::create() };
+    time_point_type start{ clock_type::now() };
+    std::vector< std::thread > threads;
+    for ( std::uint64_t p = 0; p < producers; ++p) {
+        threads.emplace_back( [&chan,count](){
+                                  for ( std::uint64_t i = 0; i < count; ++i) {
+                                      chan->push( i);
+                                  }
+                              });
+    }
+    std::uint64_t sum = 0, value = 0;
+    for ( std::uint64_t i = 0; i < producers * count; ++i) {
+        chan->pop( value);
+        sum += value;
+    }
+    duration_type duration = clock_type::now() - start;
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    if ( producers * count * ( count - 1) / 2 != sum) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+void print( char const* name, std::uint64_t count, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / ( producers * count)
+              << " ns per message" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    using buffered_type = boost::fibers::buffered_channel< std::uint64_t >;
+    using unbounded_type = boost::fibers::unbounded_channel< std::uint64_t >;
+    try {
+        std::uint64_t count{ 1000000 };
+        if ( 1 < argc) {
+            count = std::stoull( argv[1]);
+        }
+        // warm up
+        measure< buffered_type >( count / 10 + 1);
+        measure< unbounded_type >( count / 10 + 1);
+        print( "buffered_channel ", count, measure< buffered_type >( count) );
+        print( "unbounded_channel", count, measure< unbounded_type >( count) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// ping-pong latency over two unbuffered channels, both fibers on one
+// thread: handoff_policy::ready_queue vs. handoff_policy::direct
+// optionally with background fibers which keep the ready-queue busy
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using channel_type = boost::fibers::unbuffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+duration_type measure( boost::fibers::handoff_policy policy, std::uint64_t rounds, std::size_t background) {
+    channel_type ping{ policy }, pong{ policy };
+    std::atomic< bool > done{ false };
+    std::vector< boost::fibers::fiber > fibers;
+    for ( std::size_t i = 0; i < background; ++i) {
+        fibers.emplace_back( [&done](){
+                                 while ( ! done) {
+                                     boost::this_fiber::yield();
+                                 }
+                             });
+    }
+    fibers.emplace_back( [&ping,&pong,rounds](){
+                             for ( std::uint64_t i = 0; i < rounds; ++i) {
+                                 pong.push( ping.value_pop() + 1);
+                             }
+                         });
+    std::uint64_t value = 0;
+    time_point_type start{ clock_type::now() };
+    for ( std::uint64_t i = 0; i < rounds; ++i) {
+        ping.push( value);
+        value = pong.value_pop();
+    }
+    duration_type duration = clock_type::now() - start;
+    done = true;
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    if ( rounds != value) {
+        throw std::runtime_error("invalid result");
+    }
+    return duration;
+}
+
+void print( char const* name, std::uint64_t rounds, duration_type duration) {
+    std::cout << name << ": "
+              << static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >( duration).count() ) / rounds
+              << " ns per round trip" << std::endl;
+}
+
+int main( int argc, char * argv[]) {
+    using boost::fibers::handoff_policy;
+    try {
+        std::uint64_t rounds{ 200000 };
+        std::size_t background{ 8 };
+        if ( 1 < argc) {
+            rounds = std::stoull( argv[1]);
+        }
+        if ( 2 < argc) {
+            background = std::stoul( argv[2]);
+        }
+        // warm up
+        measure( handoff_policy::ready_queue, rounds / 10 + 1, 0);
+        print( "ready_queue", rounds, measure( handoff_policy::ready_queue, rounds, 0) );
+        print( "direct     ", rounds, measure( handoff_policy::direct, rounds, 0) );
+        print( "ready_queue, busy", rounds, measure( handoff_policy::ready_queue, rounds, background) );
+        print( "direct,      busy", rounds, measure( handoff_policy::direct, rounds, background) );
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -7,12 +7,17 @@
 
 #include "boost/fiber/algo/work_stealing.hpp"
 
+#include <algorithm>
 #include <random>
+#include <utility>
 
 #include <boost/assert.hpp>
 #include <boost/context/detail/prefetch.hpp>
 
-#include "boost/fiber/detail/thread_barrier.hpp"
+#include "boost/fiber/algo/round_robin.hpp"
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/detail/trace.hpp"
+#include "boost/fiber/operations.hpp"
 #include "boost/fiber/type.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -23,27 +28,332 @@ namespace boost {
 namespace fibers {
 namespace algo {
 
-std::atomic< std::uint32_t > work_stealing::counter_{ 0 };
-std::vector< intrusive_ptr< work_stealing > > work_stealing::schedulers_{};
+namespace {
+
+work_stealing_pool & default_pool( std::uint32_t thread_count) {
+    static work_stealing_pool pool{ thread_count };
+    // all threads of the default pool must agree on the thread count
+    BOOST_ASSERT( thread_count == pool.capacity() );
+    return pool;
+}
+
+// scheduler of the calling thread, if it is a member of a pool
+thread_local work_stealing * current_algo = nullptr;
+// true for the worker threads owned by a pool
+thread_local bool pool_worker = false;
+
+}
+
+work_stealing_pool::work_stealing_pool( std::uint32_t capacity, idle_policy const& policy) :
+    capacity_{ capacity },
+    policy_{ policy },
+    slots_{ new std::atomic< work_stealing * >[capacity] } {
+    for ( std::uint32_t i = 0; i < capacity_; ++i) {
+        slots_[i].store( nullptr, std::memory_order_relaxed);
+    }
+    members_.reserve( capacity_);
+}
+
+work_stealing_pool::~work_stealing_pool() {
+    std::vector< std::thread > threads;
+    {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        target_ = 0;
+        threads.swap( threads_);
+    }
+    cnd_.notify_all();
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+}
+
+void
+work_stealing_pool::attach_( work_stealing * algo) {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    std::uint32_t size = size_.load( std::memory_order_relaxed);
+    // slots of worker threads started by resize() are reserved
+    // even before the threads have attached
+    if ( BOOST_UNLIKELY( capacity_ == size ||
+                         ( ! pool_worker && capacity_ <= foreign_ + workers_) ) ) {
+        throw fiber_error{ std::make_error_code( std::errc::resource_unavailable_try_again),
+                           "boost fiber: work_stealing_pool capacity exceeded" };
+    }
+    // publish the scheduler before it becomes reachable by thieves
+    slots_[size].store( algo, std::memory_order_seq_cst);
+    size_.store( size + 1, std::memory_order_seq_cst);
+    members_.emplace_back( algo);
+    if ( ! pool_worker) {
+        ++foreign_;
+    }
+    reclaim_();
+}
+
+void
+work_stealing_pool::detach_( work_stealing * algo) {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    std::uint32_t last = size_.load( std::memory_order_relaxed) - 1;
+    std::uint32_t i = 0;
+    while ( algo != slots_[i].load( std::memory_order_relaxed) ) {
+        ++i;
+        BOOST_ASSERT( i <= last);
+    }
+    // keep [0, size_) compact: the last entry fills the hole
+    // a thief reading a stale size_ finds a nullptr
+    slots_[i].store( slots_[last].load( std::memory_order_relaxed), std::memory_order_seq_cst);
+    slots_[last].store( nullptr, std::memory_order_seq_cst);
+    size_.store( last, std::memory_order_seq_cst);
+    auto it = std::find( members_.begin(), members_.end(), algo);
+    BOOST_ASSERT( members_.end() != it);
+    left_ += algo->statistics_();
+    retired_.push_back( std::move( * it) );
+    members_.erase( it);
+    if ( ! pool_worker) {
+        --foreign_;
+    }
+    reclaim_();
+    // remaining members might be parked while the inbox is not empty
+    for ( intrusive_ptr< work_stealing > const& member : members_) {
+        member->notify();
+    }
+}
+
+void
+work_stealing_pool::reclaim_() noexcept {
+    if ( retired_.empty() ) {
+        return;
+    }
+    // a thief that might still read a retired scheduler has set its
+    // stealing_ flag before loading the slot; the slot has been cleared
+    // before the flags are read (both seq_cst), so a thief not seen here
+    // loads the new content of the slot
+    // only members steal, a scheduler leaving the pool has stopped stealing
+    for ( intrusive_ptr< work_stealing > const& member : members_) {
+        if ( member->stealing_.load( std::memory_order_seq_cst) ) {
+            return;
+        }
+    }
+    retired_.clear();
+}
 
 void
-work_stealing::init_( std::uint32_t thread_count,
-                      std::vector< intrusive_ptr< work_stealing > > & schedulers) {
-    // resize array of schedulers to thread_count, initilized with nullptr
-    std::vector< intrusive_ptr< work_stealing > >{ thread_count, nullptr }.swap( schedulers);
+work_stealing_pool::inject_( context * ctx) noexcept {
+    // counter first: a thief seeing an empty inbox with a non-zero
+    // counter just misses, the reverse would underflow the counter
+    inbox_size_.fetch_add( 1, std::memory_order_release);
+    inbox_.push( ctx);
+}
+
+std::size_t
+work_stealing_pool::steal_( work_stealing * thief, context ** ctxs, std::size_t max) noexcept {
+    std::size_t stolen = 0;
+    // context' handed over by schedulers that left the pool
+    if ( 0 < inbox_size_.load( std::memory_order_acquire) ) {
+        context * ctx = nullptr;
+        while ( stolen < max && nullptr != ( ctx = inbox_.pop() ) ) {
+            ctxs[stolen++] = ctx;
+        }
+        if ( 0 < stolen) {
+            inbox_size_.fetch_sub( stolen, std::memory_order_relaxed);
+            BOOST_FIBERS_TRACE( steal, nullptr, stolen);
+            return stolen;
+        }
+    }
+    // announce the access to slots_ without touching a cache line
+    // shared by all members of the pool
+    thief->stealing_.store( true, std::memory_order_seq_cst);
+    std::uint32_t size = size_.load( std::memory_order_seq_cst);
+    if ( 1 < size) {
+        static thread_local std::minstd_rand generator{ std::random_device{}() };
+        std::uniform_int_distribution< std::uint32_t > distribution{ 0, size - 1 };
+        for ( std::uint32_t count = 0; 0 == stolen && count < size; ++count) {
+            // random selection of one member, slots of members that
+            // left the pool in the meantime contain a nullptr
+            work_stealing * victim = slots_[distribution( generator)].load( std::memory_order_seq_cst);
+            // prevent stealing from own scheduler
+            if ( nullptr != victim && thief != victim) {
+                // steal up to half of the context' from other scheduler
+                stolen = victim->steal_batch( ctxs, max);
+            }
+        }
+    }
+    thief->stealing_.store( false, std::memory_order_release);
+    if ( 0 < stolen) {
+        BOOST_FIBERS_TRACE( steal, nullptr, stolen);
+    }
+    return stolen;
+}
+
+void
+work_stealing_pool::join_exited_( std::unique_lock< std::mutex > & lk) {
+    std::vector< std::thread > threads;
+    for ( std::thread::id id : exited_) {
+        auto it = std::find_if( threads_.begin(), threads_.end(),
+                                [id](std::thread const& t){ return id == t.get_id(); });
+        BOOST_ASSERT( threads_.end() != it);
+        threads.push_back( std::move( * it) );
+        threads_.erase( it);
+    }
+    exited_.clear();
+    lk.unlock();
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    lk.lock();
+}
+
+void
+work_stealing_pool::worker_() {
+    pool_worker = true;
+    boost::fibers::use_scheduling_algorithm< work_stealing >( * this, policy_);
+    {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        // retire if there are more workers than requested
+        cnd_.wait( lk, [this](){ return target_ < workers_ - retiring_; });
+        ++retiring_;
+    }
+    leave();
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    // the slot is counted until this thread has been detached,
+    // a resize() in the meantime leaves the replacement to this thread
+    --retiring_;
+    --workers_;
+    exited_.push_back( std::this_thread::get_id() );
+    start_workers_();
+}
+
+void
+work_stealing_pool::start_workers_() {
+    while ( workers_ < target_) {
+        threads_.emplace_back( & work_stealing_pool::worker_, this);
+        ++workers_;
+    }
+}
+
+std::uint32_t
+work_stealing_pool::target() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    return target_;
+}
+
+std::vector< scheduler_statistics >
+work_stealing_pool::member_statistics() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    std::vector< scheduler_statistics > stats;
+    stats.reserve( members_.size() );
+    for ( intrusive_ptr< work_stealing > const& member : members_) {
+        stats.push_back( member->statistics_() );
+    }
+    return stats;
+}
+
+scheduler_statistics
+work_stealing_pool::statistics() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    scheduler_statistics stats = left_;
+    for ( intrusive_ptr< work_stealing > const& member : members_) {
+        stats += member->statistics_();
+    }
+    return stats;
+}
+
+void
+work_stealing_pool::resize( std::uint32_t workers) {
+    {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        join_exited_( lk);
+        // threads that joined the pool on their own occupy slots too
+        target_ = (std::min)( workers, capacity_ - foreign_);
+        start_workers_();
+    }
+    cnd_.notify_all();
+}
+
+double
+work_stealing_pool::utilisation() const noexcept {
+    std::uint32_t size = size_.load( std::memory_order_relaxed);
+    if ( 0 == size) {
+        return 0.;
+    }
+    std::uint32_t parked = (std::min)( size, parked_.load( std::memory_order_relaxed) );
+    return 1. - static_cast< double >( parked) / size;
+}
+
+std::uint32_t
+work_stealing_pool::autoscale( elastic_policy const& policy) {
+    double utilisation = this->utilisation();
+    std::uint32_t workers = target();
+    if ( policy.grow_above < utilisation && workers < policy.max_workers) {
+        ++workers;
+    } else if ( policy.shrink_below > utilisation && workers > policy.min_workers) {
+        --workers;
+    }
+    workers = (std::max)( policy.min_workers, (std::min)( policy.max_workers, workers) );
+    resize( workers);
+    return workers;
+}
+
+void
+work_stealing_pool::leave() {
+    work_stealing * algo = current_algo;
+    BOOST_ASSERT( nullptr != algo);
+    BOOST_ASSERT( this == & algo->pool_);
+    current_algo = nullptr;
+    // hand over the ready fibers to the remaining members
+    algo->drain_();
+    detach_( algo);
+    // fibers becoming ready later are scheduled on this thread
+    boost::fibers::use_scheduling_algorithm< round_robin >();
+}
+
+work_stealing::work_stealing( work_stealing_pool & pool, bool suspend) :
+    work_stealing{ pool, idle_policy{}, suspend } {
+}
+
+work_stealing::work_stealing( work_stealing_pool & pool, idle_policy const& policy) :
+    work_stealing{ pool, policy, true } {
 }
 
 work_stealing::work_stealing( std::uint32_t thread_count, bool suspend) :
-        id_{ counter_++ },
-        thread_count_{ thread_count },
-        suspend_{ suspend } {
-    static boost::fibers::detail::thread_barrier b{ thread_count };
-    // initialize the array of schedulers
-    static std::once_flag flag;
-    std::call_once( flag, & work_stealing::init_, thread_count_, std::ref( schedulers_) );
-    // register pointer of this scheduler
-    schedulers_[id_] = this;
-    b.wait();
+    work_stealing{ default_pool( thread_count), idle_policy{}, suspend } {
+}
+
+work_stealing::work_stealing( std::uint32_t thread_count, idle_policy const& policy) :
+    work_stealing{ default_pool( thread_count), policy, true } {
+}
+
+work_stealing::work_stealing( work_stealing_pool & pool, idle_policy const& policy, bool suspend) :
+        pool_( pool),
+        idle_{ policy },
+        suspend_{ suspend },
+        counters_{ context::active()->get_scheduler()->get_counters() },
+        baseline_{ counters_->snapshot() } {
+    pool_.attach_( this);
+    current_algo = this;
+}
+
+scheduler_statistics
+work_stealing::statistics_() const noexcept {
+    scheduler_statistics stats = counters_->snapshot();
+    stats -= baseline_;
+    return stats;
+}
+
+void
+work_stealing::drain_() {
+    // pinned context' (dispatcher) stay on this thread
+    std::vector< context * > pinned;
+    context * ctx = nullptr;
+    while ( nullptr != ( ctx = rqueue_.pop() ) ) {
+        if ( ctx->is_context( type::pinned_context) ) {
+            pinned.push_back( ctx);
+        } else {
+            // still detached, attached by the thread picking it
+            pool_.inject_( ctx);
+        }
+    }
+    for ( context * c : pinned) {
+        rqueue_.push( c);
+    }
 }
 
 void
@@ -63,23 +373,16 @@ work_stealing::pick_next() noexcept {
             context::active()->attach( victim);
         }
     } else {
-        std::uint32_t id = 0;
-        std::size_t count = 0, size = schedulers_.size();
-        static thread_local std::minstd_rand generator{ std::random_device{}() };
-        std::uniform_int_distribution< std::uint32_t > distribution{
-            0, static_cast< std::uint32_t >( thread_count_ - 1) };
-        do {
-            do {
-                ++count;
-                // random selection of one logical cpu
-                // that belongs to the local NUMA node
-                id = distribution( generator);
-                // prevent stealing from own scheduler
-            } while ( id == id_);
-            // steal context from other scheduler
-            victim = schedulers_[id]->steal();
-        } while ( nullptr == victim && count < size);
-        if ( nullptr != victim) {
+        context * batch[BOOST_FIBERS_STEAL_BATCH_MAX];
+        std::size_t stolen = pool_.steal_( this, batch, BOOST_FIBERS_STEAL_BATCH_MAX);
+        counters_->stole( stolen);
+        if ( 0 < stolen) {
+            victim = batch[0];
+            // keep the remaining context' in the local ready-queue
+            // they are still detached, attached when picked
+            for ( std::size_t i = 1; i < stolen; ++i) {
+                rqueue_.push( batch[i]);
+            }
             boost::context::detail::prefetch_range( victim, sizeof( context) );
             BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
             context::active()->attach( victim);
@@ -88,28 +391,30 @@ work_stealing::pick_next() noexcept {
     return victim;
 }
 
+bool
+work_stealing::probe_() noexcept {
+    // move stolen context' to the local ready-queue,
+    // pick_next() takes them from there
+    context * batch[BOOST_FIBERS_STEAL_BATCH_MAX];
+    std::size_t stolen = pool_.steal_( this, batch, BOOST_FIBERS_STEAL_BATCH_MAX);
+    counters_->stole( stolen);
+    for ( std::size_t i = 0; i < stolen; ++i) {
+        rqueue_.push( batch[i]);
+    }
+    return 0 < stolen;
+}
+
 void
 work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
     if ( suspend_) {
-        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait( lk, [this](){ return flag_; });
-            flag_ = false;
-        } else {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
-            flag_ = false;
-        }
+        idle_.idle( time_point, pool_.spinning_, pool_.parked_, [this](){ return probe_(); });
     }
 }
 
 void
 work_stealing::notify() noexcept {
     if ( suspend_) {
-        std::unique_lock< std::mutex > lk{ mtx_ };
-        flag_ = true;
-        lk.unlock();
-        cnd_.notify_all();
+        idle_.unpark();
     }
 }
 
@@ -6,10 +6,12 @@
 
 #include "boost/fiber/context.hpp"
 
+#include <cstdint>
 #include <cstdlib>
 #include <mutex>
 #include <new>
 
+#include "boost/fiber/detail/trace.hpp"
 #include "boost/fiber/exceptions.hpp"
 #include "boost/fiber/scheduler.hpp"
 
@@ -20,6 +22,22 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+namespace {
+
+std::uint32_t trace_flags( context const* ctx) noexcept {
+    if ( ctx->is_context( type::main_context) ) {
+        return detail::trace_main_context;
+    }
+    if ( ctx->is_context( type::dispatcher_context) ) {
+        return detail::trace_dispatcher_context;
+    }
+    return 0;
+}
+
+}
+#endif
+
 class main_context final : public context {
 public:
     main_context() noexcept :
@@ -132,6 +150,7 @@ context::get_id() const noexcept {
 
 void
 context::resume() noexcept {
+    BOOST_FIBERS_TRACE( resume, this, trace_flags( this) );
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
@@ -145,6 +164,7 @@ context::resume() noexcept {
 
 void
 context::resume( detail::spinlock_lock & lk) noexcept {
+    BOOST_FIBERS_TRACE( resume, this, trace_flags( this) );
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
@@ -159,6 +179,7 @@ context::resume( detail::spinlock_lock & lk) noexcept {
 
 void
 context::resume( context * ready_ctx) noexcept {
+    BOOST_FIBERS_TRACE( resume, this, trace_flags( this) );
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
@@ -173,11 +194,13 @@ context::resume( context * ready_ctx) noexcept {
 
 void
 context::suspend() noexcept {
+    BOOST_FIBERS_TRACE( suspend, this, 0);
     get_scheduler()->suspend();
 }
 
 void
 context::suspend( detail::spinlock_lock & lk) noexcept {
+    BOOST_FIBERS_TRACE( suspend, this, 0);
     get_scheduler()->suspend( lk);
 }
 
@@ -206,6 +229,7 @@ context::yield() noexcept {
 
 boost::context::fiber
 context::suspend_with_cc() noexcept {
+    BOOST_FIBERS_TRACE( resume, this, trace_flags( this) );
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
@@ -271,6 +295,29 @@ bool context::wake(const size_t epoch) noexcept
     return true;
 }
 
+bool context::handoff(const size_t epoch) noexcept
+{
+    size_t expected = epoch;
+    if ( ! waker_epoch_.compare_exchange_strong(expected, epoch + 1, std::memory_order_acq_rel) ) {
+        // outdated
+        return false;
+    }
+
+    BOOST_ASSERT( context::active() != this);
+    if ( context::active()->get_scheduler() == get_scheduler()) {
+        get_scheduler()->schedule_handoff( this);
+    } else {
+        get_scheduler()->schedule_from_remote( this);
+    }
+    return true;
+}
+
+bool context::cancel_wake(const size_t epoch) noexcept
+{
+    size_t expected = epoch;
+    return waker_epoch_.compare_exchange_strong(expected, epoch + 1, std::memory_order_acq_rel);
+}
+
 
 void
 context::schedule( context * ctx) noexcept {
@@ -0,0 +1,118 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/counting_semaphore.hpp"
+
+#include <system_error>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+counting_semaphore_base::counting_semaphore_base( std::ptrdiff_t desired, std::ptrdiff_t max) :
+    state_{ desired * count_unit } {
+    if ( BOOST_UNLIKELY( 0 > desired || max < desired) ) {
+        throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: counting_semaphore count out of range" };
+    }
+}
+
+bool
+counting_semaphore_base::try_acquire_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
+    if ( try_acquire() ) {
+        return true;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    std::ptrdiff_t state = state_.load( std::memory_order_relaxed);
+    while ( true) {
+        if ( count_unit <= state) {
+            if ( state_.compare_exchange_weak( state, state - count_unit,
+                                               std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+        } else if ( std::chrono::steady_clock::now() > timeout_time) {
+            return false;
+        } else if ( state_.compare_exchange_weak( state, state | waiters_bit,
+                                                  std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            // a stale waiters_bit is cleared by the next release()
+            if ( ! wait_queue_.suspend_and_wait_until( lk, active_ctx, timeout_time) ) {
+                return false;
+            }
+            lk.lock();
+            state = state_.load( std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+counting_semaphore_base::release( std::ptrdiff_t update) noexcept {
+    BOOST_ASSERT( 0 <= update);
+    std::ptrdiff_t state = state_.fetch_add( update * count_unit, std::memory_order_release);
+    BOOST_ASSERT( update <= max_value - state / count_unit);
+    if ( 0 == ( state & waiters_bit) ) {
+        return;
+    }
+    // at most update waiters are resumed, they compete with
+    // fibers calling acquire() concurrently
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    for ( ; 0 < update; --update) {
+        if ( nullptr == wait_queue_.notify_one() ) {
+            break;
+        }
+    }
+    if ( wait_queue_.empty() ) {
+        state_.fetch_and( ~waiters_bit, std::memory_order_relaxed);
+    }
+}
+
+void
+counting_semaphore_base::acquire() {
+    if ( try_acquire() ) {
+        return;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    std::ptrdiff_t state = state_.load( std::memory_order_relaxed);
+    while ( true) {
+        if ( count_unit <= state) {
+            if ( state_.compare_exchange_weak( state, state - count_unit,
+                                               std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return;
+            }
+        } else if ( state_.compare_exchange_weak( state, state | waiters_bit,
+                                                  std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            wait_queue_.suspend_and_wait( lk, active_ctx);
+            lk.lock();
+            state = state_.load( std::memory_order_relaxed);
+        }
+    }
+}
+
+bool
+counting_semaphore_base::try_acquire() noexcept {
+    std::ptrdiff_t state = state_.load( std::memory_order_relaxed);
+    while ( count_unit <= state) {
+        if ( state_.compare_exchange_weak( state, state - count_unit,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
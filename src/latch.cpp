@@ -0,0 +1,65 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/latch.hpp"
+
+#include <system_error>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+latch::latch( std::ptrdiff_t expected) :
+    state_{ expected * count_unit } {
+    if ( BOOST_UNLIKELY( 0 > expected || max() < expected) ) {
+        throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: latch count out of range" };
+    }
+}
+
+void
+latch::count_down( std::ptrdiff_t update) noexcept {
+    BOOST_ASSERT( 0 <= update);
+    // acq_rel: the waiters synchronize with all fibers that counted down
+    std::ptrdiff_t state = state_.fetch_sub( update * count_unit, std::memory_order_acq_rel);
+    BOOST_ASSERT( update <= state / count_unit);
+    if ( update * count_unit != ( state & ~waiters_bit) || 0 == ( state & waiters_bit) ) {
+        return;
+    }
+    // the counter reached zero, all waiters are resumed in one pass
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    wait_queue_.notify_all();
+}
+
+void
+latch::wait() const {
+    if ( try_wait() ) {
+        return;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    std::ptrdiff_t state = state_.load( std::memory_order_acquire);
+    while ( count_unit <= state) {
+        if ( state_.compare_exchange_weak( state, state | waiters_bit,
+                                           std::memory_order_acquire, std::memory_order_acquire) ) {
+            // resumed by the fiber counting down to zero
+            wait_queue_.suspend_and_wait( lk, active_ctx);
+            return;
+        }
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
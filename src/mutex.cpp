@@ -7,9 +7,12 @@
 #include "boost/fiber/mutex.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <system_error>
 
+#include "boost/fiber/detail/cpu_relax.hpp"
 #include "boost/fiber/exceptions.hpp"
 #include "boost/fiber/scheduler.hpp"
 #include "boost/fiber/waker.hpp"
@@ -21,56 +24,136 @@
 namespace boost {
 namespace fibers {
 
+bool
+mutex::try_acquire_( context * active_ctx) noexcept {
+    // a single CAS if the mutex is not contended
+    std::uintptr_t state = 0;
+    do {
+        // waiters_bit is kept
+        if ( state_.compare_exchange_weak( state, reinterpret_cast< std::uintptr_t >( active_ctx) | state,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    } while ( 0 == ( state & ~waiters_bit) );
+    return false;
+}
+
+bool
+mutex::enlist_waiter_() noexcept {
+    std::uintptr_t state = state_.load( std::memory_order_relaxed);
+    do {
+        if ( 0 == ( state & ~waiters_bit) ) {
+            return false;
+        }
+    } while ( ! state_.compare_exchange_weak( state, state | waiters_bit,
+                                              std::memory_order_relaxed, std::memory_order_relaxed) );
+    return true;
+}
+
 void
-mutex::lock() {
+mutex::release_() noexcept {
+    // waiters_bit is set, unlock() could not simply clear the state
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    context * ctx = wait_queue_.notify_one();
+    std::uintptr_t waiters = wait_queue_.empty() ? 0 : waiters_bit;
+    if ( handoff_ && nullptr != ctx) {
+        // the owner changes directly to the resumed fiber, fibers calling
+        // lock() never see the mutex unlocked in between
+        state_.store( reinterpret_cast< std::uintptr_t >( ctx) | waiters, std::memory_order_release);
+    } else {
+        handoff_ = false;
+        state_.store( waiters, std::memory_order_release);
+    }
+}
+
+void
+mutex::lock_slow_( context * active_ctx) {
+    std::chrono::steady_clock::time_point wait_start{};
     while ( true) {
-        context * active_ctx = context::active();
+        if ( mutex_policy::adaptive == policy_) {
+            // the owner might run on another thread and release
+            // the mutex soon
+            for ( std::size_t i = 0; i < BOOST_FIBERS_SPIN_BEFORE_SUSPEND; ++i) {
+                cpu_relax();
+                if ( nullptr == owner_() && try_acquire_( active_ctx) ) {
+                    return;
+                }
+            }
+        }
         // store this fiber in order to be notified later
         detail::spinlock_lock lk{ wait_queue_splk_ };
-        if ( BOOST_UNLIKELY( active_ctx == owner_) ) {
-            throw lock_error{
-                    std::make_error_code( std::errc::resource_deadlock_would_occur),
-                    "boost fiber: a deadlock is detected" };
+        while ( ! enlist_waiter_() ) {
+            if ( try_acquire_( active_ctx) ) {
+                return;
+            }
+        }
+        if ( mutex_policy::suspend == policy_) {
+            wait_queue_.suspend_and_wait( lk, active_ctx);
+            continue;
+        }
+        if ( std::chrono::steady_clock::time_point{} == wait_start) {
+            wait_start = std::chrono::steady_clock::now();
+        } else if ( std::chrono::steady_clock::now() - wait_start >
+                    std::chrono::microseconds( BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD) ) {
+            // this fiber has been resumed but lost the mutex to fibers
+            // calling lock() for too long
+            handoff_ = true;
         }
-        if ( nullptr == owner_) {
-            owner_ = active_ctx;
+        wait_queue_.suspend_and_wait( lk, active_ctx);
+        lk.lock();
+        if ( active_ctx == owner_() ) {
+            // handed over by unlock(); stop passing the ownership if
+            // the waiters do not starve any more
+            if ( std::chrono::steady_clock::now() - wait_start <
+                    std::chrono::microseconds( BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD) ) {
+                handoff_ = false;
+            }
             return;
         }
+    }
+}
 
-        wait_queue_.suspend_and_wait( lk, active_ctx);
+void
+mutex::lock() {
+    context * active_ctx = context::active();
+    if ( try_acquire_( active_ctx) ) {
+        return;
     }
+    if ( BOOST_UNLIKELY( active_ctx == owner_() ) ) {
+        throw lock_error{
+                std::make_error_code( std::errc::resource_deadlock_would_occur),
+                "boost fiber: a deadlock is detected" };
+    }
+    lock_slow_( active_ctx);
 }
 
 bool
 mutex::try_lock() {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk{ wait_queue_splk_ };
-    if ( BOOST_UNLIKELY( active_ctx == owner_) ) {
+    if ( try_acquire_( active_ctx) ) {
+        return true;
+    }
+    if ( BOOST_UNLIKELY( active_ctx == owner_() ) ) {
         throw lock_error{
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected" };
     }
-    if ( nullptr == owner_) {
-        owner_ = active_ctx;
-    }
-    lk.unlock();
-    // let other fiber release the lock
-    active_ctx->yield();
-    return active_ctx == owner_;
+    return false;
 }
 
 void
 mutex::unlock() {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk{ wait_queue_splk_ };
-    if ( BOOST_UNLIKELY( active_ctx != owner_) ) {
+    std::uintptr_t state = reinterpret_cast< std::uintptr_t >( active_ctx);
+    if ( state_.compare_exchange_strong( state, 0, std::memory_order_release, std::memory_order_relaxed) ) {
+        return;
+    }
+    if ( BOOST_UNLIKELY( reinterpret_cast< std::uintptr_t >( active_ctx) != ( state & ~waiters_bit) ) ) {
         throw lock_error{
                 std::make_error_code( std::errc::operation_not_permitted),
                 "boost fiber: no  privilege to perform the operation" };
     }
-    owner_ = nullptr;
-
-    wait_queue_.notify_one();
+    release_();
 }
 
 }}
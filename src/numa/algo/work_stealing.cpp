@@ -13,7 +13,7 @@
 #include <boost/assert.hpp>
 #include <boost/context/detail/prefetch.hpp>
 
-#include "boost/fiber/detail/thread_barrier.hpp"
+#include "boost/fiber/detail/trace.hpp"
 #include "boost/fiber/type.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -25,8 +25,6 @@ namespace fibers {
 namespace numa {
 namespace algo {
 
-std::vector< intrusive_ptr< work_stealing > > work_stealing::schedulers_{};
-
 std::vector< std::uint32_t > get_local_cpus( std::uint32_t node_id, std::vector< boost::fibers::numa::node > const& topo) {
     for ( auto & node : topo) {
         if ( node_id == node.id) {
@@ -49,18 +47,94 @@ std::vector< std::uint32_t > get_remote_cpus( std::uint32_t node_id, std::vector
     return remote_cpus;
 }
 
-void
-work_stealing::init_( std::vector< boost::fibers::numa::node > const& topo,
-                      std::vector< intrusive_ptr< work_stealing > > & schedulers) {
+namespace {
+
+std::size_t get_thread_count( std::vector< boost::fibers::numa::node > const& topo) {
+    std::size_t thread_count = 0;
+    for ( auto & node : topo) {
+        thread_count += node.logical_cpus.size();
+    }
+    return thread_count;
+}
+
+std::uint32_t get_max_cpu_id( std::vector< boost::fibers::numa::node > const& topo) {
     std::uint32_t max_cpu_id = 0;
     for ( auto & node : topo) {
         max_cpu_id = (std::max)( max_cpu_id, * node.logical_cpus.rbegin() );
     }
+    return max_cpu_id;
+}
+
+work_stealing_pool & default_pool( std::vector< boost::fibers::numa::node > const& topo) {
+    static work_stealing_pool pool{ topo };
+    return pool;
+}
+
+}
+
+work_stealing_pool::work_stealing_pool( std::vector< boost::fibers::numa::node > const& topo) :
+    topo_( topo),
     // resize array of schedulers to max. CPU ID, initilized with nullptr
     // CPU ID acts as the index in the scheduler array
     // if a logical cpus is offline, schedulers_ will contain a nullptr
     // logical cpus index starts at `0` -> add 1
-    std::vector< intrusive_ptr< work_stealing > >{ max_cpu_id + 1, nullptr }.swap( schedulers);
+    schedulers_{ get_max_cpu_id( topo) + 1, nullptr },
+    barrier_{ get_thread_count( topo) } {
+}
+
+work_stealing_pool::~work_stealing_pool() = default;
+
+void
+work_stealing_pool::attach_( std::uint32_t cpu_id, work_stealing * algo) {
+    BOOST_ASSERT( cpu_id < schedulers_.size() );
+    {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        BOOST_ASSERT( nullptr == schedulers_[cpu_id]);
+        // register pointer of this scheduler
+        schedulers_[cpu_id] = algo;
+    }
+    // stealing starts after all schedulers have been registered
+    barrier_.wait();
+}
+
+std::vector< boost::fibers::scheduler_statistics >
+work_stealing_pool::member_statistics() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    std::vector< boost::fibers::scheduler_statistics > stats;
+    for ( intrusive_ptr< work_stealing > const& member : schedulers_) {
+        if ( member) {
+            stats.push_back( member->statistics_() );
+        }
+    }
+    return stats;
+}
+
+boost::fibers::scheduler_statistics
+work_stealing_pool::statistics() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    boost::fibers::scheduler_statistics stats;
+    for ( intrusive_ptr< work_stealing > const& member : schedulers_) {
+        if ( member) {
+            stats += member->statistics_();
+        }
+    }
+    return stats;
+}
+
+work_stealing::work_stealing(
+    work_stealing_pool & pool,
+    std::uint32_t cpu_id,
+    std::uint32_t node_id,
+    bool suspend) :
+    work_stealing{ pool, cpu_id, node_id, boost::fibers::algo::idle_policy{}, suspend } {
+}
+
+work_stealing::work_stealing(
+    work_stealing_pool & pool,
+    std::uint32_t cpu_id,
+    std::uint32_t node_id,
+    boost::fibers::algo::idle_policy const& policy) :
+    work_stealing{ pool, cpu_id, node_id, policy, true } {
 }
 
 work_stealing::work_stealing(
@@ -68,24 +142,57 @@ work_stealing::work_stealing(
     std::uint32_t node_id,
     std::vector< boost::fibers::numa::node > const& topo,
     bool suspend) :
+    work_stealing{ default_pool( topo), cpu_id, node_id, boost::fibers::algo::idle_policy{}, suspend } {
+}
+
+work_stealing::work_stealing(
+    std::uint32_t cpu_id,
+    std::uint32_t node_id,
+    std::vector< boost::fibers::numa::node > const& topo,
+    boost::fibers::algo::idle_policy const& policy) :
+    work_stealing{ default_pool( topo), cpu_id, node_id, policy, true } {
+}
+
+work_stealing::work_stealing(
+    work_stealing_pool & pool,
+    std::uint32_t cpu_id,
+    std::uint32_t node_id,
+    boost::fibers::algo::idle_policy const& policy,
+    bool suspend) :
+        pool_( pool),
         cpu_id_{ cpu_id },
-        local_cpus_{ get_local_cpus( node_id, topo) },
-        remote_cpus_{ get_remote_cpus( node_id, topo) },
-        suspend_{ suspend } {
+        local_cpus_{ get_local_cpus( node_id, pool.topology() ) },
+        remote_cpus_{ get_remote_cpus( node_id, pool.topology() ) },
+        idle_{ policy },
+        suspend_{ suspend },
+        counters_{ context::active()->get_scheduler()->get_counters() },
+        baseline_{ counters_->snapshot() } {
     // pin current thread to logical cpu
     boost::fibers::numa::pin_thread( cpu_id_);
-    // calculate thread count
-    std::size_t thread_count = 0;
-    for ( auto & node : topo) {
-        thread_count += node.logical_cpus.size();
+    pool_.attach_( cpu_id_, this);
+}
+
+boost::fibers::scheduler_statistics
+work_stealing::statistics_() const noexcept {
+    boost::fibers::scheduler_statistics stats = counters_->snapshot();
+    stats -= baseline_;
+    return stats;
+}
+
+context *
+work_stealing::take_batch_( context ** batch, std::size_t stolen) noexcept {
+    BOOST_ASSERT( 0 < stolen);
+    BOOST_FIBERS_TRACE( steal, nullptr, stolen);
+    // keep the remaining context' in the local ready-queue
+    // they are still detached, attached when picked
+    for ( std::size_t i = 1; i < stolen; ++i) {
+        rqueue_.push( batch[i]);
     }
-    static boost::fibers::detail::thread_barrier b{ thread_count };
-    // initialize the array of schedulers
-    static std::once_flag flag;
-    std::call_once( flag, & work_stealing::init_, topo, std::ref( schedulers_) );
-    // register pointer of this scheduler
-    schedulers_[cpu_id_] = this;
-    b.wait();
+    context * victim = batch[0];
+    boost::context::detail::prefetch_range( victim, sizeof( context) );
+    BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
+    context::active()->attach( victim);
+    return victim;
 }
 
 void
@@ -106,29 +213,31 @@ work_stealing::pick_next() noexcept {
         }
     } else {
         std::uint32_t cpu_id = 0;
-        std::size_t count = 0, size = local_cpus_.size();
+        std::size_t count = 0, size = local_cpus_.size(), stolen = 0;
+        context * batch[BOOST_FIBERS_STEAL_BATCH_MAX];
         static thread_local std::minstd_rand generator{ std::random_device{}() };
         std::uniform_int_distribution< std::uint32_t > local_distribution{
             0, static_cast< std::uint32_t >( local_cpus_.size() - 1) };
         std::uniform_int_distribution< std::uint32_t > remote_distribution{
             0, static_cast< std::uint32_t >( remote_cpus_.size() - 1) };
-        do {
+        // a single logical cpu on the local NUMA node: nothing to steal from
+        if ( 1 < size) {
             do {
-                ++count;
-                // random selection of one logical cpu
-                // that belongs to the local NUMA node
-                cpu_id = local_cpus_[local_distribution( generator)];
-                // prevent stealing from own scheduler
-            } while ( cpu_id == cpu_id_);
-            // steal context from other scheduler
-            // schedulers_[cpu_id] should never contain a nullptr
-            BOOST_ASSERT( nullptr != schedulers_[cpu_id]);
-            victim = schedulers_[cpu_id]->steal();
-        } while ( nullptr == victim && count < size);
-        if ( nullptr != victim) {
-            boost::context::detail::prefetch_range( victim, sizeof( context) );
-            BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
-            context::active()->attach( victim);
+                do {
+                    ++count;
+                    // random selection of one logical cpu
+                    // that belongs to the local NUMA node
+                    cpu_id = local_cpus_[local_distribution( generator)];
+                    // prevent stealing from own scheduler
+                } while ( cpu_id == cpu_id_);
+                // steal up to half of the context' from other scheduler
+                // schedulers_[cpu_id] should never contain a nullptr
+                BOOST_ASSERT( nullptr != pool_.schedulers_[cpu_id]);
+                stolen = pool_.schedulers_[cpu_id]->steal_batch( batch, BOOST_FIBERS_STEAL_BATCH_MAX);
+            } while ( 0 == stolen && count < size);
+        }
+        if ( 0 < stolen) {
+            victim = take_batch_( batch, stolen);
         } else if ( ! remote_cpus_.empty() ) {
             cpu_id = 0;
             count = 0;
@@ -141,44 +250,66 @@ work_stealing::pick_next() noexcept {
                 // remote cpu ID should never be equal to local cpu ID
                 BOOST_ASSERT( cpu_id != cpu_id_);
                 // schedulers_[cpu_id] should never contain a nullptr
-                BOOST_ASSERT( nullptr != schedulers_[cpu_id]);
-                // steal context from other scheduler
-                victim = schedulers_[cpu_id]->steal();
-            } while ( nullptr == victim && count < size);
-            if ( nullptr != victim) {
-                boost::context::detail::prefetch_range( victim, sizeof( context) );
-                BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
+                BOOST_ASSERT( nullptr != pool_.schedulers_[cpu_id]);
+                // steal up to half of the context' from other scheduler
+                stolen = pool_.schedulers_[cpu_id]->steal_batch( batch, BOOST_FIBERS_STEAL_BATCH_MAX);
+            } while ( 0 == stolen && count < size);
+            if ( 0 < stolen) {
                 // move memory from remote NUMA-node to
                 // memory of local NUMA-node
-                context::active()->attach( victim);
+                victim = take_batch_( batch, stolen);
             }
         }
+        counters_->stole( stolen);
     }
     return victim;
 }
 
+bool
+work_stealing::probe_() noexcept {
+    static thread_local std::minstd_rand generator{ std::random_device{}() };
+    std::uint32_t cpu_id = cpu_id_;
+    if ( 1 < local_cpus_.size() ) {
+        // probe logical cpus of the local NUMA node,
+        // remote nodes only if there is no other local cpu
+        std::uniform_int_distribution< std::uint32_t > local_distribution{
+            0, static_cast< std::uint32_t >( local_cpus_.size() - 1) };
+        do {
+            cpu_id = local_cpus_[local_distribution( generator)];
+        } while ( cpu_id == cpu_id_);
+    } else if ( ! remote_cpus_.empty() ) {
+        std::uniform_int_distribution< std::uint32_t > remote_distribution{
+            0, static_cast< std::uint32_t >( remote_cpus_.size() - 1) };
+        cpu_id = remote_cpus_[remote_distribution( generator)];
+    } else {
+        return false;
+    }
+    BOOST_ASSERT( nullptr != pool_.schedulers_[cpu_id]);
+    // move stolen context' to the local ready-queue,
+    // pick_next() takes them from there
+    context * batch[BOOST_FIBERS_STEAL_BATCH_MAX];
+    std::size_t stolen = pool_.schedulers_[cpu_id]->steal_batch( batch, BOOST_FIBERS_STEAL_BATCH_MAX);
+    counters_->stole( stolen);
+    if ( 0 < stolen) {
+        BOOST_FIBERS_TRACE( steal, nullptr, stolen);
+    }
+    for ( std::size_t i = 0; i < stolen; ++i) {
+        rqueue_.push( batch[i]);
+    }
+    return 0 < stolen;
+}
+
 void
 work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
     if ( suspend_) {
-        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait( lk, [this](){ return flag_; });
-            flag_ = false;
-        } else {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
-            flag_ = false;
-        }
+        idle_.idle( time_point, pool_.spinning_, pool_.parked_, [this](){ return probe_(); });
     }
 }
 
 void
 work_stealing::notify() noexcept {
     if ( suspend_) {
-        std::unique_lock< std::mutex > lk{ mtx_ };
-        flag_ = true;
-        lk.unlock();
-        cnd_.notify_all();
+        idle_.unpark();
     }
 }
 
@@ -19,54 +19,85 @@
 namespace boost {
 namespace fibers {
 
+bool
+recursive_mutex::try_acquire_( context * active_ctx) noexcept {
+    // a single CAS if the mutex is not contended
+    std::uintptr_t state = 0;
+    do {
+        // waiters_bit is kept
+        if ( state_.compare_exchange_weak( state, reinterpret_cast< std::uintptr_t >( active_ctx) | state,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    } while ( 0 == ( state & ~waiters_bit) );
+    return false;
+}
+
+bool
+recursive_mutex::enlist_waiter_() noexcept {
+    std::uintptr_t state = state_.load( std::memory_order_relaxed);
+    do {
+        if ( 0 == ( state & ~waiters_bit) ) {
+            return false;
+        }
+    } while ( ! state_.compare_exchange_weak( state, state | waiters_bit,
+                                              std::memory_order_relaxed, std::memory_order_relaxed) );
+    return true;
+}
+
+void
+recursive_mutex::release_() noexcept {
+    // waiters_bit is set, unlock() could not simply clear the state
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    wait_queue_.notify_one();
+    state_.store( wait_queue_.empty() ? 0 : waiters_bit, std::memory_order_release);
+}
+
 void
 recursive_mutex::lock() {
-    while ( true) {
-        context * active_ctx = context::active();
+    context * active_ctx = context::active();
+    if ( active_ctx == owner_() ) {
+        ++count_;
+        return;
+    }
+    while ( ! try_acquire_( active_ctx) ) {
         // store this fiber in order to be notified later
         detail::spinlock_lock lk{ wait_queue_splk_ };
-        if ( active_ctx == owner_) {
-            ++count_;
-            return;
-        }
-        if ( nullptr == owner_) {
-            owner_ = active_ctx;
-            count_ = 1;
-            return;
+        if ( enlist_waiter_() ) {
+            wait_queue_.suspend_and_wait( lk, active_ctx);
         }
-
-        wait_queue_.suspend_and_wait( lk, active_ctx);
     }
+    count_ = 1;
 }
 
 bool
-recursive_mutex::try_lock() noexcept { 
+recursive_mutex::try_lock() noexcept {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk{ wait_queue_splk_ };
-    if ( nullptr == owner_) {
-        owner_ = active_ctx;
-        count_ = 1;
-    } else if ( active_ctx == owner_) {
+    if ( active_ctx == owner_() ) {
         ++count_;
+        return true;
     }
-    lk.unlock();
-    // let other fiber release the lock
-    context::active()->yield();
-    return active_ctx == owner_;
+    if ( try_acquire_( active_ctx) ) {
+        count_ = 1;
+        return true;
+    }
+    return false;
 }
 
 void
 recursive_mutex::unlock() {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( BOOST_UNLIKELY( active_ctx != owner_) ) {
-        throw lock_error(
+    if ( BOOST_UNLIKELY( active_ctx != owner_() ) ) {
+        throw lock_error{
                 std::make_error_code( std::errc::operation_not_permitted),
-                "boost fiber: no  privilege to perform the operation");
+                "boost fiber: no  privilege to perform the operation" };
+    }
+    if ( 0 != --count_) {
+        return;
     }
-    if ( 0 == --count_) {
-        owner_ = nullptr;
-        wait_queue_.notify_one();
+    std::uintptr_t state = reinterpret_cast< std::uintptr_t >( active_ctx);
+    if ( ! state_.compare_exchange_strong( state, 0, std::memory_order_release, std::memory_order_relaxed) ) {
+        release_();
     }
 }
 
@@ -7,12 +7,14 @@
 #include "boost/fiber/scheduler.hpp"
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 
 #include <boost/assert.hpp>
 
 #include "boost/fiber/algo/round_robin.hpp"
 #include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/trace.hpp"
 #include "boost/fiber/exceptions.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -46,17 +48,35 @@ scheduler::release_terminated_() noexcept {
     }
 }
 
+context *
+scheduler::pick_next_() noexcept {
+    context * ctx = handoff_ctx_;
+    if ( nullptr != ctx) {
+        handoff_ctx_ = nullptr;
+        // bounded, so that fibers handing off to each other
+        // do not starve the ready-queue
+        if ( BOOST_FIBERS_HANDOFF_LIMIT > handoffs_) {
+            ++handoffs_;
+            counters_->picked();
+            return ctx;
+        }
+        algo_->awakened( ctx);
+    }
+    handoffs_ = 0;
+    ctx = algo_->pick_next();
+    if ( nullptr != ctx) {
+        counters_->picked();
+    }
+    return ctx;
+}
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
 void
 scheduler::remote_ready2ready_() noexcept {
-    remote_ready_queue_type tmp;
-    detail::spinlock_lock lk{ remote_ready_splk_ };
-    remote_ready_queue_.swap( tmp);
-    lk.unlock();
-    // get context from remote ready-queue
-    while ( ! tmp.empty() ) {
-        context * ctx = & tmp.front();
-        tmp.pop_front();
+    // drain all context' published by remote schedulers
+    // without taking a lock
+    context * ctx = nullptr;
+    while ( nullptr != ( ctx = remote_ready_queue_.pop() ) ) {
         // store context in local queues
         schedule( ctx);
     }
@@ -69,6 +89,21 @@ scheduler::sleep2ready_() noexcept {
     // to ready-queue
     // sleep-queue is sorted (ascending)
     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+    // timer wheel is not sorted, it unlinks each context
+    // which deadline has been reached
+    sleep_queue_.expire( now, [this](context * ctx){
+        // dispatcher context must never be pushed to sleep-queue
+        BOOST_ASSERT( ! ctx->is_context( type::dispatcher_context) );
+        BOOST_ASSERT( main_ctx_ == ctx || ctx->worker_is_linked() );
+        BOOST_ASSERT( ! ctx->ready_is_linked() );
+        BOOST_ASSERT( ! ctx->terminated_is_linked() );
+        // reset sleep-tp
+        ctx->tp_ = (std::chrono::steady_clock::time_point::max)();
+        counters_->slept( -1);
+        ctx->sleep_waker_.wake();
+    });
+#else
     sleep_queue_type::iterator e = sleep_queue_.end();
     for ( sleep_queue_type::iterator i = sleep_queue_.begin(); i != e;) {
         context * ctx = & ( * i);
@@ -85,6 +120,7 @@ scheduler::sleep2ready_() noexcept {
         if ( ctx->tp_ <= now) {
             // remove context from sleep-queue
             i = sleep_queue_.erase( i);
+            counters_->slept( -1);
             // reset sleep-tp
             ctx->tp_ = (std::chrono::steady_clock::time_point::max)();
             ctx->sleep_waker_.wake();
@@ -92,10 +128,12 @@ scheduler::sleep2ready_() noexcept {
             break; // first context with now < deadline
         }
     }
+#endif
 }
 
 scheduler::scheduler() noexcept :
-    algo_{ new algo::round_robin() } {
+    algo_{ new algo::round_robin() },
+    counters_{ std::make_shared< detail::scheduler_counters >() } {
 }
 
 scheduler::~scheduler() {
@@ -141,7 +179,7 @@ scheduler::dispatch() noexcept {
         // must be called after remote_ready2ready_()
         sleep2ready_();
         // get next ready context
-        context * ctx = algo_->pick_next();
+        context * ctx = pick_next_();
         if ( nullptr != ctx) {
             BOOST_ASSERT( ctx->is_resumable() );
             BOOST_ASSERT( ! ctx->ready_is_linked() );
@@ -160,12 +198,18 @@ scheduler::dispatch() noexcept {
             std::chrono::steady_clock::time_point suspend_time =
                     (std::chrono::steady_clock::time_point::max)();
             // get lowest deadline from sleep-queue
+#if defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+            suspend_time = sleep_queue_.next_deadline();
+#else
             sleep_queue_type::iterator i = sleep_queue_.begin();
             if ( sleep_queue_.end() != i) {
                 suspend_time = i->tp_;
             }
+#endif
             // no ready context, wait till signaled
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             algo_->suspend_until( suspend_time);
+            counters_->suspended( std::chrono::steady_clock::now() - start);
         }
     }
     // release termianted context'
@@ -177,6 +221,7 @@ scheduler::dispatch() noexcept {
 void
 scheduler::schedule( context * ctx) noexcept {
     BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( handoff_ctx_ != ctx);
     BOOST_ASSERT( ! ctx->ready_is_linked() );
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
@@ -187,11 +232,34 @@ scheduler::schedule( context * ctx) noexcept {
     if ( ctx->sleep_is_linked() ) {
         // unlink it from sleep-queue
         ctx->sleep_unlink();
+        counters_->slept( -1);
     }
+    counters_->woken();
     // push new context to ready-queue
     algo_->awakened( ctx);
 }
 
+void
+scheduler::schedule_handoff( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( this == ctx->get_scheduler() );
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
+#endif
+    BOOST_ASSERT( ! ctx->terminated_is_linked() );
+    if ( ctx->sleep_is_linked() ) {
+        ctx->sleep_unlink();
+        counters_->slept( -1);
+    }
+    counters_->woken();
+    // a pending handoff context loses its turn
+    if ( nullptr != handoff_ctx_) {
+        algo_->awakened( handoff_ctx_);
+    }
+    handoff_ctx_ = ctx;
+}
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
 void
 scheduler::schedule_from_remote( context * ctx) noexcept {
@@ -202,14 +270,13 @@ scheduler::schedule_from_remote( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->ready_is_linked() );
     BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
-    // protect for concurrent access
-    detail::spinlock_lock lk{ remote_ready_splk_ };
-    BOOST_ASSERT( ! shutdown_);
     BOOST_ASSERT( nullptr != main_ctx_);
     BOOST_ASSERT( nullptr != dispatcher_ctx_.get() );
     // push new context to remote ready-queue
+    // lock-free, safe against concurrent producers
     ctx->remote_ready_link( remote_ready_queue_);
-    lk.unlock();
+    counters_->remote_woken();
+    BOOST_FIBERS_TRACE( remote_wake, ctx, 0);
     // notify scheduler
     algo_->notify();
 }
@@ -229,6 +296,7 @@ scheduler::terminate( detail::spinlock_lock & lk, context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->sleep_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
     BOOST_ASSERT( ctx->wait_queue_.empty() );
+    BOOST_FIBERS_TRACE( terminate, ctx, 0);
     // store the terminated fiber in the terminated-queue
     // the dispatcher-context will call
     ctx->terminated_link( terminated_queue_);
@@ -237,7 +305,7 @@ scheduler::terminate( detail::spinlock_lock & lk, context * ctx) noexcept {
     // release lock
     lk.unlock();
     // resume another fiber
-    return algo_->pick_next()->suspend_with_cc();
+    return pick_next_()->suspend_with_cc();
 }
 
 void
@@ -252,7 +320,7 @@ scheduler::yield( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->sleep_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
     // resume another fiber
-    algo_->pick_next()->resume( ctx);
+    pick_next_()->resume( ctx);
 }
 
 bool
@@ -270,8 +338,9 @@ scheduler::wait_until( context * ctx,
     ctx->sleep_waker_ = ctx->create_waker();
     ctx->tp_ = sleep_tp;
     ctx->sleep_link( sleep_queue_);
+    counters_->slept( 1);
     // resume another context
-    algo_->pick_next()->resume();
+    pick_next_()->resume();
     // context has been resumed
     // check if deadline has reached
     return std::chrono::steady_clock::now() < sleep_tp;
@@ -295,8 +364,9 @@ scheduler::wait_until( context * ctx,
     ctx->sleep_waker_ = std::move( w);
     ctx->tp_ = sleep_tp;
     ctx->sleep_link( sleep_queue_);
+    counters_->slept( 1);
     // resume another context
-    algo_->pick_next()->resume( lk);
+    pick_next_()->resume( lk);
     // context has been resumed
     // check if deadline has reached
     return std::chrono::steady_clock::now() < sleep_tp;
@@ -305,22 +375,26 @@ scheduler::wait_until( context * ctx,
 void
 scheduler::suspend() noexcept {
     // resume another context
-    algo_->pick_next()->resume();
+    pick_next_()->resume();
 }
 
 void
 scheduler::suspend( detail::spinlock_lock & lk) noexcept {
     // resume another context
-    algo_->pick_next()->resume( lk);
+    pick_next_()->resume( lk);
 }
 
 bool
 scheduler::has_ready_fibers() const noexcept {
-    return algo_->has_ready_fibers();
+    return nullptr != handoff_ctx_ || algo_->has_ready_fibers();
 }
 
 void
 scheduler::set_algo( algo::algorithm::ptr_t algo) noexcept {
+    if ( nullptr != handoff_ctx_) {
+        algo->awakened( handoff_ctx_);
+        handoff_ctx_ = nullptr;
+    }
     // move remaining context in current scheduler to new one
     while ( algo_->has_ready_fibers() ) {
         algo->awakened( algo_->pick_next() );
@@ -354,6 +428,7 @@ scheduler::attach_dispatcher_context( intrusive_ptr< context > ctx) noexcept {
     // the dispatcher-context is resumed and
     // scheduler::dispatch() is executed
     dispatcher_ctx_->scheduler_ = this;
+    counters_->woken();
     algo_->awakened( dispatcher_ctx_.get() );
 }
 
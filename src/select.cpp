@@ -0,0 +1,75 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/select.hpp"
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+channel_op_status
+select_cases( std::size_t & index, select_case ** cases, std::size_t n,
+              std::chrono::steady_clock::time_point const& timeout_time) {
+    context * active_ctx = context::active();
+    // number of cases linked into the wait-queues of their channels
+    std::size_t enlisted = 0;
+    for (;;) {
+        for ( std::size_t i = 0; i < n; ++i) {
+            channel_op_status status = cases[i]->try_();
+            if ( channel_op_status::success == status || channel_op_status::closed == status) {
+                for ( std::size_t j = 0; j < enlisted; ++j) {
+                    cases[j]->delist_( i == j);
+                }
+                index = i;
+                return status;
+            }
+        }
+        for ( std::size_t j = 0; j < enlisted; ++j) {
+            cases[j]->delist_( false);
+        }
+        enlisted = 0;
+        if ( (std::chrono::steady_clock::time_point::max)() != timeout_time &&
+             timeout_time <= std::chrono::steady_clock::now() ) {
+            return channel_op_status::timeout;
+        }
+        // all cases wait with the same epoch
+        waker w = active_ctx->create_waker();
+        bool ready = false;
+        while ( enlisted < n && ! ready) {
+            static_cast< waker & >( cases[enlisted]->hook) = w;
+            ready = cases[enlisted++]->enlist_();
+        }
+        if ( ready) {
+            // a channel became ready while the cases were enlisted
+            if ( w.cancel() ) {
+                continue;
+            }
+            // a channel has already woken (scheduled) this fiber
+            active_ctx->suspend();
+        } else if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+            active_ctx->suspend();
+        } else {
+            // wait_until() releases the lock after the fiber has been suspended;
+            // the channels have been locked while enlisting, so a local one suffices
+            detail::spinlock splk;
+            detail::spinlock_lock lk{ splk };
+            active_ctx->wait_until( timeout_time, lk, waker{ w });
+        }
+    }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,141 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/shared_mutex.hpp"
+
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+std::size_t
+shared_mutex::wake_readers_() noexcept {
+    BOOST_ASSERT( 0 != ( state_.load( std::memory_order_relaxed) & readers_waiting_bit) );
+    // the readers are counted before they are resumed, a resumed reader
+    // might release the mutex at once; writer_bit keeps out other fibers
+    std::size_t count = readers_queue_.size();
+    state_.fetch_add( count * reader_unit, std::memory_order_relaxed);
+    std::size_t resumed = readers_queue_.notify_all();
+    std::size_t delta = ( count - resumed) * reader_unit + writer_bit + readers_waiting_bit;
+    return state_.fetch_sub( delta, std::memory_order_release) - delta;
+}
+
+void
+shared_mutex::lock() {
+    if ( try_lock() ) {
+        return;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    std::size_t state = state_.load( std::memory_order_relaxed);
+    while ( true) {
+        if ( 0 == ( state & writer_bit) && 0 == readers_( state) ) {
+            std::size_t desired = state | writer_bit;
+            if ( writers_queue_.empty() ) {
+                desired &= ~writers_waiting_bit;
+            }
+            if ( state_.compare_exchange_weak( state, desired,
+                                               std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return;
+            }
+        } else if ( state_.compare_exchange_weak( state, state | writers_waiting_bit,
+                                                  std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            writers_queue_.suspend_and_wait( lk, active_ctx);
+            lk.lock();
+            state = state_.load( std::memory_order_relaxed);
+        }
+    }
+}
+
+bool
+shared_mutex::try_lock() noexcept {
+    std::size_t state = state_.load( std::memory_order_relaxed);
+    while ( 0 == ( state & writer_bit) && 0 == readers_( state) ) {
+        if ( state_.compare_exchange_weak( state, state | writer_bit,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+shared_mutex::unlock() noexcept {
+    std::size_t state = writer_bit;
+    if ( state_.compare_exchange_strong( state, 0, std::memory_order_release, std::memory_order_relaxed) ) {
+        return;
+    }
+    BOOST_ASSERT( 0 != ( state & writer_bit) );
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    state = state_.load( std::memory_order_relaxed);
+    if ( 0 != ( state & readers_waiting_bit) ) {
+        state = wake_readers_();
+    } else {
+        state = state_.fetch_sub( writer_bit, std::memory_order_release) - writer_bit;
+    }
+    if ( 0 == readers_( state) && 0 != ( state & writers_waiting_bit) ) {
+        writers_queue_.notify_one();
+    }
+}
+
+void
+shared_mutex::lock_shared() {
+    if ( try_lock_shared() ) {
+        return;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    std::size_t state = state_.load( std::memory_order_relaxed);
+    while ( true) {
+        if ( 0 == ( state & ( writer_bit | writers_waiting_bit) ) ) {
+            if ( state_.compare_exchange_weak( state, state + reader_unit,
+                                               std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return;
+            }
+        } else if ( state_.compare_exchange_weak( state, state | readers_waiting_bit,
+                                                  std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            // counted as reader by the batch release in unlock()
+            readers_queue_.suspend_and_wait( lk, active_ctx);
+            return;
+        }
+    }
+}
+
+bool
+shared_mutex::try_lock_shared() noexcept {
+    std::size_t state = state_.load( std::memory_order_relaxed);
+    while ( 0 == ( state & ( writer_bit | writers_waiting_bit) ) ) {
+        if ( state_.compare_exchange_weak( state, state + reader_unit,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+shared_mutex::unlock_shared() noexcept {
+    std::size_t state = state_.fetch_sub( reader_unit, std::memory_order_release);
+    BOOST_ASSERT( 0 < readers_( state) );
+    if ( 1 != readers_( state) || 0 == ( state & writers_waiting_bit) ) {
+        return;
+    }
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    state = state_.load( std::memory_order_relaxed);
+    if ( 0 == readers_( state) && 0 == ( state & writer_bit) ) {
+        writers_queue_.notify_one();
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,135 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/stack_cache.hpp"
+
+#include <cstdint>
+#include <new>
+
+#include <boost/assert.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+// set by the cache owned by the scheduler of this thread
+thread_local stack_cache * current_cache{ nullptr };
+
+}
+
+stack_cache *
+stack_cache::current() noexcept {
+    return current_cache;
+}
+
+stack_cache::stack_cache() noexcept :
+    low_watermark_{ BOOST_FIBERS_STACK_CACHE_LOW_WATERMARK },
+    high_watermark_{ BOOST_FIBERS_STACK_CACHE_HIGH_WATERMARK } {
+    BOOST_ASSERT( low_watermark_ <= high_watermark_);
+    BOOST_ASSERT( nullptr == current_cache);
+    current_cache = this;
+}
+
+stack_cache::~stack_cache() {
+    BOOST_ASSERT( this == current_cache);
+    // stacks released after this point are deallocated directly
+    current_cache = nullptr;
+    clear();
+}
+
+void
+stack_cache::release_( node * n) noexcept {
+    // copy out, the node lives inside the stack
+    boost::context::stack_context sctx = n->sctx;
+    deallocate_fn fn = n->deallocate;
+    fn( sctx);
+    ++stats_.released;
+}
+
+void
+stack_cache::trim_( std::size_t count) noexcept {
+    // keep the most recently used stacks (cache hot)
+    node ** link = & head_;
+    for ( std::size_t i = 0; i < count && nullptr != * link; ++i) {
+        link = & ( * link)->next;
+    }
+    node * n = * link;
+    * link = nullptr;
+    while ( nullptr != n) {
+        node * next = n->next;
+        release_( n);
+        --stats_.size;
+        n = next;
+    }
+}
+
+void
+stack_cache::set_watermarks( std::size_t low, std::size_t high) noexcept {
+    BOOST_ASSERT( low <= high);
+    low_watermark_ = low;
+    high_watermark_ = high;
+    if ( high_watermark_ < stats_.size) {
+        trim_( low_watermark_);
+    }
+}
+
+void
+stack_cache::clear() noexcept {
+    trim_( 0);
+    BOOST_ASSERT( nullptr == head_);
+    BOOST_ASSERT( 0 == stats_.size);
+}
+
+bool
+stack_cache::pop( deallocate_fn fn, std::size_t size, boost::context::stack_context & sctx) noexcept {
+    for ( node ** link = & head_; nullptr != * link; link = & ( * link)->next) {
+        node * n = * link;
+        if ( fn == n->deallocate && size == n->size) {
+            * link = n->next;
+            sctx = n->sctx;
+            --stats_.size;
+            ++stats_.hits;
+            return true;
+        }
+    }
+    ++stats_.misses;
+    return false;
+}
+
+bool
+stack_cache::push( deallocate_fn fn, std::size_t size, boost::context::stack_context const& sctx) noexcept {
+    if ( 0 == high_watermark_ || sctx.size < sizeof( node) ) {
+        return false;
+    }
+    if ( high_watermark_ <= stats_.size) {
+        trim_( low_watermark_);
+        if ( high_watermark_ <= stats_.size) {
+            return false;
+        }
+    }
+    // store control structure on top of the unused stack
+    void * storage = reinterpret_cast< void * >(
+            ( reinterpret_cast< std::uintptr_t >( sctx.sp) - static_cast< std::uintptr_t >( sizeof( node) ) )
+            & ~ static_cast< std::uintptr_t >( 0xff) );
+    node * n = new ( storage) node{ sctx, fn, size, head_ };
+    head_ = n;
+    ++stats_.recycled;
+    if ( stats_.peak < ++stats_.size) {
+        stats_.peak = stats_.size;
+    }
+    return true;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -19,17 +19,54 @@
 namespace boost {
 namespace fibers {
 
+bool
+timed_mutex::try_acquire_( context * active_ctx) noexcept {
+    // a single CAS if the mutex is not contended
+    std::uintptr_t state = 0;
+    do {
+        // waiters_bit is kept
+        if ( state_.compare_exchange_weak( state, reinterpret_cast< std::uintptr_t >( active_ctx) | state,
+                                           std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    } while ( 0 == ( state & ~waiters_bit) );
+    return false;
+}
+
+bool
+timed_mutex::enlist_waiter_() noexcept {
+    std::uintptr_t state = state_.load( std::memory_order_relaxed);
+    do {
+        if ( 0 == ( state & ~waiters_bit) ) {
+            return false;
+        }
+    } while ( ! state_.compare_exchange_weak( state, state | waiters_bit,
+                                              std::memory_order_relaxed, std::memory_order_relaxed) );
+    return true;
+}
+
+void
+timed_mutex::release_() noexcept {
+    // waiters_bit is set, unlock() could not simply clear the state
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    wait_queue_.notify_one();
+    state_.store( wait_queue_.empty() ? 0 : waiters_bit, std::memory_order_release);
+}
+
 bool
 timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
+    context * active_ctx = context::active();
     while ( true) {
+        if ( try_acquire_( active_ctx) ) {
+            return true;
+        }
         if ( std::chrono::steady_clock::now() > timeout_time) {
             return false;
         }
-        context * active_ctx = context::active();
+        // store this fiber in order to be notified later
         detail::spinlock_lock lk{ wait_queue_splk_ };
-        if ( nullptr == owner_) {
-            owner_ = active_ctx;
-            return true;
+        if ( ! enlist_waiter_() ) {
+            continue;
         }
         if ( ! wait_queue_.suspend_and_wait_until( lk, active_ctx, timeout_time)) {
             return false;
@@ -39,53 +76,47 @@ timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeo
 
 void
 timed_mutex::lock() {
-    while ( true) {
-        context * active_ctx = context::active();
-        // store this fiber in order to be notified later
-        detail::spinlock_lock lk{ wait_queue_splk_ };
-        if ( BOOST_UNLIKELY( active_ctx == owner_) ) {
+    context * active_ctx = context::active();
+    while ( ! try_acquire_( active_ctx) ) {
+        if ( BOOST_UNLIKELY( active_ctx == owner_() ) ) {
             throw lock_error{
                     std::make_error_code( std::errc::resource_deadlock_would_occur),
                     "boost fiber: a deadlock is detected" };
         }
-        if ( nullptr == owner_) {
-            owner_ = active_ctx;
-            return;
+        // store this fiber in order to be notified later
+        detail::spinlock_lock lk{ wait_queue_splk_ };
+        if ( enlist_waiter_() ) {
+            wait_queue_.suspend_and_wait( lk, active_ctx);
         }
-        wait_queue_.suspend_and_wait( lk, active_ctx);
     }
 }
 
 bool
 timed_mutex::try_lock() {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk{ wait_queue_splk_ };
-    if ( BOOST_UNLIKELY( active_ctx == owner_) ) {
+    if ( try_acquire_( active_ctx) ) {
+        return true;
+    }
+    if ( BOOST_UNLIKELY( active_ctx == owner_() ) ) {
         throw lock_error{
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected" };
     }
-    if ( nullptr == owner_) {
-        owner_ = active_ctx;
-    }
-    lk.unlock();
-    // let other fiber release the lock
-    active_ctx->yield();
-    return active_ctx == owner_;
+    return false;
 }
 
 void
 timed_mutex::unlock() {
     context * active_ctx = context::active();
-    detail::spinlock_lock lk{ wait_queue_splk_ };
-    if ( BOOST_UNLIKELY( active_ctx != owner_) ) {
+    if ( BOOST_UNLIKELY( active_ctx != owner_() ) ) {
         throw lock_error{
                 std::make_error_code( std::errc::operation_not_permitted),
                 "boost fiber: no  privilege to perform the operation" };
     }
-    owner_ = nullptr;
-
-    wait_queue_.notify_one();
+    std::uintptr_t state = reinterpret_cast< std::uintptr_t >( active_ctx);
+    if ( ! state_.compare_exchange_strong( state, 0, std::memory_order_release, std::memory_order_relaxed) ) {
+        release_();
+    }
 }
 
 }}
@@ -0,0 +1,270 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/trace.hpp"
+
+#include "boost/fiber/detail/trace.hpp"
+
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+# include <algorithm>
+# include <cstdint>
+# include <limits>
+# include <memory>
+# include <mutex>
+# include <vector>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+namespace detail {
+
+namespace {
+
+struct trace_registry {
+    std::mutex                                      mtx{};
+    // buffers are kept after their thread has terminated,
+    // so that the events can be dumped later
+    std::vector< std::unique_ptr< trace_buffer > >  buffers{};
+    // buffers of terminated threads, reused by threads started later
+    // the number of buffers is bounded by the number of threads
+    // running at the same time
+    std::vector< trace_buffer * >                   free{};
+};
+
+trace_registry & registry() {
+    static trace_registry r;
+    return r;
+}
+
+// trivially destructible, valid while thread_local objects
+// of the thread are destroyed
+thread_local trace_buffer * current_buffer = nullptr;
+thread_local bool buffer_returned = false;
+
+// returns the buffer of the thread to the registry at thread exit
+struct trace_owner {
+    trace_buffer    *   buffer{ nullptr };
+
+    ~trace_owner() {
+        if ( nullptr != buffer) {
+            // ends the last slice of this thread
+            buffer->push( trace_kind::exit, nullptr, 0);
+            current_buffer = nullptr;
+            buffer_returned = true;
+            trace_registry & r = registry();
+            std::unique_lock< std::mutex > lk{ r.mtx };
+            r.free.push_back( buffer);
+        }
+    }
+};
+
+thread_local trace_owner owner;
+
+trace_buffer * acquire_buffer() {
+    trace_registry & r = registry();
+    std::unique_lock< std::mutex > lk{ r.mtx };
+    if ( ! r.free.empty() ) {
+        trace_buffer * b = r.free.back();
+        r.free.pop_back();
+        return b;
+    }
+    r.buffers.emplace_back( new trace_buffer{ static_cast< std::uint32_t >( r.buffers.size() + 1) } );
+    return r.buffers.back().get();
+}
+
+void write_ts( std::ostream & os, std::int64_t ns) {
+    // trace-event timestamps are microseconds
+    os << ns / 1000 << '.';
+    std::int64_t frac = ns % 1000;
+    if ( 100 > frac) {
+        os << '0';
+    }
+    if ( 10 > frac) {
+        os << '0';
+    }
+    os << frac;
+}
+
+void write_name( std::ostream & os, void const* ctx, std::uint32_t flags) {
+    if ( 0 != ( flags & trace_main_context) ) {
+        os << "main";
+    } else if ( 0 != ( flags & trace_dispatcher_context) ) {
+        os << "dispatcher";
+    } else {
+        os << "fiber " << ctx;
+    }
+}
+
+class json_writer {
+private:
+    std::ostream    &   os_;
+    std::int64_t        base_;
+    bool                first_{ true };
+
+    void begin_( char const* ph, std::uint32_t tid, std::int64_t ts) {
+        os_ << ( first_ ? "\n" : ",\n");
+        first_ = false;
+        os_ << "{\"ph\":\"" << ph << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+        write_ts( os_, ts - base_);
+    }
+
+public:
+    json_writer( std::ostream & os, std::int64_t base) :
+        os_( os),
+        base_{ base } {
+    }
+
+    void thread_name( std::uint32_t tid) {
+        os_ << ( first_ ? "\n" : ",\n");
+        first_ = false;
+        os_ << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " << tid << "\"}}";
+    }
+
+    void slice( std::uint32_t tid, void const* ctx, std::uint32_t flags, std::int64_t start, std::int64_t end) {
+        begin_( "X", tid, start);
+        os_ << ",\"dur\":";
+        write_ts( os_, end - start);
+        os_ << ",\"name\":\"";
+        write_name( os_, ctx, flags);
+        os_ << "\"}";
+    }
+
+    void instant( std::uint32_t tid, char const* name, std::int64_t ts, void const* ctx) {
+        begin_( "i", tid, ts);
+        os_ << ",\"s\":\"t\",\"name\":\"" << name << "\",\"args\":{\"fiber\":\"" << ctx << "\"}}";
+    }
+
+    void steal( std::uint32_t tid, std::int64_t ts, std::uint32_t count) {
+        begin_( "i", tid, ts);
+        os_ << ",\"s\":\"t\",\"name\":\"steal\",\"args\":{\"count\":" << count << "}}";
+    }
+};
+
+}
+
+void
+trace( trace_kind kind, void const* ctx, std::uint32_t arg) noexcept {
+    if ( BOOST_UNLIKELY( nullptr == current_buffer) ) {
+        if ( buffer_returned) {
+            // thread_local objects of this thread are being destroyed
+            return;
+        }
+        try {
+            current_buffer = acquire_buffer();
+        } catch (...) {
+            return;
+        }
+        owner.buffer = current_buffer;
+    }
+    current_buffer->push( kind, ctx, arg);
+}
+
+}
+#endif
+
+namespace trace {
+
+bool enabled() noexcept {
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void dump_chrome_json( std::ostream & os) {
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+    using namespace boost::fibers::detail;
+    trace_registry & r = registry();
+    std::unique_lock< std::mutex > lk{ r.mtx };
+    constexpr std::uint64_t mask = trace_buffer::capacity - 1;
+    // timestamps relative to the oldest recorded event
+    std::int64_t base = (std::numeric_limits< std::int64_t >::max)();
+    for ( auto const& b : r.buffers) {
+        std::uint64_t head = b->head.load( std::memory_order_acquire);
+        if ( 0 < head) {
+            std::uint64_t first = head - (std::min)( head, std::uint64_t{ trace_buffer::capacity });
+            base = (std::min)( base, b->records[first & mask].ts);
+        }
+    }
+    json_writer w{ os, base };
+    for ( auto const& b : r.buffers) {
+        std::uint64_t head = b->head.load( std::memory_order_acquire);
+        if ( 0 == head) {
+            continue;
+        }
+        w.thread_name( b->tid);
+        // a fiber runs from its resume to the next resume on this thread
+        bool running = false;
+        void const* ctx = nullptr;
+        std::uint32_t flags = 0;
+        std::int64_t start = 0, last = 0;
+        for ( std::uint64_t i = head - (std::min)( head, std::uint64_t{ trace_buffer::capacity }); i != head; ++i) {
+            trace_record const& rec = b->records[i & mask];
+            last = rec.ts;
+            switch ( rec.kind) {
+            case trace_kind::resume:
+                if ( running) {
+                    w.slice( b->tid, ctx, flags, start, rec.ts);
+                }
+                running = true;
+                ctx = rec.ctx;
+                flags = rec.arg;
+                start = rec.ts;
+                break;
+            case trace_kind::suspend:
+                w.instant( b->tid, "suspend", rec.ts, rec.ctx);
+                break;
+            case trace_kind::terminate:
+                w.instant( b->tid, "terminate", rec.ts, rec.ctx);
+                break;
+            case trace_kind::steal:
+                w.steal( b->tid, rec.ts, rec.arg);
+                break;
+            case trace_kind::remote_wake:
+                w.instant( b->tid, "remote wake", rec.ts, rec.ctx);
+                break;
+            case trace_kind::exit:
+                if ( running) {
+                    w.slice( b->tid, ctx, flags, start, rec.ts);
+                }
+                running = false;
+                break;
+            }
+        }
+        if ( running && start < last) {
+            w.slice( b->tid, ctx, flags, start, last);
+        }
+    }
+#endif
+    os << "\n]}\n";
+}
+
+void clear() noexcept {
+#if defined(BOOST_FIBERS_ENABLE_TRACE)
+    detail::trace_registry & r = detail::registry();
+    std::unique_lock< std::mutex > lk{ r.mtx };
+    for ( auto const& b : r.buffers) {
+        b->head.store( 0, std::memory_order_release);
+    }
+#endif
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
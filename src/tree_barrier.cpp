@@ -0,0 +1,110 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/tree_barrier.hpp"
+
+#include <cstdint>
+#include <system_error>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+tree_barrier::tree_barrier( std::size_t threads, std::size_t fibers_per_thread, std::size_t fan_in) :
+    threads_{ threads } {
+    if ( BOOST_UNLIKELY( 0 == threads || 0 == fibers_per_thread || 2 > fan_in) ) {
+        throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: invalid tree_barrier arguments" };
+    }
+    std::size_t size = threads;
+    for ( std::size_t level = threads; 1 < level; ) {
+        level = ( level + fan_in - 1) / fan_in;
+        size += level;
+    }
+    nodes_.reset( new node[size]);
+    // the leaves come first, followed by the inner nodes level by level
+    for ( std::size_t i = 0; i < threads; ++i) {
+        nodes_[i].initial = fibers_per_thread;
+    }
+    std::size_t first = 0;
+    for ( std::size_t level = threads; 1 < level; ) {
+        std::size_t next = first + level;
+        for ( std::size_t i = 0; i < level; ++i) {
+            node & parent = nodes_[next + i / fan_in];
+            nodes_[first + i].parent = & parent;
+            ++parent.initial;
+        }
+        first = next;
+        level = ( level + fan_in - 1) / fan_in;
+    }
+    for ( std::size_t i = 0; i < size; ++i) {
+        nodes_[i].count.store( nodes_[i].initial, std::memory_order_relaxed);
+    }
+}
+
+tree_barrier::node *
+tree_barrier::leaf_( scheduler * sched) {
+    // the schedulers are spread over the leaves by their address
+    std::size_t idx = reinterpret_cast< std::uintptr_t >( sched) / alignof( std::max_align_t);
+    for ( std::size_t i = 0; i < threads_; ++i) {
+        node * n = & nodes_[( idx + i) % threads_];
+        scheduler * owner = n->owner.load( std::memory_order_relaxed);
+        if ( nullptr == owner &&
+             n->owner.compare_exchange_strong( owner, sched, std::memory_order_relaxed) ) {
+            return n;
+        }
+        if ( sched == owner) {
+            return n;
+        }
+    }
+    throw fiber_error{ std::make_error_code( std::errc::operation_not_permitted),
+                       "boost fiber: more threads than expected wait on tree_barrier" };
+}
+
+bool
+tree_barrier::arrive_( node * n, std::size_t phase, context * active_ctx) {
+    if ( 1 != n->count.fetch_sub( 1, std::memory_order_acq_rel) ) {
+        detail::spinlock_lock lk{ n->splk };
+        while ( phase == n->phase) {
+            n->queue.suspend_and_wait( lk, active_ctx);
+            lk.lock();
+        }
+        return false;
+    }
+    // last arrival; nobody arrives at n again before n is released
+    n->count.store( n->initial, std::memory_order_relaxed);
+    bool last = nullptr == n->parent || arrive_( n->parent, phase, active_ctx);
+    // released top-down while returning; at a leaf only fibers
+    // of the same scheduler are waiting
+    detail::spinlock_lock lk{ n->splk };
+    ++n->phase;
+    n->queue.notify_all();
+    return last;
+}
+
+bool
+tree_barrier::wait() {
+    context * active_ctx = context::active();
+    node * leaf = leaf_( active_ctx->get_scheduler() );
+    std::size_t phase;
+    {
+        detail::spinlock_lock lk{ leaf->splk };
+        phase = leaf->phase;
+    }
+    return arrive_( leaf, phase, active_ctx);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
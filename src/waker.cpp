@@ -13,6 +13,22 @@ waker::wake() const noexcept {
     return ctx_->wake(epoch_);
 }
 
+bool
+waker::handoff() const noexcept {
+    BOOST_ASSERT(epoch_ > 0);
+    BOOST_ASSERT(ctx_ != nullptr);
+
+    return ctx_->handoff(epoch_);
+}
+
+bool
+waker::cancel() const noexcept {
+    BOOST_ASSERT(epoch_ > 0);
+    BOOST_ASSERT(ctx_ != nullptr);
+
+    return ctx_->cancel_wake(epoch_);
+}
+
 void
 wait_queue::suspend_and_wait( detail::spinlock_lock & lk, context * active_ctx) {
     waker_with_hook w{ active_ctx->create_waker() };
@@ -37,28 +53,69 @@ wait_queue::suspend_and_wait_until( detail::spinlock_lock & lk,
             slist_.remove( w);
         }
         lk.unlock();
-        return false;
+        // a notification racing with the timeout is not lost
+        return w.notified_;
     }
     return true;
 }
 
-void
+context *
 wait_queue::notify_one() {
     while ( ! slist_.empty() ) {
-        waker & w = slist_.front();
+        waker_with_hook & w = slist_.front();
         slist_.pop_front();
+        // w might be gone as soon as its fiber has been resumed
+        context * ctx = w.ctx_;
+        w.notified_ = true;
         if ( w.wake()) {
-            break;
+            return ctx;
         }
+        // the fiber timed out, it reads notified_ after the lock is released
+        w.notified_ = false;
     }
+    return nullptr;
 }
 
 void
+wait_queue::notify_one_handoff() {
+    while ( ! slist_.empty() ) {
+        waker_with_hook & w = slist_.front();
+        slist_.pop_front();
+        w.notified_ = true;
+        if ( w.handoff()) {
+            break;
+        }
+        w.notified_ = false;
+    }
+}
+
+std::size_t
 wait_queue::notify_all() {
+    std::size_t count = 0;
     while ( ! slist_.empty() ) {
-        waker & w = slist_.front();
+        waker_with_hook & w = slist_.front();
         slist_.pop_front();
-        w.wake();
+        w.notified_ = true;
+        if ( w.wake()) {
+            ++count;
+        } else {
+            w.notified_ = false;
+        }
+    }
+    return count;
+}
+
+void
+wait_queue::enqueue( waker_with_hook & w) {
+    BOOST_ASSERT( ! w.is_linked() );
+    w.notified_ = false;
+    slist_.push_back( w);
+}
+
+void
+wait_queue::remove( waker_with_hook & w) {
+    if ( w.is_linked() ) {
+        slist_.remove( w);
     }
 }
 
@@ -67,5 +124,10 @@ wait_queue::empty() const {
     return slist_.empty();
 }
 
+std::size_t
+wait_queue::size() const {
+    return slist_.size();
+}
+
 }
 }
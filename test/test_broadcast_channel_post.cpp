@@ -0,0 +1,240 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::broadcast_channel< int > channel_t;
+
+void test_invalid_capacity() {
+    bool thrown = false;
+    try {
+        channel_t c{ 3 };
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_broadcast() {
+    channel_t c{ 4 };
+    channel_t::subscriber s1{ c }, s2{ c };
+    BOOST_CHECK_EQUAL( 2u, c.subscribers() );
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == s1.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK_EQUAL( 2, s1.value_pop() );
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == s1.try_pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == s2.try_pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK_EQUAL( 2, s2.value_pop() );
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == s2.try_pop( v) );
+}
+
+void test_late_subscriber() {
+    channel_t c{ 4 };
+    // no subscriber, the message is discarded
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    channel_t::subscriber s1{ c };
+    c.push( 2);
+    channel_t::subscriber s2{ c };
+    c.push( 3);
+    BOOST_CHECK_EQUAL( 2, s1.value_pop() );
+    BOOST_CHECK_EQUAL( 3, s1.value_pop() );
+    BOOST_CHECK_EQUAL( 3, s2.value_pop() );
+}
+
+void test_stored_once() {
+    std::shared_ptr< int > p = std::make_shared< int >( 1);
+    boost::fibers::broadcast_channel< std::shared_ptr< int > > c{ 4 };
+    {
+        boost::fibers::broadcast_channel< std::shared_ptr< int > >::subscriber s1{ c }, s2{ c }, s3{ c };
+        c.push( p);
+        BOOST_CHECK_EQUAL( 2, p.use_count() );
+        s1.value_pop();
+        s2.value_pop();
+        BOOST_CHECK_EQUAL( 2, p.use_count() );
+        // released by the last subscriber
+        s3.value_pop();
+        BOOST_CHECK_EQUAL( 1, p.use_count() );
+        c.push( p);
+        BOOST_CHECK_EQUAL( 2, p.use_count() );
+    }
+    // released by unsubscribing
+    BOOST_CHECK_EQUAL( 1, p.use_count() );
+}
+
+void test_block() {
+    channel_t c{ 2 };
+    channel_t::subscriber s1{ c }, s2{ c };
+    c.push( 1);
+    c.push( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 3) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.push_wait_for( 3, std::chrono::milliseconds( 10) ) );
+    // s2 still holds message 1
+    s1.value_pop();
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 3) );
+    s2.value_pop();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 3) );
+}
+
+void test_block_wait() {
+    channel_t c{ 2 };
+    channel_t::subscriber s{ c };
+    int sum = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c](){
+        for ( int i = 1; i <= 10; ++i) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( i) );
+        }
+        c.close();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&s,&sum](){
+        int v = 0;
+        while ( boost::fibers::channel_op_status::success == s.pop( v) ) {
+            sum += v;
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 55, sum);
+}
+
+void test_drop_oldest() {
+    channel_t c{ 2, boost::fibers::overflow_policy::drop_oldest };
+    channel_t::subscriber s1{ c }, s2{ c };
+    c.push( 1);
+    BOOST_CHECK_EQUAL( 1, s1.value_pop() );
+    c.push( 2);
+    c.push( 3);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 4) );
+    BOOST_CHECK_EQUAL( 3, s1.value_pop() );
+    BOOST_CHECK_EQUAL( 1u, s1.dropped() );
+    BOOST_CHECK_EQUAL( 3, s2.value_pop() );
+    BOOST_CHECK_EQUAL( 2u, s2.dropped() );
+    BOOST_CHECK_EQUAL( 4, s1.value_pop() );
+    BOOST_CHECK_EQUAL( 4, s2.value_pop() );
+}
+
+void test_disconnect() {
+    channel_t c{ 2, boost::fibers::overflow_policy::disconnect };
+    channel_t::subscriber s1{ c }, s2{ c };
+    c.push( 1);
+    c.push( 2);
+    BOOST_CHECK_EQUAL( 1, s1.value_pop() );
+    // s2 is the slowest subscriber
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 3) );
+    BOOST_CHECK( s2.is_disconnected() );
+    BOOST_CHECK( ! s1.is_disconnected() );
+    BOOST_CHECK_EQUAL( 1u, c.subscribers() );
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == s2.try_pop( v) );
+    BOOST_CHECK_EQUAL( 2, s1.value_pop() );
+    BOOST_CHECK_EQUAL( 3, s1.value_pop() );
+}
+
+void test_closed() {
+    channel_t c{ 4 };
+    channel_t::subscriber s{ c };
+    int v = 0;
+    c.push( 1);
+    c.close();
+    BOOST_CHECK( c.is_closed() );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push( 2) );
+    // messages pushed before close() are delivered
+    BOOST_CHECK( boost::fibers::channel_op_status::success == s.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == s.pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == s.try_pop( v) );
+    bool thrown = false;
+    try {
+        s.value_pop();
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_pop_wait_for_timeout() {
+    channel_t c{ 4 };
+    channel_t::subscriber s{ c };
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == s.pop_wait_for( v, std::chrono::milliseconds( 10) ) );
+}
+
+void test_rangefor() {
+    boost::fibers::broadcast_channel< std::string > c{ 64 };
+    boost::fibers::broadcast_channel< std::string >::subscriber s{ c };
+    std::vector< std::string > vec;
+    for ( int i = 0; i < 40; ++i) {
+        c.push( std::to_string( i) );
+    }
+    c.close();
+    for ( std::string & str : s) {
+        vec.push_back( str);
+    }
+    BOOST_REQUIRE_EQUAL( 40u, vec.size() );
+    BOOST_CHECK_EQUAL( "0", vec[0]);
+    BOOST_CHECK_EQUAL( "39", vec[39]);
+}
+
+void test_mt() {
+    // subscribers on other threads
+    constexpr int count = 20000;
+    channel_t c{ 64 };
+    std::vector< std::unique_ptr< channel_t::subscriber > > subs;
+    for ( int t = 0; t < 4; ++t) {
+        subs.emplace_back( new channel_t::subscriber{ c });
+    }
+    long sums[4] = { 0, 0, 0, 0 };
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&subs,&sums,t](){
+                                  int v = 0;
+                                  while ( boost::fibers::channel_op_status::success == subs[t]->pop( v) ) {
+                                      sums[t] += v;
+                                  }
+                              });
+    }
+    for ( int i = 0; i < count; ++i) {
+        c.push( i);
+    }
+    c.close();
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    for ( int t = 0; t < 4; ++t) {
+        BOOST_CHECK_EQUAL( static_cast< long >( count) * ( count - 1) / 2, sums[t]);
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: broadcast-channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_invalid_capacity) );
+    test->add( BOOST_TEST_CASE( & test_broadcast) );
+    test->add( BOOST_TEST_CASE( & test_late_subscriber) );
+    test->add( BOOST_TEST_CASE( & test_stored_once) );
+    test->add( BOOST_TEST_CASE( & test_block) );
+    test->add( BOOST_TEST_CASE( & test_block_wait) );
+    test->add( BOOST_TEST_CASE( & test_drop_oldest) );
+    test->add( BOOST_TEST_CASE( & test_disconnect) );
+    test->add( BOOST_TEST_CASE( & test_closed) );
+    test->add( BOOST_TEST_CASE( & test_pop_wait_for_timeout) );
+    test->add( BOOST_TEST_CASE( & test_rangefor) );
+    test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
@@ -6,9 +6,11 @@
 
 #include <chrono>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include <boost/any.hpp>
 #include <boost/assert.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -45,6 +47,38 @@ struct moveable {
     }
 };
 
+// moving throws if armed
+struct throwing {
+    static bool armed;
+
+    int     value;
+
+    throwing( int v) :
+        value( v) {
+    }
+
+    throwing( throwing const& other) :
+        value( other.value) {
+    }
+
+    throwing( throwing && other) :
+        value( other.value) {
+        if ( armed) {
+            throw std::runtime_error("throwing");
+        }
+    }
+
+    throwing & operator=( throwing && other) {
+        if ( armed) {
+            throw std::runtime_error("throwing");
+        }
+        value = other.value;
+        return * this;
+    }
+};
+
+bool throwing::armed = false;
+
 void test_zero_wm() {
     bool thrown = false;
     try {
@@ -313,6 +347,245 @@ void test_pop_wait_until_timeout() {
     f.join();
 }
 
+void test_push_n() {
+    boost::fibers::buffered_channel< int > c( 16);
+    int v1[] = { 1, 2, 3, 4, 5 }, v2[8];
+    std::size_t count = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_n( v1, 5, count) );
+    BOOST_CHECK_EQUAL( 5u, count);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop_n( v2, 8, count) );
+    BOOST_CHECK_EQUAL( 5u, count);
+    for ( std::size_t i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL( v1[i], v2[i]);
+    }
+}
+
+void test_try_push_n_full() {
+    boost::fibers::buffered_channel< int > c( 4);
+    int v[] = { 1, 2, 3, 4, 5 };
+    std::size_t count = 0;
+    // holds capacity - 1 values
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push_n( v, 5, count) );
+    BOOST_CHECK_EQUAL( 3u, count);
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push_n( v + 3, 2, count) );
+    BOOST_CHECK_EQUAL( 0u, count);
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_push_n( v + 3, 2, count) );
+}
+
+void test_push_n_closed() {
+    boost::fibers::buffered_channel< int > c( 4);
+    std::size_t count = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&count](){
+        int v[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+        BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push_n( v, 8, count) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c](){
+        for ( int i = 0; i < 3; ++i) {
+            BOOST_CHECK_EQUAL( i, c.value_pop() );
+        }
+        c.close();
+    });
+    f1.join();
+    f2.join();
+    // partial success
+    BOOST_CHECK( 3u <= count);
+    BOOST_CHECK( count < 8u);
+}
+
+void test_try_pop_n() {
+    boost::fibers::buffered_channel< int > c( 16);
+    int v[4];
+    std::size_t count = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop_n( v, 4, count) );
+    BOOST_CHECK_EQUAL( 0u, count);
+    c.push( 1);
+    c.push( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop_n( v, 4, count) );
+    BOOST_CHECK_EQUAL( 2u, count);
+    BOOST_CHECK_EQUAL( 1, v[0]);
+    BOOST_CHECK_EQUAL( 2, v[1]);
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_pop_n( v, 4, count) );
+}
+
+void test_pop_n_success() {
+    boost::fibers::buffered_channel< int > c( 16);
+    int v[4];
+    std::size_t count = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&v,&count](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop_n( v, 4, count) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c](){
+        int values[] = { 7, 8 };
+        std::size_t n = 0;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_n( values, 2, n) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK( 1u <= count && count <= 2u);
+    BOOST_CHECK_EQUAL( 7, v[0]);
+}
+
+// neither copyable nor movable, crosses the channel in place
+struct record {
+    int     values[64];
+
+    explicit record( int v) {
+        for ( int & value : values) {
+            value = v;
+        }
+    }
+
+    record( record const&) = delete;
+    record & operator=( record const&) = delete;
+};
+
+void test_reserve_commit() {
+    boost::fibers::buffered_channel< record > c( 4);
+    boost::fibers::buffered_channel< record >::write_slot ws;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.reserve( ws) );
+    BOOST_CHECK( ws);
+    ws.emplace( 7).values[63] = 8;
+    ws.commit();
+    BOOST_CHECK( ! ws);
+    boost::fibers::buffered_channel< record >::read_slot rs;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.borrow( rs) );
+    BOOST_CHECK_EQUAL( 7, rs->values[0]);
+    BOOST_CHECK_EQUAL( 8, rs->values[63]);
+    rs.release();
+    BOOST_CHECK( ! rs);
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_borrow( rs) );
+}
+
+void test_reserve_abandon() {
+    boost::fibers::buffered_channel< int > c( 4);
+    {
+        boost::fibers::buffered_channel< int >::write_slot ws;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.reserve( ws) );
+        ws.emplace( 1);
+    }
+    {
+        boost::fibers::buffered_channel< int >::write_slot ws;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_reserve( ws) );
+    }
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 3) );
+    // abandoned slots are skipped
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 3, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+}
+
+void test_try_reserve_full_closed() {
+    boost::fibers::buffered_channel< int > c( 2);
+    boost::fibers::buffered_channel< int >::write_slot ws1, ws2;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_reserve( ws1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_reserve( ws2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.reserve_wait_for( ws2, std::chrono::milliseconds( 10) ) );
+    ws1.emplace( 1);
+    ws1.commit();
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_reserve( ws2) );
+    // committed values are still delivered
+    boost::fibers::buffered_channel< int >::read_slot rs;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.borrow( rs) );
+    BOOST_CHECK_EQUAL( 1, * rs);
+    rs.release();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.borrow( rs) );
+}
+
+void test_borrow_wait() {
+    // the consumer waits for a slot reserved by a fiber that yields
+    boost::fibers::buffered_channel< std::string > c( 4);
+    std::string value;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c](){
+        boost::fibers::buffered_channel< std::string >::write_slot ws;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.reserve( ws) );
+        boost::this_fiber::yield();
+        ws.emplace( "abc");
+        boost::this_fiber::yield();
+        ws.commit();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c,&value](){
+        boost::fibers::buffered_channel< std::string >::read_slot rs;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.borrow( rs) );
+        value = * rs;
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( "abc", value);
+}
+
+void test_pop_wait_for_reserved() {
+    // a consumer waiting for a slot held by a write_slot times out
+    boost::fibers::buffered_channel< int > c( 4);
+    boost::fibers::buffered_channel< int >::write_slot ws;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.reserve( ws) );
+    int value = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_for( value, std::chrono::milliseconds( 10) ) );
+    BOOST_CHECK( std::chrono::steady_clock::now() - start < std::chrono::milliseconds( 500) );
+    boost::fibers::buffered_channel< int >::read_slot rs;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.borrow_wait_for( rs, std::chrono::milliseconds( 10) ) );
+    ws.emplace( 1);
+    ws.commit();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop_wait_for( value, std::chrono::milliseconds( 10) ) );
+    BOOST_CHECK_EQUAL( 1, value);
+}
+
+void test_push_wait_for_borrowed() {
+    // a producer waiting for a slot held by a read_slot times out
+    boost::fibers::buffered_channel< int > c( 4);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 3) );
+    boost::fibers::buffered_channel< int >::read_slot rs;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.borrow( rs) );
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.push_wait_for( 4, std::chrono::milliseconds( 10) ) );
+    BOOST_CHECK( std::chrono::steady_clock::now() - start < std::chrono::milliseconds( 500) );
+    boost::fibers::buffered_channel< int >::write_slot ws;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.reserve_wait_for( ws, std::chrono::milliseconds( 10) ) );
+    rs.release();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_wait_for( 4, std::chrono::milliseconds( 10) ) );
+    int value = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( value) );
+    BOOST_CHECK_EQUAL( 2, value);
+}
+
+void test_pop_reserved_suspends() {
+    // consumers blocked behind a write_slot are woken when it is
+    // committed, together with the values pushed behind it
+    boost::fibers::buffered_channel< int > c( 8);
+    boost::fibers::buffered_channel< int >::write_slot ws;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.reserve( ws) );
+    std::vector< int > values;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&values](){
+        int value = 0;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( value) );
+        values.push_back( value);
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c,&values](){
+        int value = 0;
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( value) );
+        values.push_back( value);
+    });
+    // the consumers get a chance to block
+    boost::this_fiber::yield();
+    boost::this_fiber::yield();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 2) );
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+    BOOST_CHECK( values.empty() );
+    ws.emplace( 1);
+    ws.commit();
+    f1.join();
+    f2.join();
+    BOOST_REQUIRE_EQUAL( 2u, values.size() );
+    BOOST_CHECK_EQUAL( 1, values[0]);
+    BOOST_CHECK_EQUAL( 2, values[1]);
+}
+
 void test_wm_1() {
     boost::fibers::buffered_channel< int > c( 4);
     std::vector< boost::fibers::fiber::id > ids;
@@ -489,6 +762,92 @@ void test_rangefor() {
     BOOST_CHECK_EQUAL( 12, vec[6]);
 }
 
+void test_rangefor_string() {
+    boost::fibers::buffered_channel< std::string > chan{ 8 };
+    std::vector< std::string > vec;
+    boost::fibers::fiber f1([&chan]{
+        for ( int i = 0; i < 40; ++i) {
+            chan.push( std::to_string( i) );
+        }
+        chan.close();
+    });
+    boost::fibers::fiber f2([&vec,&chan]{
+        for ( std::string const& value : chan) {
+            vec.push_back( value);
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 40u, vec.size() );
+    for ( std::size_t i = 0; i < vec.size(); ++i) {
+        BOOST_CHECK_EQUAL( std::to_string( i), vec[i]);
+    }
+}
+
+void test_rangefor_break() {
+    // values not yet reached by the loop stay in the channel
+    boost::fibers::buffered_channel< int > chan{ 16 };
+    for ( int i = 0; i < 10; ++i) {
+        BOOST_CHECK( boost::fibers::channel_op_status::success == chan.push( i) );
+    }
+    std::vector< int > vec;
+    for ( int value : chan) {
+        vec.push_back( value);
+        if ( 2 == value) {
+            break;
+        }
+    }
+    BOOST_CHECK_EQUAL( 3u, vec.size() );
+    int value = 0;
+    for ( int i = 3; i < 10; ++i) {
+        BOOST_CHECK( boost::fibers::channel_op_status::success == chan.try_pop( value) );
+        BOOST_CHECK_EQUAL( i, value);
+    }
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == chan.try_pop( value) );
+}
+
+void test_push_throwing() {
+    // the slot claimed by a push whose move throws is skipped by the consumers
+    boost::fibers::buffered_channel< throwing > c( 4);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( throwing( 1) ) );
+    throwing::armed = true;
+    BOOST_CHECK_THROW( c.push( throwing( 2) ), std::runtime_error);
+    throwing::armed = false;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( throwing( 3) ) );
+    throwing v( 0);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v.value);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 3, v.value);
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+}
+
+void test_pop_throwing() {
+    // the slot of a value whose move throws in pop() is freed
+    boost::fibers::buffered_channel< throwing > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( throwing( 1) ) );
+    throwing v( 0);
+    throwing::armed = true;
+    BOOST_CHECK_THROW( c.pop( v), std::runtime_error);
+    throwing::armed = false;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( throwing( 2) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 2, v.value);
+}
+
+void test_push_copy_not_list_initialized() {
+    // a copy of the value is pushed, not a vector containing it
+    boost::fibers::buffered_channel< std::vector< boost::any > > c( 4);
+    std::vector< boost::any > const v1( 3);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( v1) );
+    std::vector< boost::any > v2;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v2) );
+    BOOST_CHECK_EQUAL( 3u, v2.size() );
+    BOOST_CHECK_EQUAL( 3u, c.value_pop().size() );
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: buffered_channel test suite");
@@ -522,10 +881,27 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_pop_wait_until_closed) );
      test->add( BOOST_TEST_CASE( & test_pop_wait_until_success) );
      test->add( BOOST_TEST_CASE( & test_pop_wait_until_timeout) );
+     test->add( BOOST_TEST_CASE( & test_push_n) );
+     test->add( BOOST_TEST_CASE( & test_try_push_n_full) );
+     test->add( BOOST_TEST_CASE( & test_push_n_closed) );
+     test->add( BOOST_TEST_CASE( & test_try_pop_n) );
+     test->add( BOOST_TEST_CASE( & test_pop_n_success) );
+     test->add( BOOST_TEST_CASE( & test_reserve_commit) );
+     test->add( BOOST_TEST_CASE( & test_reserve_abandon) );
+     test->add( BOOST_TEST_CASE( & test_try_reserve_full_closed) );
+     test->add( BOOST_TEST_CASE( & test_borrow_wait) );
+     test->add( BOOST_TEST_CASE( & test_pop_wait_for_reserved) );
+     test->add( BOOST_TEST_CASE( & test_push_wait_for_borrowed) );
+     test->add( BOOST_TEST_CASE( & test_pop_reserved_suspends) );
      test->add( BOOST_TEST_CASE( & test_wm_1) );
      test->add( BOOST_TEST_CASE( & test_wm_2) );
      test->add( BOOST_TEST_CASE( & test_moveable) );
+     test->add( BOOST_TEST_CASE( & test_push_throwing) );
+     test->add( BOOST_TEST_CASE( & test_pop_throwing) );
+     test->add( BOOST_TEST_CASE( & test_push_copy_not_list_initialized) );
      test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_rangefor_string) );
+     test->add( BOOST_TEST_CASE( & test_rangefor_break) );
 
     return test;
 }
@@ -0,0 +1,198 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::buffered_channel< std::uint64_t >    channel_type;
+
+constexpr std::uint32_t producer_count = 8;
+constexpr std::uint32_t consumer_count = 8;
+constexpr std::uint32_t value_count = 10000;
+
+// threads running `fibers` fibers each executing fn( id)
+template< typename Fn >
+std::vector< std::thread > launch( std::uint32_t threads, std::uint32_t fibers, Fn fn) {
+    std::vector< std::thread > result;
+    for ( std::uint32_t t = 0; t < threads; ++t) {
+        result.emplace_back( [t,fibers,fn](){
+            std::vector< boost::fibers::fiber > v;
+            for ( std::uint32_t f = 0; f < fibers; ++f) {
+                v.emplace_back( boost::fibers::launch::post, fn, t * fibers + f);
+            }
+            for ( boost::fibers::fiber & f : v) {
+                f.join();
+            }
+        });
+    }
+    return result;
+}
+
+void test_mpmc_order() {
+    // small capacity: the ring wraps around often, producers and consumers block
+    channel_type chan{ 16 };
+    std::unique_ptr< std::atomic< std::uint32_t >[] > received{
+        new std::atomic< std::uint32_t >[producer_count * value_count] };
+    for ( std::uint32_t i = 0; i < producer_count * value_count; ++i) {
+        received[i].store( 0, std::memory_order_relaxed);
+    }
+    std::atomic< std::uint32_t > disorder{ 0 };
+    std::vector< std::thread > consumers = launch( consumer_count / 2, 2,
+        [&chan,&received,&disorder](std::uint32_t){
+            // values of one producer are seen in the order they were pushed
+            std::vector< std::int64_t > last( producer_count, -1);
+            for ( std::uint64_t v : chan) {
+                std::uint32_t producer = static_cast< std::uint32_t >( v >> 32);
+                std::int64_t seq = static_cast< std::int64_t >( v & 0xffffffff);
+                if ( seq <= last[producer]) {
+                    ++disorder;
+                }
+                last[producer] = seq;
+                ++received[producer * value_count + seq];
+            }
+        });
+    std::atomic< std::uint32_t > errors{ 0 };
+    std::vector< std::thread > producers = launch( producer_count / 2, 2,
+        [&chan,&errors](std::uint32_t id){
+            for ( std::uint64_t seq = 0; seq < value_count; ++seq) {
+                if ( boost::fibers::channel_op_status::success !=
+                     chan.push( ( std::uint64_t{ id } << 32) | seq) ) {
+                    ++errors;
+                }
+            }
+        });
+    for ( std::thread & t : producers) {
+        t.join();
+    }
+    chan.close();
+    for ( std::thread & t : consumers) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 0u, errors.load() );
+    BOOST_CHECK_EQUAL( 0u, disorder.load() );
+    std::uint32_t missing = 0;
+    for ( std::uint32_t i = 0; i < producer_count * value_count; ++i) {
+        if ( 1 != received[i].load() ) {
+            ++missing;
+        }
+    }
+    BOOST_CHECK_EQUAL( 0u, missing);
+}
+
+void test_mpmc_batch() {
+    // push_n/pop_n claim several slots at once
+    channel_type chan{ 64 };
+    std::atomic< std::uint64_t > sum{ 0 };
+    std::atomic< std::uint32_t > count{ 0 };
+    std::vector< std::thread > consumers = launch( consumer_count / 2, 2,
+        [&chan,&sum,&count](std::uint32_t){
+            std::uint64_t values[7];
+            std::size_t n = 0;
+            while ( boost::fibers::channel_op_status::success == chan.pop_n( values, 7, n) ) {
+                for ( std::size_t i = 0; i < n; ++i) {
+                    sum += values[i];
+                }
+                count += static_cast< std::uint32_t >( n);
+            }
+        });
+    std::atomic< std::uint32_t > errors{ 0 };
+    std::vector< std::thread > producers = launch( producer_count / 2, 2,
+        [&chan,&errors](std::uint32_t){
+            std::uint64_t values[5];
+            for ( std::uint64_t v = 0; v < value_count; v += 5) {
+                for ( std::uint64_t i = 0; i < 5; ++i) {
+                    values[i] = v + i;
+                }
+                std::size_t n = 0;
+                if ( boost::fibers::channel_op_status::success != chan.push_n( values, 5, n) || 5 != n) {
+                    ++errors;
+                }
+            }
+        });
+    for ( std::thread & t : producers) {
+        t.join();
+    }
+    chan.close();
+    for ( std::thread & t : consumers) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 0u, errors.load() );
+    BOOST_CHECK_EQUAL( producer_count * value_count, count.load() );
+    BOOST_CHECK_EQUAL( std::uint64_t{ producer_count } * value_count * ( value_count - 1) / 2, sum.load() );
+}
+
+void test_close_drain() {
+    // close() while producers are blocked and consumers are running:
+    // every value pushed successfully is popped before pop() reports closed
+    channel_type chan{ 32 };
+    std::atomic< std::uint32_t > pushed{ 0 };
+    std::atomic< std::uint32_t > popped{ 0 };
+    std::atomic< std::uint32_t > errors{ 0 };
+    std::vector< std::thread > producers = launch( producer_count / 2, 2,
+        [&chan,&pushed,&errors](std::uint32_t){
+            for ( std::uint64_t v = 0; ; ++v) {
+                boost::fibers::channel_op_status status = chan.push( v);
+                if ( boost::fibers::channel_op_status::closed == status) {
+                    break;
+                }
+                if ( boost::fibers::channel_op_status::success != status) {
+                    ++errors;
+                }
+                ++pushed;
+            }
+        });
+    std::vector< std::thread > consumers = launch( consumer_count / 2, 2,
+        [&chan,&popped,&errors](std::uint32_t){
+            std::uint64_t v = 0;
+            for ( std::uint32_t i = 0; ; ++i) {
+                boost::fibers::channel_op_status status = chan.pop( v);
+                if ( boost::fibers::channel_op_status::closed == status) {
+                    break;
+                }
+                if ( boost::fibers::channel_op_status::success != status) {
+                    ++errors;
+                }
+                ++popped;
+                if ( 0 == ( i % 64) ) {
+                    // let the ring fill up, producers block
+                    boost::this_fiber::sleep_for( std::chrono::microseconds( 100) );
+                }
+            }
+        });
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50) );
+    chan.close();
+    for ( std::thread & t : producers) {
+        t.join();
+    }
+    for ( std::thread & t : consumers) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 0u, errors.load() );
+    BOOST_CHECK( 0 < pushed.load() );
+    BOOST_CHECK_EQUAL( pushed.load(), popped.load() );
+    std::uint64_t v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == chan.try_pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == chan.try_push( v) );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: multithreaded buffered_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_mpmc_order) );
+    test->add( BOOST_TEST_CASE( & test_mpmc_batch) );
+    test->add( BOOST_TEST_CASE( & test_close_drain) );
+
+    return test;
+}
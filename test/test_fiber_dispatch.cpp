@@ -418,6 +418,52 @@ void test_detach() {
     }
 }
 
+void test_stack_cache() {
+    boost::fibers::stack_cache & cache = boost::fibers::get_stack_cache();
+    std::size_t low = cache.low_watermark();
+    std::size_t high = cache.high_watermark();
+    cache.set_watermarks( 1, 2);
+    cache.clear();
+    boost::fibers::stack_cache_statistics s0 = cache.statistics();
+    BOOST_CHECK_EQUAL( 0u, s0.size);
+    boost::fibers::fiber( boost::fibers::launch::dispatch, fn1).join();
+    boost::this_fiber::yield();
+    // stack of the terminated fiber has been cached
+    boost::fibers::stack_cache_statistics s1 = cache.statistics();
+    BOOST_CHECK_EQUAL( 1u, s1.size);
+    BOOST_CHECK_EQUAL( s0.recycled + 1, s1.recycled);
+    boost::fibers::fiber( boost::fibers::launch::dispatch, fn1).join();
+    boost::this_fiber::yield();
+    // and reused by the next launch
+    boost::fibers::stack_cache_statistics s2 = cache.statistics();
+    BOOST_CHECK_EQUAL( s1.hits + 1, s2.hits);
+    BOOST_CHECK_EQUAL( s1.misses, s2.misses);
+    BOOST_CHECK_EQUAL( 1u, s2.size);
+    {
+        // high watermark exceeded -> trimmed down to low watermark
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, fn1);
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, fn1);
+        boost::fibers::fiber f3( boost::fibers::launch::dispatch, fn1);
+        boost::fibers::fiber f4( boost::fibers::launch::dispatch, fn1);
+        f1.join();
+        f2.join();
+        f3.join();
+        f4.join();
+    }
+    boost::this_fiber::yield();
+    boost::fibers::stack_cache_statistics s3 = cache.statistics();
+    BOOST_CHECK( s3.size <= 2u);
+    BOOST_CHECK( s2.released < s3.released);
+    BOOST_CHECK_EQUAL( 2u, s3.peak);
+    // disabled cache
+    cache.set_watermarks( 0, 0);
+    BOOST_CHECK_EQUAL( 0u, cache.statistics().size);
+    boost::fibers::fiber( boost::fibers::launch::dispatch, fn1).join();
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0u, cache.statistics().size);
+    cache.set_watermarks( low, high);
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: fiber test suite");
@@ -435,6 +481,7 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     test->add( BOOST_TEST_CASE( & test_sleep_for) );
     test->add( BOOST_TEST_CASE( & test_sleep_until) );
     test->add( BOOST_TEST_CASE( & test_detach) );
+    test->add( BOOST_TEST_CASE( & test_stack_cache) );
 
     return test;
 }
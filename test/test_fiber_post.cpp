@@ -10,6 +10,7 @@
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <boost/assert.hpp>
 #include <boost/test/unit_test.hpp>
@@ -418,6 +419,95 @@ void test_detach() {
     }
 }
 
+void test_stack_cache() {
+    boost::fibers::stack_cache & cache = boost::fibers::get_stack_cache();
+    std::size_t low = cache.low_watermark();
+    std::size_t high = cache.high_watermark();
+    cache.set_watermarks( 1, 2);
+    cache.clear();
+    boost::fibers::stack_cache_statistics s0 = cache.statistics();
+    BOOST_CHECK_EQUAL( 0u, s0.size);
+    boost::fibers::fiber( boost::fibers::launch::post, fn1).join();
+    boost::this_fiber::yield();
+    // stack of the terminated fiber has been cached
+    boost::fibers::stack_cache_statistics s1 = cache.statistics();
+    BOOST_CHECK_EQUAL( 1u, s1.size);
+    BOOST_CHECK_EQUAL( s0.recycled + 1, s1.recycled);
+    boost::fibers::fiber( boost::fibers::launch::post, fn1).join();
+    boost::this_fiber::yield();
+    // and reused by the next launch
+    boost::fibers::stack_cache_statistics s2 = cache.statistics();
+    BOOST_CHECK_EQUAL( s1.hits + 1, s2.hits);
+    BOOST_CHECK_EQUAL( s1.misses, s2.misses);
+    BOOST_CHECK_EQUAL( 1u, s2.size);
+    {
+        // high watermark exceeded -> trimmed down to low watermark
+        boost::fibers::fiber f1( boost::fibers::launch::post, fn1);
+        boost::fibers::fiber f2( boost::fibers::launch::post, fn1);
+        boost::fibers::fiber f3( boost::fibers::launch::post, fn1);
+        boost::fibers::fiber f4( boost::fibers::launch::post, fn1);
+        f1.join();
+        f2.join();
+        f3.join();
+        f4.join();
+    }
+    boost::this_fiber::yield();
+    boost::fibers::stack_cache_statistics s3 = cache.statistics();
+    BOOST_CHECK( s3.size <= 2u);
+    BOOST_CHECK( s2.released < s3.released);
+    BOOST_CHECK_EQUAL( 2u, s3.peak);
+    // disabled cache
+    cache.set_watermarks( 0, 0);
+    BOOST_CHECK_EQUAL( 0u, cache.statistics().size);
+    boost::fibers::fiber( boost::fibers::launch::post, fn1).join();
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0u, cache.statistics().size);
+    cache.set_watermarks( low, high);
+}
+
+void test_scheduler_statistics() {
+    boost::fibers::scheduler_statistics s0 = boost::fibers::get_scheduler_statistics();
+    boost::fibers::fiber( boost::fibers::launch::post, [](){
+        for ( int i = 0; i < 5; ++i) {
+            boost::this_fiber::yield();
+        }
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+    }).join();
+    boost::fibers::scheduler_statistics s1 = boost::fibers::get_scheduler_statistics();
+    // launch, 5 yields and the wakeup after sleeping
+    BOOST_CHECK( s0.context_switches + 7 <= s1.context_switches);
+    BOOST_CHECK( s0.wakeups + 7 <= s1.wakeups);
+    BOOST_CHECK_EQUAL( 0, s1.sleeping);
+    BOOST_CHECK_EQUAL( s0.steal_attempts, s1.steal_attempts);
+    // no other fiber was ready while sleeping
+    BOOST_CHECK( s0.suspends < s1.suspends);
+    BOOST_CHECK( s0.suspended < s1.suspended);
+    std::thread t{ [](){
+        boost::fibers::scheduler_statistics s = boost::fibers::get_scheduler_statistics();
+        // counters are per thread
+        BOOST_CHECK_EQUAL( 0u, s.suspends);
+    }};
+    t.join();
+}
+
+void test_trace_dump() {
+    boost::fibers::trace::clear();
+    boost::fibers::fiber( boost::fibers::launch::post, [](){
+        boost::this_fiber::yield();
+    }).join();
+    std::ostringstream os;
+    boost::fibers::trace::dump_chrome_json( os);
+    std::string json = os.str();
+    BOOST_CHECK_EQUAL( 0u, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    if ( boost::fibers::trace::enabled() ) {
+        // the fiber ran and terminated on this thread
+        BOOST_CHECK( std::string::npos != json.find("\"ph\":\"X\""));
+        BOOST_CHECK( std::string::npos != json.find("\"name\":\"terminate\""));
+    } else {
+        BOOST_CHECK( std::string::npos == json.find("\"ph\""));
+    }
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: fiber test suite");
@@ -435,6 +525,9 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     test->add( BOOST_TEST_CASE( & test_sleep_for) );
     test->add( BOOST_TEST_CASE( & test_sleep_until) );
     test->add( BOOST_TEST_CASE( & test_detach) );
+    test->add( BOOST_TEST_CASE( & test_stack_cache) );
+    test->add( BOOST_TEST_CASE( & test_scheduler_statistics) );
+    test->add( BOOST_TEST_CASE( & test_trace_dump) );
 
     return test;
 }
@@ -0,0 +1,285 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct my_exception : public std::runtime_error {
+    my_exception() :
+        std::runtime_error("my_exception") {
+    }
+};
+
+void test_then() {
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f1 = p.get_future();
+    boost::fibers::future< std::string > f2 = f1.then(
+            []( boost::fibers::future< int > f) {
+                return std::to_string( f.get() + 1);
+            });
+    BOOST_CHECK( ! f1.valid() );
+    BOOST_CHECK( f2.valid() );
+    BOOST_CHECK( boost::fibers::future_status::timeout == f2.wait_for( std::chrono::milliseconds( 1) ) );
+    p.set_value( 1);
+    BOOST_CHECK_EQUAL( "2", f2.get() );
+}
+
+void test_then_ready() {
+    boost::fibers::promise< int > p;
+    p.set_value( 3);
+    bool ran = false;
+    // attached to a ready state, runs inline
+    boost::fibers::future< int > f = p.get_future().then(
+            [&ran]( boost::fibers::future< int > f) {
+                ran = true;
+                return f.get() * 2;
+            });
+    BOOST_CHECK( ran);
+    BOOST_CHECK_EQUAL( 6, f.get() );
+}
+
+void test_then_chain() {
+    boost::fibers::promise< void > p;
+    int i = 0;
+    boost::fibers::future< int & > f = p.get_future()
+        .then( []( boost::fibers::future< void > f) {
+                   f.get();
+                   return 1;
+               })
+        .then( [&i]( boost::fibers::future< int > f) -> int & {
+                   i = f.get() + 1;
+                   return i;
+               });
+    boost::fibers::future< void > f3 = f.then(
+            []( boost::fibers::future< int & > f) {
+                ++f.get();
+            });
+    boost::fibers::fiber( boost::fibers::launch::post, [&p](){ p.set_value(); }).join();
+    f3.get();
+    BOOST_CHECK_EQUAL( 3, i);
+}
+
+void test_then_exception() {
+    boost::fibers::promise< int > p;
+    // the exception of the antecedent is observed by the continuation
+    boost::fibers::future< int > f1 = p.get_future().then(
+            []( boost::fibers::future< int > f) {
+                return f.get();
+            });
+    p.set_exception( std::make_exception_ptr( my_exception() ) );
+    BOOST_CHECK_THROW( f1.get(), my_exception);
+
+    // an exception thrown by the continuation is stored
+    boost::fibers::promise< int > p2;
+    boost::fibers::future< void > f2 = p2.get_future().then(
+            []( boost::fibers::future< int >) {
+                throw my_exception();
+            });
+    p2.set_value( 1);
+    BOOST_CHECK_THROW( f2.get(), my_exception);
+}
+
+void test_then_broken_promise() {
+    boost::fibers::future< bool > f;
+    {
+        boost::fibers::promise< int > p;
+        f = p.get_future().then(
+                []( boost::fibers::future< int > f) {
+                    try {
+                        f.get();
+                    } catch ( boost::fibers::broken_promise const&) {
+                        return true;
+                    }
+                    return false;
+                });
+    }
+    BOOST_CHECK( f.get() );
+}
+
+void test_then_invalid() {
+    boost::fibers::future< int > f;
+    BOOST_CHECK_THROW(
+        f.then( []( boost::fibers::future< int >) {}),
+        boost::fibers::future_uninitialized);
+}
+
+void test_then_dispatch() {
+    boost::fibers::promise< int > p;
+    boost::fibers::fiber::id id;
+    boost::fibers::future< void > f = p.get_future().then(
+            [&id]( boost::fibers::future< int >) {
+                id = boost::this_fiber::get_id();
+            });
+    boost::fibers::fiber setter( boost::fibers::launch::post, [&p](){ p.set_value( 1); });
+    boost::fibers::fiber::id setter_id = setter.get_id();
+    setter.join();
+    f.get();
+    // ran inline in the completing fiber
+    BOOST_CHECK( setter_id == id);
+}
+
+void test_then_post() {
+    boost::fibers::promise< int > p;
+    boost::fibers::fiber::id id;
+    boost::fibers::future< int > f = p.get_future().then(
+            boost::fibers::launch::post,
+            [&id]( boost::fibers::future< int > f) {
+                id = boost::this_fiber::get_id();
+                return f.get();
+            });
+    boost::fibers::fiber setter( boost::fibers::launch::post, [&p](){ p.set_value( 5); });
+    boost::fibers::fiber::id setter_id = setter.get_id();
+    setter.join();
+    BOOST_CHECK_EQUAL( 5, f.get() );
+    BOOST_CHECK( setter_id != id);
+    BOOST_CHECK( boost::this_fiber::get_id() != id);
+}
+
+void test_when_all_range() {
+    std::vector< boost::fibers::promise< int > > promises( 4);
+    std::vector< boost::fibers::future< int > > futures;
+    for ( auto & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    boost::fibers::future< std::vector< boost::fibers::future< int > > > f =
+        boost::fibers::when_all( futures.begin(), futures.end() );
+    for ( auto & fi : futures) {
+        BOOST_CHECK( ! fi.valid() );
+    }
+    for ( int i = 3; i >= 1; --i) {
+        promises[i].set_value( i);
+    }
+    BOOST_CHECK( boost::fibers::future_status::timeout == f.wait_for( std::chrono::milliseconds( 1) ) );
+    promises[0].set_value( 0);
+    std::vector< boost::fibers::future< int > > result = f.get();
+    BOOST_REQUIRE_EQUAL( 4u, result.size() );
+    for ( int i = 0; i < 4; ++i) {
+        BOOST_CHECK_EQUAL( i, result[i].get() );
+    }
+}
+
+void test_when_all_empty() {
+    std::vector< boost::fibers::future< int > > futures;
+    boost::fibers::future< std::vector< boost::fibers::future< int > > > f =
+        boost::fibers::when_all( futures.begin(), futures.end() );
+    BOOST_CHECK( boost::fibers::future_status::ready == f.wait_for( std::chrono::milliseconds( 0) ) );
+    BOOST_CHECK( f.get().empty() );
+}
+
+void test_when_all_variadic() {
+    boost::fibers::promise< int > p1;
+    boost::fibers::promise< std::string > p2;
+    boost::fibers::promise< void > p3;
+    boost::fibers::shared_future< std::string > sf = p2.get_future().share();
+    auto f = boost::fibers::when_all( p1.get_future(), sf, p3.get_future() );
+    // shared_futures are copied
+    BOOST_CHECK( sf.valid() );
+    p3.set_value();
+    p2.set_value( "abc");
+    p1.set_exception( std::make_exception_ptr( my_exception() ) );
+    auto t = f.get();
+    BOOST_CHECK_THROW( std::get< 0 >( t).get(), my_exception);
+    BOOST_CHECK_EQUAL( "abc", std::get< 1 >( t).get() );
+    std::get< 2 >( t).get();
+}
+
+void test_when_any_range() {
+    std::vector< boost::fibers::promise< int > > promises( 3);
+    std::vector< boost::fibers::future< int > > futures;
+    for ( auto & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    auto f = boost::fibers::when_any( futures.begin(), futures.end() );
+    BOOST_CHECK( boost::fibers::future_status::timeout == f.wait_for( std::chrono::milliseconds( 1) ) );
+    boost::fibers::fiber( boost::fibers::launch::post, [&promises](){ promises[1].set_value( 1); }).join();
+    boost::fibers::when_any_result< std::vector< boost::fibers::future< int > > > result = f.get();
+    BOOST_CHECK_EQUAL( 1u, result.index);
+    BOOST_REQUIRE_EQUAL( 3u, result.futures.size() );
+    BOOST_CHECK_EQUAL( 1, result.futures[1].get() );
+    // the remaining futures are still connected to their promises
+    promises[2].set_value( 2);
+    promises[0].set_value( 0);
+    BOOST_CHECK_EQUAL( 0, result.futures[0].get() );
+    BOOST_CHECK_EQUAL( 2, result.futures[2].get() );
+}
+
+void test_when_any_empty() {
+    std::vector< boost::fibers::future< int > > futures;
+    auto result = boost::fibers::when_any( futures.begin(), futures.end() ).get();
+    BOOST_CHECK_EQUAL( static_cast< std::size_t >( -1), result.index);
+    BOOST_CHECK( result.futures.empty() );
+}
+
+void test_when_any_variadic() {
+    boost::fibers::promise< int > p1;
+    boost::fibers::promise< std::string > p2;
+    p2.set_value( "abc");
+    // already ready
+    auto result = boost::fibers::when_any( p1.get_future(), p2.get_future() ).get();
+    BOOST_CHECK_EQUAL( 1u, result.index);
+    BOOST_CHECK_EQUAL( "abc", std::get< 1 >( result.futures).get() );
+    p1.set_value( 1);
+    BOOST_CHECK_EQUAL( 1, std::get< 0 >( result.futures).get() );
+}
+
+void test_when_all_mt() {
+    constexpr int count = 1000;
+    std::vector< boost::fibers::promise< int > > promises( count);
+    std::vector< boost::fibers::future< int > > futures;
+    for ( auto & p : promises) {
+        futures.push_back( p.get_future() );
+    }
+    auto f = boost::fibers::when_all( futures.begin(), futures.end() );
+    std::thread t1( [&promises](){
+                        for ( int i = 0; i < count; i += 2) {
+                            promises[i].set_value( i);
+                        }
+                    });
+    std::thread t2( [&promises](){
+                        for ( int i = 1; i < count; i += 2) {
+                            promises[i].set_value( i);
+                        }
+                    });
+    long sum = 0;
+    for ( auto & fi : f.get() ) {
+        sum += fi.get();
+    }
+    t1.join();
+    t2.join();
+    BOOST_CHECK_EQUAL( static_cast< long >( count) * ( count - 1) / 2, sum);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: future-continuation test suite");
+
+    test->add( BOOST_TEST_CASE( & test_then) );
+    test->add( BOOST_TEST_CASE( & test_then_ready) );
+    test->add( BOOST_TEST_CASE( & test_then_chain) );
+    test->add( BOOST_TEST_CASE( & test_then_exception) );
+    test->add( BOOST_TEST_CASE( & test_then_broken_promise) );
+    test->add( BOOST_TEST_CASE( & test_then_invalid) );
+    test->add( BOOST_TEST_CASE( & test_then_dispatch) );
+    test->add( BOOST_TEST_CASE( & test_then_post) );
+    test->add( BOOST_TEST_CASE( & test_when_all_range) );
+    test->add( BOOST_TEST_CASE( & test_when_all_empty) );
+    test->add( BOOST_TEST_CASE( & test_when_all_variadic) );
+    test->add( BOOST_TEST_CASE( & test_when_any_range) );
+    test->add( BOOST_TEST_CASE( & test_when_any_empty) );
+    test->add( BOOST_TEST_CASE( & test_when_any_variadic) );
+    test->add( BOOST_TEST_CASE( & test_when_all_mt) );
+
+    return test;
+}
@@ -0,0 +1,100 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_latch() {
+    boost::fibers::latch l{ 3 };
+    BOOST_CHECK( ! l.try_wait() );
+    int done = 0;
+    std::vector< boost::fibers::fiber > waiters;
+    for ( int i = 0; i < 3; ++i) {
+        waiters.emplace_back( boost::fibers::launch::post, [&l,&done](){
+            l.wait();
+            ++done;
+        });
+    }
+    boost::this_fiber::yield();
+    l.count_down( 2);
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, done);
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+    BOOST_CHECK( l.try_wait() );
+    for ( boost::fibers::fiber & f : waiters) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, done);
+    // a released latch does not block
+    l.wait();
+}
+
+void test_latch_arrive_and_wait() {
+    boost::fibers::latch l{ 4 };
+    int arrived = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&l,&arrived](){
+            ++arrived;
+            l.arrive_and_wait();
+            BOOST_CHECK_EQUAL( 4, arrived);
+        });
+    }
+    boost::this_fiber::yield();
+    ++arrived;
+    l.arrive_and_wait();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_THROW( boost::fibers::latch{ -1 }, boost::fibers::fiber_error);
+    boost::fibers::latch zero{ 0 };
+    BOOST_CHECK( zero.try_wait() );
+}
+
+void test_latch_mt() {
+    boost::fibers::latch l{ 16 };
+    std::atomic< int > arrived{ 0 };
+    std::atomic< bool > early{ false };
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&l,&arrived,&early](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 4; ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&l,&arrived,&early](){
+                    ++arrived;
+                    l.arrive_and_wait();
+                    if ( 16 != arrived) {
+                        early = true;
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! early);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: latch test suite");
+
+    test->add( BOOST_TEST_CASE( & test_latch) );
+    test->add( BOOST_TEST_CASE( & test_latch_arrive_and_wait) );
+    test->add( BOOST_TEST_CASE( & test_latch_mt) );
+
+    return test;
+}
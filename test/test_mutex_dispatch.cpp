@@ -52,7 +52,10 @@ void fn3( boost::fibers::timed_mutex & m) {
 
 void fn4( boost::fibers::timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while ( ! m.try_lock() );
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -107,7 +110,10 @@ void fn9( boost::fibers::recursive_timed_mutex & m) {
 
 void fn10( boost::fibers::recursive_timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -165,7 +171,10 @@ void fn15( boost::fibers::recursive_mutex & m) {
 
 void fn16( boost::fibers::recursive_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock());
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -185,7 +194,10 @@ void fn17( boost::fibers::mutex & m) {
 
 void fn18( boost::fibers::mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -68,6 +68,50 @@ void test_mutex() {
     }
 }
 
+void test_adaptive_mutex() {
+    for ( int i = 0; i < 10; ++i) {
+        boost::fibers::mutex mtx{ boost::fibers::mutex_policy::adaptive };
+        mtx.lock();
+        boost::barrier b( 3);
+        boost::thread t1( fn1< boost::fibers::mutex >, std::ref( b), std::ref( mtx) );
+        boost::thread t2( fn2< boost::fibers::mutex >, std::ref( b), std::ref( mtx) );
+        b.wait();
+        boost::this_thread::sleep_for( ms( 250) );
+        mtx.unlock();
+        t1.join();
+        t2.join();
+        BOOST_CHECK( 3 == value1);
+        BOOST_CHECK( 7 == value2);
+    }
+}
+
+void test_adaptive_mutex_contention() {
+    boost::fibers::mutex mtx{ boost::fibers::mutex_policy::adaptive };
+    long counter = 0;
+    std::vector< boost::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&mtx,&counter](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int f = 0; f < 4; ++f) {
+                fibers.emplace_back( boost::fibers::launch::post, [&mtx,&counter](){
+                    for ( int j = 0; j < 10000; ++j) {
+                        mtx.lock();
+                        ++counter;
+                        mtx.unlock();
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( boost::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 4 * 10000, counter);
+}
+
 void test_recursive_mutex() {
     for ( int i = 0; i < 10; ++i) {
         boost::fibers::recursive_mutex mtx;
@@ -128,6 +172,8 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     test->add( BOOST_TEST_CASE( & test_mutex) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_mutex) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_mutex_contention) );
     test->add( BOOST_TEST_CASE( & test_recursive_mutex) );
     test->add( BOOST_TEST_CASE( & test_timed_mutex) );
     test->add( BOOST_TEST_CASE( & test_recursive_timed_mutex) );
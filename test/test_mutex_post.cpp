@@ -52,7 +52,10 @@ void fn3( boost::fibers::timed_mutex & m) {
 
 void fn4( boost::fibers::timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while ( ! m.try_lock() );
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -107,7 +110,10 @@ void fn9( boost::fibers::recursive_timed_mutex & m) {
 
 void fn10( boost::fibers::recursive_timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -165,7 +171,10 @@ void fn15( boost::fibers::recursive_mutex & m) {
 
 void fn16( boost::fibers::recursive_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock());
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -185,7 +194,10 @@ void fn17( boost::fibers::mutex & m) {
 
 void fn18( boost::fibers::mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while ( ! m.try_lock() ) {
+        // try_lock() does not yield
+        boost::this_fiber::yield();
+    }
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -279,6 +291,69 @@ void test_mutex() {
     boost::fibers::fiber( boost::fibers::launch::post, & do_test_mutex).join();
 }
 
+void do_test_adaptive_mutex() {
+    test_exclusive< boost::fibers::mutex >()();
+
+    std::vector< int > order;
+    boost::fibers::mutex mtx{ boost::fibers::mutex_policy::adaptive };
+    mtx.lock();
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&order](){
+        mtx.lock();
+        order.push_back( 1);
+        mtx.unlock();
+    });
+    // f blocks in lock() longer than the handoff threshold
+    boost::this_fiber::yield();
+    boost::this_fiber::sleep_for( std::chrono::microseconds( 2 * BOOST_FIBERS_MUTEX_HANDOFF_THRESHOLD) );
+    // f is resumed, but this fiber takes the mutex first
+    mtx.unlock();
+    mtx.lock();
+    order.push_back( 0);
+    // f finds the mutex locked again and requests the handoff
+    boost::this_fiber::yield();
+    // the ownership is handed over to f
+    mtx.unlock();
+    mtx.lock();
+    order.push_back( 2);
+    mtx.unlock();
+    f.join();
+    BOOST_REQUIRE_EQUAL( 3u, order.size() );
+    BOOST_CHECK_EQUAL( 0, order[0]);
+    BOOST_CHECK_EQUAL( 1, order[1]);
+    BOOST_CHECK_EQUAL( 2, order[2]);
+}
+
+void test_adaptive_mutex() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_adaptive_mutex).join();
+}
+
+template< typename M >
+void do_test_try_lock_no_yield() {
+    M mtx;
+    bool ran = false;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&ran](){
+        ran = true;
+    });
+    // neither a successful nor a failing try_lock() yields
+    BOOST_CHECK( mtx.try_lock() );
+    BOOST_CHECK( ! ran);
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&mtx,&ran](){
+        BOOST_CHECK( ! mtx.try_lock() );
+        BOOST_CHECK( ! ran);
+    });
+    mtx.unlock();
+    f2.join();
+    f.join();
+    BOOST_CHECK( ran);
+}
+
+void test_try_lock_no_yield() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::timed_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::recursive_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::recursive_timed_mutex >).join();
+}
+
 void do_test_recursive_mutex() {
     test_lock< boost::fibers::recursive_mutex >()();
     test_exclusive< boost::fibers::recursive_mutex >()();
@@ -439,6 +514,8 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
         BOOST_TEST_SUITE("Boost.Fiber: mutex test suite");
 
     test->add( BOOST_TEST_CASE( & test_mutex) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_mutex) );
+    test->add( BOOST_TEST_CASE( & test_try_lock_no_yield) );
     test->add( BOOST_TEST_CASE( & test_recursive_mutex) );
     test->add( BOOST_TEST_CASE( & test_timed_mutex) );
     test->add( BOOST_TEST_CASE( & test_recursive_timed_mutex) );
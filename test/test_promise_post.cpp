@@ -8,6 +8,8 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -21,6 +23,16 @@ struct my_exception : public std::runtime_error {
     }
 };
 
+struct throwing_copy {
+    throwing_copy() = default;
+
+    throwing_copy( throwing_copy const&) {
+        boost::throw_exception( my_exception() );
+    }
+
+    throwing_copy( throwing_copy &&) = default;
+};
+
 struct A {
     A() = default;
 
@@ -417,6 +429,42 @@ void test_promise_set_exception_void() {
     BOOST_CHECK( thrown);
 }
 
+void test_promise_set_value_throws() {
+    // the promise is still unsatisfied if the value could not be stored
+    boost::fibers::promise< throwing_copy > p1;
+    boost::fibers::future< throwing_copy > f1 = p1.get_future();
+    throwing_copy t;
+    bool thrown = false;
+    try {
+        p1.set_value( t);
+    } catch ( my_exception const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+    BOOST_CHECK( boost::fibers::future_status::timeout == f1.wait_for( std::chrono::milliseconds( 1) ) );
+    p1.set_value( std::move( t) );
+    BOOST_CHECK( boost::fibers::future_status::ready == f1.wait_for( std::chrono::milliseconds( 1) ) );
+}
+
+void test_promise_set_value_mt() {
+    // set by another thread while several fibers wait
+    for ( int i = 0; i < 100; ++i) {
+        boost::fibers::promise< int > p1;
+        boost::fibers::shared_future< int > f1 = p1.get_future().share();
+        int sum = 0;
+        std::vector< boost::fibers::fiber > waiters;
+        for ( int j = 0; j < 4; ++j) {
+            waiters.emplace_back( boost::fibers::launch::post, [f1,&sum](){ sum += f1.get(); });
+        }
+        std::thread t{ [&p1,i](){ p1.set_value( i); } };
+        for ( boost::fibers::fiber & f : waiters) {
+            f.join();
+        }
+        t.join();
+        BOOST_CHECK_EQUAL( 4 * i, sum);
+    }
+}
+
 boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
     boost::unit_test_framework::test_suite* test =
         BOOST_TEST_SUITE("Boost.Fiber: promise test suite");
@@ -440,6 +488,8 @@ boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
     test->add(BOOST_TEST_CASE(test_promise_set_exception));
     test->add(BOOST_TEST_CASE(test_promise_set_exception_ref));
     test->add(BOOST_TEST_CASE(test_promise_set_exception_void));
+    test->add(BOOST_TEST_CASE(test_promise_set_value_throws));
+    test->add(BOOST_TEST_CASE(test_promise_set_value_mt));
 
     return test;
 }
@@ -0,0 +1,168 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::buffered_channel< int >     buffered_channel_t;
+typedef boost::fibers::unbuffered_channel< int >   unbuffered_channel_t;
+
+void test_select_pop() {
+    buffered_channel_t c1{ 4 }, c2{ 4 };
+    int v1 = 0, v2 = 0;
+    std::size_t index = 2;
+    c2.push( 7);
+    BOOST_CHECK( boost::fibers::channel_op_status::success ==
+                 boost::fibers::select( index,
+                                        boost::fibers::select_pop( c1, v1),
+                                        boost::fibers::select_pop( c2, v2) ) );
+    BOOST_CHECK_EQUAL( 1u, index);
+    BOOST_CHECK_EQUAL( 0, v1);
+    BOOST_CHECK_EQUAL( 7, v2);
+}
+
+void test_select_order() {
+    // cases are tried in the order given, exactly one is performed
+    buffered_channel_t c1{ 4 }, c2{ 4 };
+    int v1 = 0, v2 = 0;
+    std::size_t index = 2;
+    c1.push( 1);
+    c2.push( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success ==
+                 boost::fibers::select( index,
+                                        boost::fibers::select_pop( c1, v1),
+                                        boost::fibers::select_pop( c2, v2) ) );
+    BOOST_CHECK_EQUAL( 0u, index);
+    BOOST_CHECK_EQUAL( 1, v1);
+    BOOST_CHECK_EQUAL( 0, v2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.try_pop( v2) );
+    BOOST_CHECK_EQUAL( 2, v2);
+}
+
+void test_select_push() {
+    buffered_channel_t c1{ 2 }, c2{ 2 };
+    int v = 0;
+    std::size_t index = 2;
+    c1.push( 1);
+    BOOST_CHECK( boost::fibers::channel_op_status::success ==
+                 boost::fibers::select( index,
+                                        boost::fibers::select_push( c1, 2),
+                                        boost::fibers::select_push( c2, 3) ) );
+    BOOST_CHECK_EQUAL( 1u, index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.pop( v) );
+    BOOST_CHECK_EQUAL( 3, v);
+}
+
+void test_select_closed() {
+    buffered_channel_t c1{ 4 }, c2{ 4 };
+    int v1 = 0, v2 = 0;
+    std::size_t index = 2;
+    c2.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed ==
+                 boost::fibers::select( index,
+                                        boost::fibers::select_pop( c1, v1),
+                                        boost::fibers::select_pop( c2, v2) ) );
+    BOOST_CHECK_EQUAL( 1u, index);
+}
+
+void test_select_timeout() {
+    buffered_channel_t c1{ 4 };
+    unbuffered_channel_t c2;
+    int v1 = 0, v2 = 0;
+    std::size_t index = 2;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout ==
+                 boost::fibers::select_wait_for( index, std::chrono::milliseconds( 10),
+                                                 boost::fibers::select_pop( c1, v1),
+                                                 boost::fibers::select_pop( c2, v2) ) );
+    BOOST_CHECK_EQUAL( 2u, index);
+    // outdated wakers must not disturb later operations
+    c1.push( 1);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.pop( v1) );
+    BOOST_CHECK_EQUAL( 1, v1);
+}
+
+void test_select_wait() {
+    buffered_channel_t c1{ 4 };
+    unbuffered_channel_t c2;
+    int v1 = 0, v2 = 0;
+    std::size_t index = 2;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success ==
+                     boost::fibers::select( index,
+                                            boost::fibers::select_pop( c1, v1),
+                                            boost::fibers::select_pop( c2, v2) ) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c2](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c2.push( 5) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1u, index);
+    BOOST_CHECK_EQUAL( 0, v1);
+    BOOST_CHECK_EQUAL( 5, v2);
+}
+
+void test_select_mt() {
+    // producers running on other threads, one consumer selecting
+    constexpr int count = 1000;
+    buffered_channel_t c1{ 16 }, c2{ 16 };
+    unbuffered_channel_t c3;
+    std::thread t1{ [&c1,count](){
+                        for ( int i = 0; i < count; ++i) {
+                            c1.push( 1);
+                        }
+                    }};
+    std::thread t2{ [&c2,count](){
+                        for ( int i = 0; i < count; ++i) {
+                            c2.push( 2);
+                        }
+                    }};
+    std::thread t3{ [&c3,count](){
+                        for ( int i = 0; i < count; ++i) {
+                            c3.push( 3);
+                        }
+                    }};
+    int received[3] = { 0, 0, 0 };
+    for ( int i = 0; i < 3 * count; ++i) {
+        int v1 = 0, v2 = 0, v3 = 0;
+        std::size_t index = 3;
+        BOOST_CHECK( boost::fibers::channel_op_status::success ==
+                     boost::fibers::select( index,
+                                            boost::fibers::select_pop( c1, v1),
+                                            boost::fibers::select_pop( c2, v2),
+                                            boost::fibers::select_pop( c3, v3) ) );
+        BOOST_REQUIRE( index < 3u);
+        ++received[index];
+    }
+    t1.join();
+    t2.join();
+    t3.join();
+    BOOST_CHECK_EQUAL( count, received[0]);
+    BOOST_CHECK_EQUAL( count, received[1]);
+    BOOST_CHECK_EQUAL( count, received[2]);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: select test suite");
+
+    test->add( BOOST_TEST_CASE( & test_select_pop) );
+    test->add( BOOST_TEST_CASE( & test_select_order) );
+    test->add( BOOST_TEST_CASE( & test_select_push) );
+    test->add( BOOST_TEST_CASE( & test_select_closed) );
+    test->add( BOOST_TEST_CASE( & test_select_timeout) );
+    test->add( BOOST_TEST_CASE( & test_select_wait) );
+    test->add( BOOST_TEST_CASE( & test_select_mt) );
+
+    return test;
+}
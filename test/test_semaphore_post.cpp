@@ -0,0 +1,128 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+void test_counting_semaphore() {
+    boost::fibers::counting_semaphore<> sem{ 2 };
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+    sem.release( 2);
+    BOOST_CHECK( sem.try_acquire() );
+    sem.acquire();
+    BOOST_CHECK( ! sem.try_acquire() );
+    sem.release();
+    sem.acquire();
+}
+
+void test_counting_semaphore_invalid() {
+    BOOST_CHECK_THROW( boost::fibers::counting_semaphore<>{ -1 }, boost::fibers::fiber_error);
+    BOOST_CHECK_THROW( boost::fibers::binary_semaphore{ 2 }, boost::fibers::fiber_error);
+    BOOST_CHECK_EQUAL( 1, boost::fibers::binary_semaphore::max() );
+}
+
+void test_counting_semaphore_blocking() {
+    boost::fibers::counting_semaphore<> sem{ 0 };
+    int acquired = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&sem,&acquired](){
+            sem.acquire();
+            ++acquired;
+        });
+    }
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, acquired);
+    // exactly two waiters are resumed
+    sem.release( 2);
+    boost::this_fiber::yield();
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 2, acquired);
+    sem.release( 3);
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 5, acquired);
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void test_counting_semaphore_timed() {
+    boost::fibers::binary_semaphore sem{ 0 };
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    BOOST_CHECK( ! sem.try_acquire_for( ms( 50) ) );
+    BOOST_CHECK( std::chrono::steady_clock::now() - t0 >= ms( 50) );
+    BOOST_CHECK( ! sem.try_acquire_until( std::chrono::steady_clock::now() + ms( 10) ) );
+    boost::fibers::fiber f( boost::fibers::launch::post, [&sem](){
+        sem.release();
+    });
+    BOOST_CHECK( sem.try_acquire_for( ms( 1000) ) );
+    f.join();
+    // a timed out waiter does not consume a release
+    sem.release();
+    BOOST_CHECK( sem.try_acquire() );
+}
+
+void test_counting_semaphore_mt() {
+    constexpr int count = 1000;
+    boost::fibers::counting_semaphore<> sem{ 3 };
+    std::atomic< int > inside{ 0 };
+    std::atomic< bool > exceeded{ false };
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&sem,&inside,&exceeded](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 4; ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&sem,&inside,&exceeded](){
+                    for ( int n = 0; n < count; ++n) {
+                        sem.acquire();
+                        if ( 3 < ++inside) {
+                            exceeded = true;
+                        }
+                        if ( 0 == n % 8) {
+                            boost::this_fiber::yield();
+                        }
+                        --inside;
+                        sem.release();
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! exceeded);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: semaphore test suite");
+
+    test->add( BOOST_TEST_CASE( & test_counting_semaphore) );
+    test->add( BOOST_TEST_CASE( & test_counting_semaphore_invalid) );
+    test->add( BOOST_TEST_CASE( & test_counting_semaphore_blocking) );
+    test->add( BOOST_TEST_CASE( & test_counting_semaphore_timed) );
+    test->add( BOOST_TEST_CASE( & test_counting_semaphore_mt) );
+
+    return test;
+}
@@ -0,0 +1,113 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// readers and writers on several threads; a writer must never overlap
+// another writer or a reader
+template< typename M, typename LockShared, typename Lock >
+void run( LockShared lock_shared, Lock lock) {
+    M mtx;
+    std::atomic< int > readers{ 0 };
+    std::atomic< int > writers{ 0 };
+    std::atomic< bool > overlap{ false };
+    long value = 0;
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&,t](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 4; ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&,t,i](){
+                    for ( int n = 0; n < 1000; ++n) {
+                        if ( 0 == ( n + t + i) % 8) {
+                            while ( ! lock( mtx) );
+                            if ( 0 != writers.fetch_add( 1) || 0 != readers.load() ) {
+                                overlap = true;
+                            }
+                            ++value;
+                            writers.fetch_sub( 1);
+                            mtx.unlock();
+                        } else {
+                            while ( ! lock_shared( mtx) );
+                            readers.fetch_add( 1);
+                            if ( 0 != writers.load() ) {
+                                overlap = true;
+                            }
+                            if ( 0 == n % 16) {
+                                boost::this_fiber::yield();
+                            }
+                            readers.fetch_sub( 1);
+                            mtx.unlock_shared();
+                        }
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! overlap);
+    BOOST_CHECK_EQUAL( 4 * 4 * 1000 / 8, value);
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+template< typename M >
+bool lock( M & mtx) {
+    mtx.lock();
+    return true;
+}
+
+template< typename M >
+bool lock_shared( M & mtx) {
+    mtx.lock_shared();
+    return true;
+}
+
+bool try_lock_for( boost::fibers::shared_timed_mutex & mtx) {
+    return mtx.try_lock_for( std::chrono::microseconds( 50) );
+}
+
+bool try_lock_shared_for( boost::fibers::shared_timed_mutex & mtx) {
+    return mtx.try_lock_shared_for( std::chrono::microseconds( 50) );
+}
+
+void test_shared_mutex() {
+    for ( int i = 0; i < 5; ++i) {
+        run< boost::fibers::shared_mutex >(
+                lock_shared< boost::fibers::shared_mutex >, lock< boost::fibers::shared_mutex >);
+    }
+}
+
+void test_shared_timed_mutex() {
+    for ( int i = 0; i < 5; ++i) {
+        run< boost::fibers::shared_timed_mutex >(
+                lock_shared< boost::fibers::shared_timed_mutex >, lock< boost::fibers::shared_timed_mutex >);
+        // timeouts race with the hand-over of the mutex
+        run< boost::fibers::shared_timed_mutex >( try_lock_shared_for, try_lock_for);
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: shared_mutex multi-thread test suite");
+
+    test->add( BOOST_TEST_CASE( & test_shared_mutex) );
+    test->add( BOOST_TEST_CASE( & test_shared_timed_mutex) );
+
+    return test;
+}
@@ -0,0 +1,207 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+template< typename M >
+void do_test_exclusive() {
+    M mtx;
+    std::vector< int > order;
+    mtx.lock();
+    BOOST_CHECK( ! mtx.try_lock() );
+    BOOST_CHECK( ! mtx.try_lock_shared() );
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&mtx,&order](){
+        std::unique_lock< M > lk( mtx);
+        order.push_back( 1);
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&mtx,&order](){
+        mtx.lock_shared();
+        order.push_back( 2);
+        mtx.unlock_shared();
+    });
+    boost::this_fiber::yield();
+    boost::this_fiber::yield();
+    order.push_back( 0);
+    mtx.unlock();
+    f1.join();
+    f2.join();
+    BOOST_REQUIRE_EQUAL( 3u, order.size() );
+    BOOST_CHECK_EQUAL( 0, order[0]);
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+template< typename M >
+void do_test_shared() {
+    M mtx;
+    int inside = 0;
+    int max_inside = 0;
+    std::vector< boost::fibers::fiber > readers;
+    for ( int i = 0; i < 4; ++i) {
+        readers.emplace_back( boost::fibers::launch::post, [&mtx,&inside,&max_inside](){
+            mtx.lock_shared();
+            ++inside;
+            if ( max_inside < inside) {
+                max_inside = inside;
+            }
+            boost::this_fiber::yield();
+            --inside;
+            mtx.unlock_shared();
+        });
+    }
+    for ( boost::fibers::fiber & f : readers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 4, max_inside);
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+template< typename M >
+void do_test_writer_preference() {
+    M mtx;
+    std::vector< int > order;
+    mtx.lock_shared();
+    boost::fibers::fiber writer( boost::fibers::launch::post, [&mtx,&order](){
+        mtx.lock();
+        order.push_back( 1);
+        mtx.unlock();
+    });
+    boost::this_fiber::yield();
+    // the queued writer blocks new readers
+    BOOST_CHECK( ! mtx.try_lock_shared() );
+    boost::fibers::fiber reader( boost::fibers::launch::post, [&mtx,&order](){
+        mtx.lock_shared();
+        order.push_back( 2);
+        mtx.unlock_shared();
+    });
+    boost::this_fiber::yield();
+    order.push_back( 0);
+    mtx.unlock_shared();
+    writer.join();
+    reader.join();
+    BOOST_REQUIRE_EQUAL( 3u, order.size() );
+    BOOST_CHECK_EQUAL( 0, order[0]);
+    BOOST_CHECK_EQUAL( 1, order[1]);
+    BOOST_CHECK_EQUAL( 2, order[2]);
+}
+
+template< typename M >
+void do_test_batch_release() {
+    M mtx;
+    int inside = 0;
+    int max_inside = 0;
+    bool writer_done = false;
+    mtx.lock();
+    std::vector< boost::fibers::fiber > readers;
+    for ( int i = 0; i < 3; ++i) {
+        readers.emplace_back( boost::fibers::launch::post, [&mtx,&inside,&max_inside](){
+            mtx.lock_shared();
+            ++inside;
+            if ( max_inside < inside) {
+                max_inside = inside;
+            }
+            boost::this_fiber::yield();
+            boost::this_fiber::yield();
+            --inside;
+            mtx.unlock_shared();
+        });
+    }
+    boost::this_fiber::yield();
+    boost::fibers::fiber writer( boost::fibers::launch::post, [&mtx,&writer_done,&inside](){
+        mtx.lock();
+        BOOST_CHECK_EQUAL( 0, inside);
+        writer_done = true;
+        mtx.unlock();
+    });
+    boost::this_fiber::yield();
+    // the queued readers are released together, ahead of the queued writer
+    mtx.unlock();
+    for ( boost::fibers::fiber & f : readers) {
+        f.join();
+    }
+    writer.join();
+    BOOST_CHECK_EQUAL( 3, max_inside);
+    BOOST_CHECK( writer_done);
+}
+
+void do_test_timed() {
+    boost::fibers::shared_timed_mutex mtx;
+    mtx.lock_shared();
+    BOOST_CHECK( mtx.try_lock_shared_for( ms( 10) ) );
+    BOOST_CHECK( ! mtx.try_lock_for( ms( 10) ) );
+    mtx.unlock_shared();
+    mtx.unlock_shared();
+    BOOST_CHECK( mtx.try_lock_until( std::chrono::steady_clock::now() + ms( 10) ) );
+    boost::fibers::fiber( boost::fibers::launch::post, [&mtx](){
+        BOOST_CHECK( ! mtx.try_lock_shared_for( ms( 10) ) );
+        BOOST_CHECK( ! mtx.try_lock_for( ms( 10) ) );
+    }).join();
+    mtx.unlock();
+    boost::fibers::fiber( boost::fibers::launch::post, [&mtx](){
+        BOOST_CHECK( mtx.try_lock_shared_until( std::chrono::steady_clock::now() + ms( 10) ) );
+        mtx.unlock_shared();
+    }).join();
+}
+
+void do_test_timed_writer_releases_readers() {
+    boost::fibers::shared_timed_mutex mtx;
+    bool read = false;
+    mtx.lock_shared();
+    boost::fibers::fiber writer( boost::fibers::launch::post, [&mtx](){
+        BOOST_CHECK( ! mtx.try_lock_for( ms( 50) ) );
+    });
+    boost::this_fiber::yield();
+    // blocked by the queued writer
+    boost::fibers::fiber reader( boost::fibers::launch::post, [&mtx,&read](){
+        mtx.lock_shared();
+        read = true;
+        mtx.unlock_shared();
+    });
+    // the reader is released as soon as the writer has given up
+    writer.join();
+    reader.join();
+    BOOST_CHECK( read);
+    mtx.unlock_shared();
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+template< typename M >
+void test_shared_mutex_impl() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_exclusive< M >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_shared< M >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_writer_preference< M >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_batch_release< M >).join();
+}
+
+void test_shared_mutex() {
+    test_shared_mutex_impl< boost::fibers::shared_mutex >();
+}
+
+void test_shared_timed_mutex() {
+    test_shared_mutex_impl< boost::fibers::shared_timed_mutex >();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_timed).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_timed_writer_releases_readers).join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: shared_mutex test suite");
+
+    test->add( BOOST_TEST_CASE( & test_shared_mutex) );
+    test->add( BOOST_TEST_CASE( & test_shared_timed_mutex) );
+
+    return test;
+}
@@ -0,0 +1,226 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct moveable {
+    bool    state;
+    int     value;
+
+    moveable() :
+        state( false),
+        value( -1) {
+    }
+
+    moveable( int v) :
+        state( true),
+        value( v) {
+    }
+
+    moveable( moveable && other) :
+        state( other.state),
+        value( other.value) {
+        other.state = false;
+        other.value = -1;
+    }
+
+    moveable & operator=( moveable && other) {
+        if ( this == & other) return * this;
+        state = other.state;
+        other.state = false;
+        value = other.value;
+        other.value = -1;
+        return * this;
+    }
+};
+
+void test_zero_wm() {
+    bool thrown = false;
+    try {
+        boost::fibers::spsc_channel< int > c( 0);
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_push_pop() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK_EQUAL( 2, c.value_pop() );
+}
+
+void test_push_closed() {
+    boost::fibers::spsc_channel< int > c( 16);
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_push( 1) );
+}
+
+void test_try_push_full() {
+    boost::fibers::spsc_channel< int > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 2) );
+}
+
+void test_push_wait_for_timeout() {
+    boost::fibers::spsc_channel< int > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_wait_for( 1, std::chrono::seconds( 1) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.push_wait_for( 2, std::chrono::milliseconds( 10) ) );
+}
+
+void test_try_pop() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+    c.push( 1);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+}
+
+void test_pop_closed() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    c.push( 1);
+    c.close();
+    // values pushed before close() are delivered
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_pop( v) );
+    bool thrown = false;
+    try {
+        c.value_pop();
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_pop_wait_for_timeout() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_for( v, std::chrono::milliseconds( 10) ) );
+}
+
+void test_moveable() {
+    boost::fibers::spsc_channel< moveable > c( 16);
+    moveable m1( 3), m2;
+    BOOST_CHECK( m1.state);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::move( m1) ) );
+    BOOST_CHECK( ! m1.state);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( m2) );
+    BOOST_CHECK( m2.state);
+    BOOST_CHECK_EQUAL( 3, m2.value);
+}
+
+void test_wait() {
+    // producer blocks on a full ring, consumer on an empty one
+    boost::fibers::spsc_channel< int > c( 2);
+    int sum = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c](){
+        for ( int i = 1; i <= 100; ++i) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( i) );
+        }
+        c.close();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c,&sum](){
+        int v = 0;
+        while ( boost::fibers::channel_op_status::success == c.pop( v) ) {
+            sum += v;
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 5050, sum);
+}
+
+void test_rangefor() {
+    boost::fibers::spsc_channel< std::string > c( 4);
+    std::vector< std::string > vec;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c](){
+        c.push( "a");
+        c.push( "b");
+        c.push( "c");
+        c.push( "d");
+        c.push( "e");
+        c.close();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c,&vec](){
+        for ( std::string & s : c) {
+            vec.push_back( s);
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 5u, vec.size() );
+    BOOST_CHECK_EQUAL( "a", vec[0]);
+    BOOST_CHECK_EQUAL( "e", vec[4]);
+}
+
+void test_destroy_values() {
+    // values left in the ring are destroyed with the channel
+    std::shared_ptr< int > p = std::make_shared< int >( 1);
+    {
+        boost::fibers::spsc_channel< std::shared_ptr< int > > c( 4);
+        c.push( p);
+        c.push( p);
+        BOOST_CHECK_EQUAL( 3, p.use_count() );
+    }
+    BOOST_CHECK_EQUAL( 1, p.use_count() );
+}
+
+void test_mt() {
+    // producer and consumer on different threads
+    constexpr int count = 100000;
+    boost::fibers::spsc_channel< int > c( 64);
+    std::thread t{ [&c,count](){
+                       for ( int i = 0; i < count; ++i) {
+                           c.push( i);
+                       }
+                       c.close();
+                   }};
+    int expected = 0, v = 0;
+    while ( boost::fibers::channel_op_status::success == c.pop( v) ) {
+        BOOST_REQUIRE_EQUAL( expected, v);
+        ++expected;
+    }
+    t.join();
+    BOOST_CHECK_EQUAL( count, expected);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: spsc-channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_zero_wm) );
+    test->add( BOOST_TEST_CASE( & test_push_pop) );
+    test->add( BOOST_TEST_CASE( & test_push_closed) );
+    test->add( BOOST_TEST_CASE( & test_try_push_full) );
+    test->add( BOOST_TEST_CASE( & test_push_wait_for_timeout) );
+    test->add( BOOST_TEST_CASE( & test_try_pop) );
+    test->add( BOOST_TEST_CASE( & test_pop_closed) );
+    test->add( BOOST_TEST_CASE( & test_pop_wait_for_timeout) );
+    test->add( BOOST_TEST_CASE( & test_moveable) );
+    test->add( BOOST_TEST_CASE( & test_wait) );
+    test->add( BOOST_TEST_CASE( & test_rangefor) );
+    test->add( BOOST_TEST_CASE( & test_destroy_values) );
+    test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
@@ -0,0 +1,158 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// library and test are compiled with BOOST_FIBERS_USE_TIMER_WHEEL
+// and BOOST_FIBERS_TIMER_WHEEL_TICK=100: level 0 of the wheel spans
+// 6.4ms, level 1 409.6ms, level 2 26.2s
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#if ! defined(BOOST_FIBERS_USE_TIMER_WHEEL)
+# error "test must be compiled with BOOST_FIBERS_USE_TIMER_WHEEL"
+#endif
+
+typedef std::chrono::steady_clock   clock_type;
+typedef std::chrono::milliseconds   ms;
+
+void test_sleep_for_order() {
+    // deadlines in level 0, level 1 and level 2, inserted in reverse order
+    std::vector< int > delays = { 600, 450, 200, 70, 30, 9, 5, 1 };
+    std::vector< int > order;
+    std::vector< boost::fibers::fiber > fibers;
+    clock_type::time_point start = clock_type::now();
+    for ( int d : delays) {
+        fibers.emplace_back( boost::fibers::launch::post, [d,start,&order](){
+            boost::this_fiber::sleep_for( ms( d) );
+            BOOST_CHECK( start + ms( d) <= clock_type::now() );
+            order.push_back( d);
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_REQUIRE_EQUAL( delays.size(), order.size() );
+    BOOST_CHECK( std::is_sorted( order.begin(), order.end() ) );
+}
+
+void test_sleep_for_same_bucket() {
+    // deadlines sharing buckets in the upper levels must be
+    // split up correctly when the bucket is cascaded
+    std::vector< int > order;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 40; 0 < i; --i) {
+        fibers.emplace_back( boost::fibers::launch::post, [i,&order](){
+            boost::this_fiber::sleep_for( std::chrono::microseconds( 7000 + 300 * i) );
+            order.push_back( i);
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_REQUIRE_EQUAL( 40u, order.size() );
+    BOOST_CHECK( std::is_sorted( order.begin(), order.end() ) );
+}
+
+void test_wait_until_timeout() {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&cond](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        clock_type::time_point deadline = clock_type::now() + ms( 20);
+        BOOST_CHECK( boost::fibers::cv_status::timeout == cond.wait_until( lk, deadline) );
+        BOOST_CHECK( deadline <= clock_type::now() );
+    });
+    f.join();
+}
+
+void test_wait_until_cancel( ms timeout) {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    bool flag = false;
+    clock_type::time_point start = clock_type::now();
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&mtx,&cond,&flag,timeout](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        BOOST_CHECK( cond.wait_until( lk, clock_type::now() + timeout, [&flag](){ return flag; }) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&mtx,&cond,&flag](){
+        boost::this_fiber::sleep_for( ms( 10) );
+        {
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            flag = true;
+        }
+        cond.notify_all();
+    });
+    f1.join();
+    f2.join();
+    // the cancelled deadline is unlinked from the wheel,
+    // later sleeps are not held back by it
+    boost::fibers::fiber f3( boost::fibers::launch::post, [](){
+        boost::this_fiber::sleep_for( ms( 15) );
+    });
+    f3.join();
+    BOOST_CHECK( clock_type::now() - start < timeout);
+}
+
+void test_wait_until_cancel_level() {
+    // deadline stored in level 2
+    test_wait_until_cancel( ms( 5000) );
+}
+
+void test_wait_until_cancel_overflow() {
+    // deadline beyond the horizon of the wheel
+    test_wait_until_cancel( ms( 3600000) );
+}
+
+void test_wait_until_cancel_many() {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    bool flag = false;
+    int woken = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 32; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [i,&mtx,&cond,&flag,&woken](){
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            if ( cond.wait_for( lk, ms( 1 + 37 * i), [&flag](){ return flag; }) ) {
+                ++woken;
+            }
+        });
+    }
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&cond,&flag](){
+        boost::this_fiber::sleep_for( ms( 100) );
+        {
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            flag = true;
+        }
+        cond.notify_all();
+    });
+    f.join();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    // fibers with a deadline before 100ms time out, the others are notified
+    BOOST_CHECK_LE( 28, woken);
+    BOOST_CHECK_GE( 30, woken);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: timer wheel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_sleep_for_order) );
+    test->add( BOOST_TEST_CASE( & test_sleep_for_same_bucket) );
+    test->add( BOOST_TEST_CASE( & test_wait_until_timeout) );
+    test->add( BOOST_TEST_CASE( & test_wait_until_cancel_level) );
+    test->add( BOOST_TEST_CASE( & test_wait_until_cancel_overflow) );
+    test->add( BOOST_TEST_CASE( & test_wait_until_cancel_many) );
+
+    return test;
+}
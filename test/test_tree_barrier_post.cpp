@@ -0,0 +1,150 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value1 = 0;
+int value2 = 0;
+
+void fn1( boost::fibers::tree_barrier & b) {
+    ++value1;
+    boost::this_fiber::yield();
+
+    b.wait();
+
+    ++value1;
+    boost::this_fiber::yield();
+    ++value1;
+}
+
+void fn2( boost::fibers::tree_barrier & b) {
+    ++value2;
+    boost::this_fiber::yield();
+    ++value2;
+    boost::this_fiber::yield();
+
+    b.wait();
+
+    BOOST_CHECK_EQUAL( 1, value1);
+    ++value2;
+}
+
+void test_tree_barrier() {
+    value1 = 0;
+    value2 = 0;
+
+    boost::fibers::tree_barrier b( 1, 2);
+    boost::fibers::fiber f1( boost::fibers::launch::post, fn1, std::ref( b) );
+    boost::fibers::fiber f2( boost::fibers::launch::post, fn2, std::ref( b) );
+
+    f1.join();
+    f2.join();
+
+    BOOST_CHECK_EQUAL( 3, value1);
+    BOOST_CHECK_EQUAL( 3, value2);
+}
+
+void test_tree_barrier_phases() {
+    boost::fibers::tree_barrier b( 1, 5, 2);
+    int arrived = 0;
+    int last = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&b,&arrived,&last](){
+            for ( int phase = 0; phase < 100; ++phase) {
+                ++arrived;
+                if ( b.wait() ) {
+                    ++last;
+                }
+                BOOST_CHECK_LE( 5 * ( phase + 1), arrived);
+                BOOST_CHECK_GT( 5 * ( phase + 2), arrived);
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 500, arrived);
+    BOOST_CHECK_EQUAL( 100, last);
+}
+
+void test_tree_barrier_invalid() {
+    BOOST_CHECK_THROW( boost::fibers::tree_barrier( 0, 1), boost::fibers::fiber_error);
+    BOOST_CHECK_THROW( boost::fibers::tree_barrier( 1, 0), boost::fibers::fiber_error);
+    BOOST_CHECK_THROW( boost::fibers::tree_barrier( 2, 2, 1), boost::fibers::fiber_error);
+    // the leaf of this thread's scheduler is the only one
+    boost::fibers::tree_barrier b( 1, 1);
+    BOOST_CHECK( b.wait() );
+    bool thrown = false;
+    std::thread t( [&b,&thrown](){
+        try {
+            b.wait();
+        } catch ( boost::fibers::fiber_error const&) {
+            thrown = true;
+        }
+    });
+    t.join();
+    BOOST_CHECK( thrown);
+}
+
+void test_tree_barrier_mt() {
+    // 7 leaves with fan-in 2 build a tree of depth 3
+    constexpr int threads = 7;
+    constexpr int fibers_per_thread = 3;
+    constexpr int total = threads * fibers_per_thread;
+    constexpr int phases = 200;
+    boost::fibers::tree_barrier b( threads, fibers_per_thread, 2);
+    std::atomic< int > arrived{ 0 };
+    std::atomic< int > last{ 0 };
+    std::atomic< bool > early{ false };
+    std::vector< std::thread > workers;
+    for ( int t = 0; t < threads; ++t) {
+        workers.emplace_back( [&](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < fibers_per_thread; ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&](){
+                    for ( int phase = 0; phase < phases; ++phase) {
+                        ++arrived;
+                        if ( b.wait() ) {
+                            ++last;
+                        }
+                        int n = arrived;
+                        if ( total * ( phase + 1) > n || total * ( phase + 2) <= n) {
+                            early = true;
+                        }
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : workers) {
+        t.join();
+    }
+    BOOST_CHECK( ! early);
+    BOOST_CHECK_EQUAL( total * phases, arrived);
+    BOOST_CHECK_EQUAL( phases, last);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: tree_barrier test suite");
+
+    test->add( BOOST_TEST_CASE( & test_tree_barrier) );
+    test->add( BOOST_TEST_CASE( & test_tree_barrier_phases) );
+    test->add( BOOST_TEST_CASE( & test_tree_barrier_invalid) );
+    test->add( BOOST_TEST_CASE( & test_tree_barrier_mt) );
+
+    return test;
+}
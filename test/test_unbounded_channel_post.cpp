@@ -0,0 +1,222 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct moveable {
+    bool    state;
+    int     value;
+
+    moveable() :
+        state( false),
+        value( -1) {
+    }
+
+    moveable( int v) :
+        state( true),
+        value( v) {
+    }
+
+    moveable( moveable && other) :
+        state( other.state),
+        value( other.value) {
+        other.state = false;
+        other.value = -1;
+    }
+
+    moveable & operator=( moveable && other) {
+        if ( this == & other) return * this;
+        state = other.state;
+        other.state = false;
+        value = other.value;
+        other.value = -1;
+        return * this;
+    }
+};
+
+void test_push_pop() {
+    boost::fibers::unbounded_channel< int > c;
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK_EQUAL( 2, c.value_pop() );
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+}
+
+void test_unbounded() {
+    // spans many blocks, the blocks are reused in the second round
+    boost::fibers::unbounded_channel< std::string > c;
+    for ( int round = 0; round < 2; ++round) {
+        for ( int i = 0; i < 1000; ++i) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::to_string( i) ) );
+        }
+        for ( int i = 0; i < 1000; ++i) {
+            std::string v;
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+            BOOST_CHECK_EQUAL( std::to_string( i), v);
+        }
+    }
+}
+
+void test_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    int v = 0;
+    c.push( 1);
+    c.close();
+    BOOST_CHECK( c.is_closed() );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push( 2) );
+    // values pushed before close() are delivered
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_pop( v) );
+    bool thrown = false;
+    try {
+        c.value_pop();
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_pop_wait_for_timeout() {
+    boost::fibers::unbounded_channel< int > c;
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_for( v, std::chrono::milliseconds( 10) ) );
+}
+
+void test_moveable() {
+    boost::fibers::unbounded_channel< moveable > c;
+    moveable m1( 3), m2;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::move( m1) ) );
+    BOOST_CHECK( ! m1.state);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( m2) );
+    BOOST_CHECK( m2.state);
+    BOOST_CHECK_EQUAL( 3, m2.value);
+}
+
+void test_soft_limit() {
+    std::vector< std::size_t > sizes;
+    boost::fibers::unbounded_channel< int > c{ 2, [&sizes](std::size_t size){ sizes.push_back( size); } };
+    c.push( 1);
+    c.push( 2);
+    BOOST_CHECK( sizes.empty() );
+    c.push( 3);
+    c.push( 4);
+    BOOST_REQUIRE_EQUAL( 2u, sizes.size() );
+    BOOST_CHECK_EQUAL( 3u, sizes[0]);
+    BOOST_CHECK_EQUAL( 4u, sizes[1]);
+    c.value_pop();
+    c.value_pop();
+    c.value_pop();
+    c.push( 5);
+    BOOST_CHECK_EQUAL( 2u, sizes.size() );
+}
+
+void test_wait() {
+    boost::fibers::unbounded_channel< int > c;
+    int sum = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c,&sum](){
+        int v = 0;
+        while ( boost::fibers::channel_op_status::success == c.pop( v) ) {
+            sum += v;
+        }
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c](){
+        for ( int i = 1; i <= 100; ++i) {
+            c.push( i);
+            boost::this_fiber::yield();
+        }
+        c.close();
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 5050, sum);
+}
+
+void test_rangefor() {
+    boost::fibers::unbounded_channel< std::string > c;
+    std::vector< std::string > vec;
+    for ( int i = 0; i < 40; ++i) {
+        c.push( std::to_string( i) );
+    }
+    c.close();
+    for ( std::string & s : c) {
+        vec.push_back( s);
+    }
+    BOOST_REQUIRE_EQUAL( 40u, vec.size() );
+    BOOST_CHECK_EQUAL( "0", vec[0]);
+    BOOST_CHECK_EQUAL( "39", vec[39]);
+}
+
+void test_destroy_values() {
+    // values left in the channel are destroyed with it
+    std::shared_ptr< int > p = std::make_shared< int >( 1);
+    {
+        boost::fibers::unbounded_channel< std::shared_ptr< int > > c;
+        for ( int i = 0; i < 100; ++i) {
+            c.push( p);
+        }
+        c.value_pop();
+        BOOST_CHECK_EQUAL( 100, p.use_count() );
+    }
+    BOOST_CHECK_EQUAL( 1, p.use_count() );
+}
+
+void test_mt() {
+    // producers on other threads, one consumer
+    constexpr int count = 50000;
+    boost::fibers::unbounded_channel< int > c;
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&c,count,t](){
+                                  for ( int i = 0; i < count; ++i) {
+                                      c.push( t);
+                                  }
+                              });
+    }
+    int received[4] = { 0, 0, 0, 0 };
+    int v = 0;
+    for ( int i = 0; i < 4 * count; ++i) {
+        BOOST_REQUIRE( boost::fibers::channel_op_status::success == c.pop( v) );
+        ++received[v];
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    for ( int t = 0; t < 4; ++t) {
+        BOOST_CHECK_EQUAL( count, received[t]);
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: unbounded-channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_push_pop) );
+    test->add( BOOST_TEST_CASE( & test_unbounded) );
+    test->add( BOOST_TEST_CASE( & test_closed) );
+    test->add( BOOST_TEST_CASE( & test_pop_wait_for_timeout) );
+    test->add( BOOST_TEST_CASE( & test_moveable) );
+    test->add( BOOST_TEST_CASE( & test_soft_limit) );
+    test->add( BOOST_TEST_CASE( & test_wait) );
+    test->add( BOOST_TEST_CASE( & test_rangefor) );
+    test->add( BOOST_TEST_CASE( & test_destroy_values) );
+    test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
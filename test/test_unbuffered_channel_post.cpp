@@ -440,6 +440,58 @@ void test_issue_268() {
     BOOST_CHECK_EQUAL( 12, vec[1]);
 }
 
+void test_direct_handoff() {
+    boost::fibers::unbuffered_channel< int > chan{ boost::fibers::handoff_policy::direct };
+    std::vector< int > order;
+    boost::fibers::fiber consumer( boost::fibers::launch::post, [&chan,&order]() {
+        order.push_back( chan.value_pop() );
+        order.push_back( chan.value_pop() );
+    });
+    // consumer blocks in value_pop()
+    boost::this_fiber::yield();
+    boost::fibers::fiber other( boost::fibers::launch::post, [&order]() {
+        order.push_back( 0);
+    });
+    // other is ready, but consumer and producer are resumed first
+    BOOST_CHECK( boost::fibers::channel_op_status::success == chan.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == chan.push( 2) );
+    consumer.join();
+    other.join();
+    BOOST_REQUIRE_EQUAL( 3u, order.size() );
+    BOOST_CHECK_EQUAL( 1, order[0]);
+    BOOST_CHECK_EQUAL( 2, order[1]);
+    BOOST_CHECK_EQUAL( 0, order[2]);
+}
+
+void test_direct_handoff_no_starvation() {
+    // two fibers handing off to each other do not starve the ready-queue
+    boost::fibers::unbuffered_channel< int > ping{ boost::fibers::handoff_policy::direct };
+    boost::fibers::unbuffered_channel< int > pong{ boost::fibers::handoff_policy::direct };
+    bool done = false;
+    int yields = 0;
+    boost::fibers::fiber other( boost::fibers::launch::post, [&done,&yields]() {
+        while ( ! done) {
+            ++yields;
+            boost::this_fiber::yield();
+        }
+    });
+    boost::fibers::fiber f( boost::fibers::launch::post, [&ping,&pong]() {
+        for ( int i = 0; i < 1000; ++i) {
+            pong.push( ping.value_pop() + 1);
+        }
+    });
+    int value = 0;
+    for ( int i = 0; i < 1000; ++i) {
+        ping.push( value);
+        value = pong.value_pop();
+    }
+    done = true;
+    f.join();
+    other.join();
+    BOOST_CHECK_EQUAL( 1000, value);
+    BOOST_CHECK( 10 < yields);
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: unbuffered_channel test suite");
@@ -471,6 +523,8 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_rangefor) );
      test->add( BOOST_TEST_CASE( & test_issue_181) );
      test->add( BOOST_TEST_CASE( & test_issue_268) );
+     test->add( BOOST_TEST_CASE( & test_direct_handoff) );
+     test->add( BOOST_TEST_CASE( & test_direct_handoff_no_starvation) );
 
     return test;
 }
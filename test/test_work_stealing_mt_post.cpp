@@ -0,0 +1,225 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::unique_lock< boost::fibers::mutex > lock_type;
+
+// fibers launched by the first thread of a pool, executed by all threads
+struct work {
+    boost::fibers::mutex                    mtx{};
+    boost::fibers::condition_variable_any   cnd{};
+    std::uint32_t                           fiber_count{ 0 };
+    std::atomic< std::uint32_t >            executed{ 0 };
+};
+
+void worker( work & w) {
+    for ( int i = 0; i < 10; ++i) {
+        boost::this_fiber::yield();
+    }
+    ++w.executed;
+    lock_type lk{ w.mtx };
+    if ( 0 == --w.fiber_count) {
+        lk.unlock();
+        w.cnd.notify_all();
+    }
+}
+
+void thread_fn( boost::fibers::algo::work_stealing_pool & pool, work & w, bool launch) {
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    if ( launch) {
+        {
+            lock_type lk{ w.mtx };
+            w.fiber_count = 100;
+        }
+        for ( std::uint32_t i = 0; i < 100; ++i) {
+            boost::fibers::fiber{ boost::fibers::launch::post, worker, std::ref( w) }.detach();
+        }
+    }
+    {
+        lock_type lk{ w.mtx };
+        w.cnd.wait( lk, [&w](){ return 0 == w.fiber_count; });
+    }
+    // leave the pool before it gets destroyed
+    pool.leave();
+}
+
+void run_pool( std::uint32_t thread_count) {
+    boost::fibers::algo::work_stealing_pool pool{ thread_count };
+    BOOST_CHECK_EQUAL( thread_count, pool.capacity() );
+    work w;
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( thread_fn, std::ref( pool), std::ref( w), 0 == i);
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( std::uint32_t{ 100 }, w.executed.load() );
+}
+
+void test_pool() {
+    run_pool( 2);
+}
+
+void test_pool_recreate() {
+    // pools are torn down and created again with a different thread count
+    for ( std::uint32_t thread_count = 1; thread_count < 5; ++thread_count) {
+        run_pool( thread_count);
+    }
+}
+
+void test_pools_coexist() {
+    // two independent pools at the same time
+    std::thread t1{ run_pool, 2 };
+    std::thread t2{ run_pool, 3 };
+    t1.join();
+    t2.join();
+}
+
+void launch_and_wait( work & w, std::uint32_t fiber_count) {
+    {
+        lock_type lk{ w.mtx };
+        w.fiber_count = fiber_count;
+    }
+    for ( std::uint32_t i = 0; i < fiber_count; ++i) {
+        boost::fibers::fiber{ boost::fibers::launch::post, worker, std::ref( w) }.detach();
+    }
+    lock_type lk{ w.mtx };
+    w.cnd.wait( lk, [&w](){ return 0 == w.fiber_count; });
+}
+
+void test_pool_resize() {
+    boost::fibers::algo::work_stealing_pool pool{ 4 };
+    pool.resize( 3);
+    BOOST_CHECK_EQUAL( std::uint32_t{ 3 }, pool.target() );
+    // the main thread joins the pool too
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    work w1;
+    launch_and_wait( w1, 100);
+    BOOST_CHECK_EQUAL( std::uint32_t{ 100 }, w1.executed.load() );
+    // retire workers while the pool is busy
+    pool.resize( 1);
+    work w2;
+    launch_and_wait( w2, 100);
+    BOOST_CHECK_EQUAL( std::uint32_t{ 100 }, w2.executed.load() );
+    pool.resize( 4);
+    BOOST_CHECK_EQUAL( std::uint32_t{ 3 }, pool.target() );
+    pool.leave();
+    BOOST_CHECK( pool.size() <= 3);
+}
+
+void test_pool_leave() {
+    boost::fibers::algo::work_stealing_pool pool{ 3 };
+    pool.resize( 2);
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    work w;
+    {
+        lock_type lk{ w.mtx };
+        w.fiber_count = 100;
+    }
+    for ( std::uint32_t i = 0; i < 100; ++i) {
+        boost::fibers::fiber{ boost::fibers::launch::post, worker, std::ref( w) }.detach();
+    }
+    // the fibers have not run yet, leave() hands them over to the workers
+    pool.leave();
+    {
+        lock_type lk{ w.mtx };
+        w.cnd.wait( lk, [&w](){ return 0 == w.fiber_count; });
+    }
+    BOOST_CHECK_EQUAL( std::uint32_t{ 100 }, w.executed.load() );
+}
+
+void test_pool_full() {
+    boost::fibers::algo::work_stealing_pool pool{ 2 };
+    pool.resize( 2);
+    // the slots are reserved for the workers, whether they have joined yet or not
+    bool thrown = false;
+    try {
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    } catch ( boost::fibers::fiber_error const& e) {
+        thrown = true;
+        BOOST_CHECK( std::make_error_code( std::errc::resource_unavailable_try_again) == e.code() );
+    }
+    BOOST_CHECK( thrown);
+    BOOST_CHECK( pool.size() <= 2);
+    // the thread keeps its previous scheduler
+    work w;
+    launch_and_wait( w, 10);
+    BOOST_CHECK_EQUAL( std::uint32_t{ 10 }, w.executed.load() );
+}
+
+void test_pool_resize_churn() {
+    // workers retiring while the pool grows again are replaced only
+    // after they have left, the pool never exceeds its capacity
+    boost::fibers::algo::work_stealing_pool pool{ 2 };
+    for ( int i = 0; i < 100; ++i) {
+        pool.resize( 2);
+        pool.resize( 0);
+        pool.resize( 2);
+        BOOST_CHECK( pool.size() <= 2);
+    }
+}
+
+void test_pool_autoscale() {
+    boost::fibers::algo::work_stealing_pool pool{ 4 };
+    boost::fibers::algo::elastic_policy policy;
+    policy.min_workers = 1;
+    policy.max_workers = 3;
+    // an empty pool starts with the minimum
+    BOOST_CHECK_EQUAL( std::uint32_t{ 1 }, pool.autoscale( policy) );
+    BOOST_CHECK_EQUAL( std::uint32_t{ 1 }, pool.target() );
+    pool.resize( 3);
+    // the target stays within [min_workers, max_workers]
+    std::uint32_t workers = pool.autoscale( policy);
+    BOOST_CHECK( 2 <= workers && workers <= 3);
+}
+
+void test_pool_statistics() {
+    boost::fibers::algo::work_stealing_pool pool{ 3 };
+    pool.resize( 2);
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    work w;
+    launch_and_wait( w, 100);
+    boost::fibers::scheduler_statistics stats = pool.statistics();
+    // each fiber is resumed at least 11 times (launch, 10 yields)
+    BOOST_CHECK( 1100u <= stats.context_switches);
+    BOOST_CHECK( 1100u <= stats.wakeups);
+    BOOST_CHECK( stats.steals <= stats.steal_attempts * BOOST_FIBERS_STEAL_BATCH_MAX);
+    std::vector< boost::fibers::scheduler_statistics > members = pool.member_statistics();
+    BOOST_CHECK( ! members.empty() );
+    BOOST_CHECK( members.size() <= 3);
+    pool.leave();
+    // counters of schedulers that left the pool are kept
+    BOOST_CHECK( stats.context_switches <= pool.statistics().context_switches);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: work-stealing pool test suite");
+
+    test->add( BOOST_TEST_CASE( & test_pool) );
+    test->add( BOOST_TEST_CASE( & test_pool_recreate) );
+    test->add( BOOST_TEST_CASE( & test_pools_coexist) );
+    test->add( BOOST_TEST_CASE( & test_pool_resize) );
+    test->add( BOOST_TEST_CASE( & test_pool_leave) );
+    test->add( BOOST_TEST_CASE( & test_pool_full) );
+    test->add( BOOST_TEST_CASE( & test_pool_resize_churn) );
+    test->add( BOOST_TEST_CASE( & test_pool_autoscale) );
+    test->add( BOOST_TEST_CASE( & test_pool_statistics) );
+
+	return test;
+}